@@ -0,0 +1,87 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+/*
+ Merging k sorted runs with xtd::kway_merge compared to a std::priority_queue of run heads, sequential and parallel.
+
+ c++ -std=c++14 -O3 -pthread -I.. kway_merge.cpp -o kway_merge-bench && ./kway_merge-bench
+ */
+
+#include <xtd/kway_merge.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <queue>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+	// Best time per call of f
+	template<class F>
+	double seconds(F f)
+	{
+		auto best = 1e9;
+		for(int i = 0; i < 3; ++i)
+		{
+			auto start = std::chrono::steady_clock::now();
+			f();
+			best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+		}
+		return best;
+	}
+
+	void run(std::size_t k, std::size_t n)
+	{
+		std::mt19937 rng{1};
+		std::vector<std::vector<std::uint32_t>> runs(k);
+		std::vector<xtd::array_view<const std::uint32_t>> views;
+		for(auto& run : runs)
+		{
+			run.resize(n / k);
+			for(auto& x : run)
+				x = static_cast<std::uint32_t>(rng());
+			std::sort(run.begin(), run.end());
+			views.push_back(xtd::make_array_view(run.data(), run.size()));
+		}
+		std::vector<std::uint32_t> out(n / k * k, 1);
+
+		auto heap = seconds([&]
+		{
+			using Head = std::pair<std::uint32_t, std::size_t>;
+			std::priority_queue<Head, std::vector<Head>, std::greater<>> queue;
+			std::vector<std::size_t> next(k, 1);
+			for(std::size_t i = 0; i < k; ++i)
+				queue.push({runs[i][0], i});
+			auto o = out.begin();
+			while(!queue.empty())
+			{
+				auto head = queue.top();
+				queue.pop();
+				*o++ = head.first;
+				auto i = head.second;
+				if(next[i] < runs[i].size())
+					queue.push({runs[i][next[i]++], i});
+			}
+		});
+		auto seq = seconds([&] { xtd::kway_merge(views, out); });
+		auto par = seconds([&] { xtd::kway_merge(xtd::execution::par, views, out); });
+		auto m = out.size() / 1e6;
+		std::printf("k=%4zu  std::priority_queue %6.1f M/s  xtd::kway_merge %6.1f M/s  xtd::kway_merge(par) %6.1f M/s\n", k, m / heap, m / seq, m / par);
+	}
+}
+
+int main()
+{
+	std::printf("%u hardware threads\n", std::thread::hardware_concurrency());
+	for(std::size_t k : { 2, 16, 256 })
+		run(k, std::size_t(1) << 24);
+}
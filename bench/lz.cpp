@@ -0,0 +1,120 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+/*
+ Throughput and ratio of xtd::lz on generated corpora and any files given on the command line.
+
+ c++ -std=c++14 -O3 -I.. lz.cpp -o lz-bench && ./lz-bench [files...]
+ */
+
+#include <xtd/lz.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	using corpus = std::vector<unsigned char>;
+	constexpr std::size_t corpus_size = 16 << 20;
+
+	corpus text()
+	{
+		const char* words[] = { "the ", "quick ", "brown ", "fox ", "jumps ", "over ", "lazy ", "dog", ", ", ".\n", "snapshot ", "record " };
+		std::mt19937 rng{1};
+		corpus c;
+		while(c.size() < corpus_size)
+		{
+			auto w = words[rng() % 12];
+			c.insert(c.end(), w, w + std::strlen(w));
+		}
+		return c;
+	}
+
+	// What `out << xtd::unformatted(v)` produces for a vector of slowly varying integers
+	corpus integers()
+	{
+		std::mt19937 rng{2};
+		std::vector<std::int32_t> v(corpus_size / sizeof(std::int32_t));
+		std::int32_t x = 0;
+		for(auto& i : v)
+			i = x += static_cast<std::int32_t>(rng() % 16);
+		auto p = reinterpret_cast<const unsigned char*>(v.data());
+		return corpus(p, p + v.size() * sizeof(std::int32_t));
+	}
+
+	// Same for doubles, whose mantissas compress poorly
+	corpus doubles()
+	{
+		std::mt19937 rng{3};
+		std::normal_distribution<double> dist{100, 10};
+		std::vector<double> v(corpus_size / sizeof(double));
+		for(auto& d : v)
+			d = dist(rng);
+		auto p = reinterpret_cast<const unsigned char*>(v.data());
+		return corpus(p, p + v.size() * sizeof(double));
+	}
+
+	corpus noise()
+	{
+		std::mt19937 rng{4};
+		corpus c(corpus_size);
+		for(auto& x : c)
+			x = static_cast<unsigned char>(rng());
+		return c;
+	}
+
+	template<class F>
+	double seconds(F f)
+	{
+		auto best = 1e9;
+		for(int i = 0; i < 5; ++i)
+		{
+			auto start = std::chrono::steady_clock::now();
+			f();
+			best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+		}
+		return best;
+	}
+
+	void run(const char* name, const corpus& in)
+	{
+		corpus packed(xtd::lz::compress_bound(in.size()));
+		corpus out(in.size());
+		auto mb = in.size() / 1e6;
+		for(auto lvl : { xtd::lz::level::fast, xtd::lz::level::high })
+		{
+			std::size_t n = 0;
+			auto c = seconds([&] { n = xtd::lz::compress(xtd::make_array_view(in.data(), in.size()), xtd::make_array_view(packed.data(), packed.size()), lvl); });
+			auto d = seconds([&] { xtd::lz::decompress(xtd::make_array_view(packed.data(), n), xtd::make_array_view(out.data(), out.size())); });
+			if(out != in)
+				std::printf("%s: round trip mismatch\n", name);
+			std::printf("%-12s %-5s ratio %6.3f  compress %8.1f MB/s  decompress %8.1f MB/s\n",
+						name, lvl == xtd::lz::level::fast ? "fast" : "high", double(in.size()) / n, mb / c, mb / d);
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	run("text", text());
+	run("int32", integers());
+	run("double", doubles());
+	run("random", noise());
+	for(int i = 1; i < argc; ++i)
+	{
+		std::ifstream f{argv[i], std::ios::binary};
+		corpus c{std::istreambuf_iterator<char>{f}, std::istreambuf_iterator<char>{}};
+		if(c.size() > xtd::lz::max_input_size)
+			c.resize(xtd::lz::max_input_size);
+		run(argv[i], c);
+	}
+}
@@ -0,0 +1,127 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+/*
+ Throughput of xtd::reduce, the accurate summation functions and the prefix sums compared to <numeric>, sequential and parallel.
+
+ c++ -std=c++14 -O3 -pthread -I.. reduce.cpp -o reduce-bench && ./reduce-bench
+ */
+
+#include <xtd/numeric.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+	// Best time per call of f, repeating it to run for a measurable time
+	template<class F>
+	double seconds(F f, int repeat)
+	{
+		auto best = 1e9;
+		for(int i = 0; i < 5; ++i)
+		{
+			auto start = std::chrono::steady_clock::now();
+			for(int j = 0; j < repeat; ++j)
+				f();
+			best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / repeat);
+		}
+		return best;
+	}
+
+	template<class T>
+	void run(const char* name, std::size_t bytes)
+	{
+		std::mt19937 rng{1};
+		std::vector<T> v(bytes / sizeof(T));
+		for(auto& x : v)
+			x = static_cast<T>(rng() % 100);
+
+		volatile T sink;
+		auto gb = bytes / 1e9;
+		auto repeat = static_cast<int>((256 << 20) / bytes);
+		auto a = seconds([&] { sink = std::accumulate(v.begin(), v.end(), T{}); }, repeat);
+		auto r = seconds([&] { sink = xtd::reduce(v); }, repeat);
+		auto p = seconds([&] { sink = xtd::reduce(xtd::execution::par, v); }, repeat);
+		(void)sink;
+		std::printf("%-8s %9zu KiB  std::accumulate %6.2f GB/s  xtd::reduce %6.2f GB/s  xtd::reduce(par) %6.2f GB/s\n", name, bytes >> 10, gb / a, gb / r, gb / p);
+	}
+
+	template<class T>
+	void sums(const char* name, std::size_t bytes)
+	{
+		std::mt19937 rng{1};
+		std::uniform_real_distribution<T> dist{-1, 1};
+		std::vector<T> v(bytes / sizeof(T));
+		for(auto& x : v)
+			x = dist(rng);
+
+		volatile T sink;
+		auto gb = bytes / 1e9;
+		auto repeat = static_cast<int>((256 << 20) / bytes);
+		auto measure = [&] (const char* what, auto f)
+		{
+			std::printf("  %s %6.2f GB/s", what, gb / seconds([&] { sink = f(); }, repeat));
+		};
+		std::printf("%-8s %9zu KiB", name, bytes >> 10);
+		measure("reduce", [&] { return xtd::reduce(v); });
+		measure("pairwise", [&] { return xtd::pairwise_sum(v); });
+		measure("kahan", [&] { return xtd::kahan_sum(v); });
+		measure("neumaier", [&] { return xtd::neumaier_sum(v); });
+		measure("neumaier(par)", [&] { return xtd::neumaier_sum(xtd::execution::par, v); });
+		(void)sink;
+		std::printf("\n");
+	}
+
+	template<class T>
+	void scans(const char* name, std::size_t bytes)
+	{
+		std::mt19937 rng{1};
+		std::vector<T> v(bytes / sizeof(T));
+		for(auto& x : v)
+			x = static_cast<T>(rng() % 100);
+		std::vector<T> out(v.size());
+
+		auto gb = bytes / 1e9;
+		auto repeat = static_cast<int>((256 << 20) / bytes);
+		auto p = seconds([&] { std::partial_sum(v.begin(), v.end(), out.begin()); }, repeat);
+		auto s = seconds([&] { xtd::inclusive_scan(v, out); }, repeat);
+		auto e = seconds([&] { xtd::exclusive_scan(v, out); }, repeat);
+		auto par = seconds([&] { xtd::exclusive_scan(xtd::execution::par, v, out); }, repeat);
+		std::printf("%-8s %9zu KiB  std::partial_sum %6.2f GB/s  xtd::inclusive_scan %6.2f GB/s  xtd::exclusive_scan %6.2f GB/s  xtd::exclusive_scan(par) %6.2f GB/s\n", name, bytes >> 10, gb / p, gb / s, gb / e, gb / par);
+	}
+}
+
+int main()
+{
+	std::printf("%u hardware threads\n", std::thread::hardware_concurrency());
+	// In cache and in memory
+	for(std::size_t bytes : { std::size_t(64) << 10, std::size_t(128) << 20 })
+	{
+		run<std::int32_t>("int32", bytes);
+		run<std::int64_t>("int64", bytes);
+		run<float>("float", bytes);
+		run<double>("double", bytes);
+	}
+	for(std::size_t bytes : { std::size_t(64) << 10, std::size_t(128) << 20 })
+	{
+		sums<float>("float", bytes);
+		sums<double>("double", bytes);
+	}
+	for(std::size_t bytes : { std::size_t(64) << 10, std::size_t(128) << 20 })
+	{
+		scans<std::int32_t>("int32", bytes);
+		scans<std::int64_t>("int64", bytes);
+		scans<float>("float", bytes);
+		scans<double>("double", bytes);
+	}
+}
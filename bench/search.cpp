@@ -0,0 +1,63 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+/*
+ Random lookups in sorted arrays with std::lower_bound compared to xtd::branchless_lower_bound, xtd::eytzinger_index and xtd::static_btree.
+
+ c++ -std=c++14 -O3 -I.. search.cpp -o search-bench && ./search-bench
+ */
+
+#include <xtd/static_search.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace
+{
+	template<class F>
+	double nanoseconds(const std::vector<std::uint32_t>& queries, F f)
+	{
+		std::size_t sink = 0;
+		auto start = std::chrono::steady_clock::now();
+		for(auto q : queries)
+			sink += f(q);
+		auto ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / queries.size();
+		volatile std::size_t keep = sink;
+		(void)keep;
+		return ns;
+	}
+
+	void run(std::size_t n)
+	{
+		std::mt19937 rng{1};
+		std::vector<std::uint32_t> sorted(n);
+		for(auto& x : sorted)
+			x = rng();
+		std::sort(sorted.begin(), sorted.end());
+		std::vector<std::uint32_t> queries(1 << 22);
+		for(auto& q : queries)
+			q = rng();
+
+		auto view = xtd::make_array_view(sorted.data(), sorted.size());
+		xtd::eytzinger_index<std::uint32_t> eytzinger{view};
+		xtd::static_btree<std::uint32_t> btree{view};
+		auto std_ns = nanoseconds(queries, [&] (std::uint32_t q) { return std::lower_bound(sorted.begin(), sorted.end(), q) - sorted.begin(); });
+		auto branchless_ns = nanoseconds(queries, [&] (std::uint32_t q) { return xtd::branchless_lower_bound(sorted, q) - sorted.data(); });
+		auto eytzinger_ns = nanoseconds(queries, [&] (std::uint32_t q) { return eytzinger.lower_bound(q); });
+		auto btree_ns = nanoseconds(queries, [&] (std::uint32_t q) { return btree.lower_bound(q); });
+		std::printf("%10zu elements  std::lower_bound %6.1f ns  branchless %6.1f ns  eytzinger %6.1f ns  static_btree %6.1f ns\n", n, std_ns, branchless_ns, eytzinger_ns, btree_ns);
+	}
+}
+
+int main()
+{
+	for(std::size_t n = 1 << 10; n <= (1 << 26); n <<= 4)
+		run(n);
+}
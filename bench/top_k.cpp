@@ -0,0 +1,72 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+/*
+ Selecting the best 100 of many scores with xtd::top_k compared to std::partial_sort_copy and std::nth_element.
+
+ c++ -std=c++14 -O3 -I.. top_k.cpp -o top_k-bench && ./top_k-bench
+ */
+
+#include <xtd/top_k.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <vector>
+
+namespace
+{
+	// Best time per call of f
+	template<class F>
+	double seconds(F f)
+	{
+		auto best = 1e9;
+		for(int i = 0; i < 5; ++i)
+		{
+			auto start = std::chrono::steady_clock::now();
+			f();
+			best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+		}
+		return best;
+	}
+
+	template<class T>
+	void run(const char* name, std::size_t n, std::size_t k)
+	{
+		std::mt19937 rng{1};
+		std::uniform_real_distribution<double> dist{0, 1e6};
+		std::vector<T> v(n);
+		for(auto& x : v)
+			x = static_cast<T>(dist(rng));
+
+		std::vector<T> out(k);
+		volatile T sink;
+		auto partial = seconds([&] { std::partial_sort_copy(v.begin(), v.end(), out.begin(), out.end(), std::greater<>{}); sink = out[0]; });
+		auto nth = seconds([&]
+		{
+			auto copy = v;
+			std::nth_element(copy.begin(), copy.begin() + static_cast<std::ptrdiff_t>(k), copy.end(), std::greater<>{});
+			sink = copy[0];
+		});
+		auto xtd = seconds([&] { sink = xtd::top_k(v, k)[0]; });
+		(void)sink;
+		auto m = n / 1e6;
+		std::printf("%-8s n=%9zu k=%4zu  std::partial_sort_copy %7.1f M/s  std::nth_element %7.1f M/s  xtd::top_k %7.1f M/s\n", name, n, k, m / partial, m / nth, m / xtd);
+	}
+}
+
+int main()
+{
+	for(std::size_t n : { std::size_t(1) << 16, std::size_t(1) << 24 })
+	{
+		run<std::int32_t>("int32", n, 100);
+		run<float>("float", n, 100);
+		run<double>("double", n, 100);
+	}
+}
@@ -0,0 +1,381 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+#include <xtd/algorithm.hpp>
+#include <xtd/array_view.hpp>
+
+#include <gmock/gmock.h>
+
+#include <array>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace xtd;
+using namespace testing;
+
+namespace
+{
+	template<class T>
+	class algorithm_extremes : public Test { };
+
+	using extreme_types = Types<std::int8_t, std::uint16_t, int, std::int64_t, float, double>;
+	TYPED_TEST_CASE(algorithm_extremes, extreme_types);
+}
+
+TYPED_TEST(algorithm_extremes, MatchesStd)
+{
+	std::mt19937 rng{3};
+	for(std::size_t n : { 1, 2, 7, 16, 63, 64, 65, 1000, 4099 })
+	{
+		std::vector<TypeParam> v(n);
+		for(auto& x : v)
+			x = static_cast<TypeParam>(static_cast<int>(rng() % 200) - 100);
+		auto expected_min = std::min_element(v.begin(), v.end()) - v.begin();
+		auto expected_max = std::max_element(v.begin(), v.end()) - v.begin();
+		EXPECT_THAT(argmin(v), Eq(static_cast<std::size_t>(expected_min))) << n;
+		EXPECT_THAT(argmax(v), Eq(static_cast<std::size_t>(expected_max))) << n;
+		EXPECT_THAT(xtd::min_element(v), Eq(v.data() + expected_min)) << n;
+		EXPECT_THAT(xtd::max_element(v), Eq(v.data() + expected_max)) << n;
+		EXPECT_THAT(xtd::minmax(v), Eq(std::make_pair(v[expected_min], v[expected_max]))) << n;
+	}
+}
+
+TYPED_TEST(algorithm_extremes, FirstOfEqualElements)
+{
+	std::vector<TypeParam> v(1000, 5);
+	v[700] = 1;
+	v[900] = 1;
+	v[10] = 9;
+	v[999] = 9;
+	EXPECT_THAT(argmin(v), Eq(700u));
+	EXPECT_THAT(argmax(v), Eq(10u));
+}
+
+TEST(algorithm, Empty)
+{
+	std::vector<float> v;
+	EXPECT_THAT(argmin(v), Eq(0u));
+	EXPECT_THAT(argmax(v), Eq(0u));
+	EXPECT_THAT(xtd::min_element(v), Eq(v.data()));
+}
+
+TEST(algorithm, NanPolicy)
+{
+	const auto nan = std::numeric_limits<double>::quiet_NaN();
+	for(std::size_t n : { 6, 1000 })
+	{
+		std::vector<double> v(n, 2.0);
+		v[1] = nan;
+		v[3] = -1.0;
+		v[n - 1] = nan;
+		v[n - 2] = 4.0;
+		EXPECT_THAT(argmin(v), Eq(3u)) << n;
+		EXPECT_THAT(argmax(v), Eq(n - 2)) << n;
+		EXPECT_THAT(xtd::minmax(v), Eq(std::make_pair(-1.0, 4.0))) << n;
+		EXPECT_THAT(argmin(v, nan_policy::propagate), Eq(1u)) << n;
+		EXPECT_THAT(argmax(v, nan_policy::propagate), Eq(1u)) << n;
+		EXPECT_TRUE(std::isnan(xtd::minmax(v, nan_policy::propagate).first)) << n;
+
+		// Leading NaN
+		v[0] = nan;
+		EXPECT_THAT(argmin(v), Eq(3u)) << n;
+		EXPECT_THAT(argmin(v, nan_policy::propagate), Eq(0u)) << n;
+
+		// Only NaN
+		std::fill(v.begin(), v.end(), nan);
+		EXPECT_THAT(argmin(v), Eq(0u)) << n;
+		EXPECT_TRUE(std::isnan(xtd::minmax(v).second)) << n;
+	}
+
+	const float inf[] = { std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity() };
+	EXPECT_THAT(argmax(make_array_view(inf)), Eq(0u));
+	EXPECT_THAT(argmin(make_array_view(inf)), Eq(1u));
+}
+
+TEST(algorithm, OtherTypes)
+{
+	std::vector<std::string> v = { "pear", "apple", "quince", "fig" };
+	EXPECT_THAT(argmin(v), Eq(1u));
+	EXPECT_THAT(*xtd::max_element(v), Eq("quince"));
+	EXPECT_THAT(xtd::minmax(v), Eq(std::make_pair(std::string{"apple"}, std::string{"quince"})));
+}
+
+namespace
+{
+	template<class T>
+	class algorithm_radix_sort : public Test { };
+
+	using radix_types = Types<std::int8_t, std::uint8_t, std::int16_t, unsigned, int, std::uint64_t, std::int64_t, float, double>;
+	TYPED_TEST_CASE(algorithm_radix_sort, radix_types);
+}
+
+TYPED_TEST(algorithm_radix_sort, Sorts)
+{
+	std::mt19937_64 rng{5};
+	for(std::size_t n : { 0, 1, 2, 100, 255, 256, 1000, 300007 })
+	{
+		std::vector<TypeParam> v(n);
+		for(auto& x : v)
+			x = static_cast<TypeParam>(static_cast<std::int64_t>(rng()) >> (rng() % 64));
+		auto expected = v;
+		std::sort(expected.begin(), expected.end());
+		auto sorted = v;
+		radix_sort(sorted);
+		EXPECT_TRUE(sorted == expected) << n;
+		sorted = v;
+		radix_sort(execution::parallel_policy{4}, sorted);
+		EXPECT_TRUE(sorted == expected) << n;
+	}
+}
+
+TEST(algorithm, RadixSortFloatOrder)
+{
+	const auto inf = std::numeric_limits<double>::infinity();
+	std::vector<double> v = { 3.5, -0.0, inf, -1e300, 0.0, -inf, 1e-310, -2.0, 0.0, -1e-310 };
+	radix_sort(v);
+	EXPECT_THAT(v, ElementsAre(-inf, -1e300, -2.0, -1e-310, 0.0, 0.0, 0.0, 1e-310, 3.5, inf));
+	EXPECT_TRUE(std::signbit(v[4]));
+	EXPECT_FALSE(std::signbit(v[5]));
+}
+
+TEST(algorithm, RadixSortKeyValue)
+{
+	// Few distinct keys, so stability is visible
+	for(std::size_t n : { 10, 1000, 300007 })
+	{
+		std::vector<std::uint32_t> keys(n);
+		std::vector<std::size_t> rows(n);
+		for(std::size_t i = 0; i < n; ++i)
+		{
+			keys[i] = static_cast<std::uint32_t>((i * 7919) % 13) << 20;
+			rows[i] = i;
+		}
+		std::vector<std::pair<std::uint32_t, std::size_t>> expected;
+		for(std::size_t i = 0; i < n; ++i)
+			expected.emplace_back(keys[i], i);
+		std::stable_sort(expected.begin(), expected.end(), [] (auto& a, auto& b) { return a.first < b.first; });
+
+		auto k = keys;
+		auto r = rows;
+		radix_sort(k, r);
+		for(std::size_t i = 0; i < n; ++i)
+			ASSERT_THAT(std::make_pair(k[i], r[i]), Eq(expected[i])) << n << " " << i;
+		radix_sort(execution::par, keys, rows);
+		EXPECT_TRUE(keys == k) << n;
+		EXPECT_TRUE(rows == r) << n;
+	}
+
+	std::vector<float> scores = { 0.5f, -1.f, 0.25f };
+	std::vector<std::string> names = { "a", "b", "c" };
+	radix_sort(scores, names);
+	EXPECT_THAT(names, ElementsAre("b", "c", "a"));
+}
+
+TEST(algorithm, RadixSortStrings)
+{
+	std::mt19937 rng{11};
+	std::vector<std::string> storage;
+	for(int i = 0; i < 5000; ++i)
+	{
+		// Shared prefixes, empty strings and bytes above 127
+		std::string s(rng() % 3 ? "common/prefix/" : "");
+		for(auto len = rng() % 6; len > 0; --len)
+			s += static_cast<char>("ab\xff\x80z"[rng() % 5]);
+		storage.push_back(s);
+	}
+	std::vector<string_view> v(storage.begin(), storage.end());
+	radix_sort(v);
+	auto expected = storage;
+	std::sort(expected.begin(), expected.end());
+	ASSERT_THAT(v.size(), Eq(expected.size()));
+	for(std::size_t i = 0; i < v.size(); ++i)
+		ASSERT_THAT(std::string(v[i].data(), v[i].size()), Eq(expected[i])) << i;
+
+	std::vector<string_view> same(100, "x");
+	radix_sort(execution::par, same);
+	EXPECT_THAT(same, Each(Eq(string_view{"x"})));
+}
+
+TEST(algorithm, ParallelSort)
+{
+	std::mt19937 rng{13};
+	for(std::size_t n : { 0, 1, 1000, 100003, 500000 })
+	{
+		std::vector<int> v(n);
+		for(auto& x : v)
+			x = static_cast<int>(rng());
+		auto expected = v;
+		std::sort(expected.begin(), expected.end());
+		for(unsigned threads : { 1, 2, 3, 8 })
+		{
+			auto sorted = v;
+			parallel_sort(execution::parallel_policy{threads}, sorted);
+			EXPECT_TRUE(sorted == expected) << n << " " << threads;
+		}
+		auto sorted = v;
+		parallel_sort(sorted, std::greater<>{});
+		EXPECT_TRUE(std::equal(sorted.begin(), sorted.end(), expected.rbegin())) << n;
+	}
+}
+
+TEST(algorithm, ParallelSortDuplicates)
+{
+	// Mostly one value, which gets its own bucket
+	std::vector<std::string> v(200000, "same");
+	for(std::size_t i = 0; i < v.size(); i += 3)
+		v[i] = std::to_string(i % 1000);
+	auto expected = v;
+	std::sort(expected.begin(), expected.end());
+	parallel_sort(execution::parallel_policy{4}, v);
+	EXPECT_TRUE(v == expected);
+
+	std::vector<int> same(100000, 7);
+	parallel_sort(execution::parallel_policy{4}, same);
+	EXPECT_THAT(same, Each(Eq(7)));
+}
+
+TEST(algorithm, ParallelSortMoveOnly)
+{
+	std::vector<std::unique_ptr<int>> v;
+	for(int i = 0; i < 100000; ++i)
+		v.push_back(std::make_unique<int>((i * 7919) % 100000));
+	parallel_sort(execution::parallel_policy{4}, v, [] (const auto& a, const auto& b) { return *a < *b; });
+	for(int i = 0; i < 100000; ++i)
+		ASSERT_THAT(*v[i], Eq(i));
+}
+
+namespace
+{
+	template<class T>
+	class algorithm_sorted_sets : public Test { };
+
+	using set_types = Types<std::uint32_t, std::int32_t, std::uint64_t, double>;
+	TYPED_TEST_CASE(algorithm_sorted_sets, set_types);
+
+	template<class T>
+	std::vector<T> random_set(std::size_t n, std::size_t range, std::mt19937& rng)
+	{
+		std::vector<T> v(n);
+		for(auto& x : v)
+			x = static_cast<T>(rng() % range);
+		std::sort(v.begin(), v.end());
+		v.erase(std::unique(v.begin(), v.end()), v.end());
+		return v;
+	}
+}
+
+TYPED_TEST(algorithm_sorted_sets, MatchesStd)
+{
+	std::mt19937 rng{17};
+	// Similar sizes, skewed sizes in both directions, disjoint and identical sets
+	const std::size_t sizes[][3] = { { 0, 10, 100 }, { 7, 9, 20 }, { 1000, 1000, 3000 }, { 1000, 1000, 100000 }, { 10, 5000, 20000 }, { 5000, 10, 20000 }, { 3, 100000, 200000 }, { 4000, 4000, 4000 } };
+	for(auto& size : sizes)
+	{
+		auto a = random_set<TypeParam>(size[0], size[2], rng);
+		auto b = random_set<TypeParam>(size[1], size[2], rng);
+		for(int swap = 0; swap < 2; ++swap, std::swap(a, b))
+		{
+			std::vector<TypeParam> expected;
+			std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+			std::vector<TypeParam> out(a.size() + b.size() + 1);
+			EXPECT_THAT(set_intersection_count(a, b), Eq(expected.size())) << a.size() << " " << b.size();
+			out.resize(intersect(a, b, out));
+			EXPECT_TRUE(out == expected) << a.size() << " " << b.size();
+
+			expected.clear();
+			std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+			out.resize(a.size() + b.size());
+			out.resize(merge_union(a, b, out));
+			EXPECT_TRUE(out == expected) << a.size() << " " << b.size();
+
+			expected.clear();
+			std::set_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+			out.resize(a.size());
+			out.resize(difference(a, b, out));
+			EXPECT_TRUE(out == expected) << a.size() << " " << b.size();
+		}
+	}
+}
+
+TEST(algorithm, SortedSetsInterleaved)
+{
+	// Matches spread over several blocks of the other range
+	std::vector<std::uint32_t> a, b;
+	for(std::uint32_t i = 0; i < 1000; ++i)
+	{
+		a.push_back(4 * i);
+		if(i % 3)
+			b.push_back(4 * i);
+		b.push_back(4 * i + 1);
+	}
+	std::vector<std::uint32_t> out(a.size() + b.size());
+	EXPECT_THAT(set_intersection_count(a, b), Eq(666u));
+	EXPECT_THAT(difference(a, b, out), Eq(334u));
+	EXPECT_THAT(out[1], Eq(12u));
+	EXPECT_THAT(merge_union(a, b, out), Eq(2000u));
+}
+
+namespace
+{
+	struct square
+	{
+		constexpr int operator()(std::size_t i) const { return static_cast<int>(i * i); }
+	};
+
+	// Sorted unique keywords built at compile time
+	constexpr std::size_t unique_count()
+	{
+		int values[] = { 5, 3, 5, 1, 3, 9, 1 };
+		xtd::constexpr_sort(std::begin(values), std::end(values));
+		return static_cast<std::size_t>(xtd::constexpr_unique(std::begin(values), std::end(values)) - std::begin(values));
+	}
+}
+
+TEST(algorithm, Constexpr)
+{
+	constexpr auto primes = sorted(std::array<int, 6>{{ 7, 2, 13, 3, 11, 5 }});
+	static_assert(primes[0] == 2 && primes[1] == 3 && primes[2] == 5 && primes[5] == 13, "");
+	static_assert(xtd::constexpr_lower_bound(primes, 4) == 2, "");
+	static_assert(xtd::constexpr_lower_bound(primes, 14) == 6, "");
+	static_assert(xtd::constexpr_lower_bound(primes, 13, std::less<>{}) == 5, "");
+	constexpr auto descending = sorted(std::array<int, 4>{{ 1, 4, 2, 3 }}, std::greater<>{});
+	static_assert(descending[0] == 4 && descending[3] == 1, "");
+	static_assert(sorted(std::array<int, 0>{}).empty(), "");
+	static_assert(unique_count() == 4, "");
+
+	constexpr auto squares = generate_array<16>(square{});
+	static_assert(squares.size() == 16 && squares[15] == 225, "");
+
+	// Also usable at run time
+	std::mt19937 rng{5};
+	std::vector<int> v(1000);
+	for(auto& x : v)
+		x = static_cast<int>(rng() % 100);
+	auto expected = v;
+	std::sort(expected.begin(), expected.end());
+	xtd::constexpr_sort(v.begin(), v.end());
+	EXPECT_TRUE(v == expected);
+	v.erase(xtd::constexpr_unique(v.begin(), v.end()), v.end());
+	expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+	EXPECT_TRUE(v == expected);
+	EXPECT_THAT(xtd::constexpr_lower_bound(v.begin(), v.end(), 50) - v.begin(), Eq(std::lower_bound(v.begin(), v.end(), 50) - v.begin()));
+}
+
+TEST(algorithm, UnqualifiedStdCalls)
+{
+	// Iterators over xtd types must not make the standard algorithms ambiguous
+	std::vector<string_view> v = { "b", "a", "b" };
+	using std::sort;
+	using std::unique;
+	using std::lower_bound;
+	sort(v.begin(), v.end());
+	v.erase(unique(v.begin(), v.end()), v.end());
+	EXPECT_THAT(v.size(), Eq(2u));
+	EXPECT_THAT(lower_bound(v.begin(), v.end(), string_view{"b"}) - v.begin(), Eq(1));
+}
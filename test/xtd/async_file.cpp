@@ -0,0 +1,238 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+#include <xtd/async_file.hpp>
+#include <xtd/finally.hpp>
+
+#include "test_util.hpp"
+
+#include <gmock/gmock.h>
+
+using namespace xtd;
+using namespace testing;
+
+namespace
+{
+	// Runs each test with both backends
+	class async_file_test : public testutil::temp_file_test<TestWithParam<async_file::backend>>
+	{
+	protected:
+		async_file_test()
+		: temp_file_test("async_file")
+		{
+		}
+
+		async_file open(std::ios_base::openmode mode)
+		{
+			async_file::options opts;
+			opts.engine = GetParam();
+			opts.queue_depth = 4;
+			opts.threads = 2;
+			return async_file{path, mode, opts};
+		}
+	};
+
+	bool has_io_uring()
+	{
+		try
+		{
+			async_file::options opts;
+			opts.engine = async_file::backend::io_uring;
+			async_file{::open("/dev/null", O_RDONLY), opts};
+			return true;
+		}
+		catch(const std::system_error&)
+		{
+			return false;
+		}
+	}
+}
+
+TEST_P(async_file_test, WriteThenRead)
+{
+	if(GetParam() == async_file::backend::io_uring && !has_io_uring())
+		return;
+
+	auto data = testutil::random_bytes(1 << 20, 5);
+	constexpr std::size_t chunk = 4096 * 3;
+	{
+		auto f = open(std::ios_base::out);
+		EXPECT_THAT(f.engine(), Eq(GetParam()));
+		// More requests than the queue depth
+		std::vector<std::future<std::size_t>> writes;
+		for(std::size_t pos = 0; pos < data.size(); pos += chunk)
+			writes.push_back(f.write_at(pos, make_array_view(data.data() + pos, std::min(chunk, data.size() - pos))));
+		for(auto& w : writes)
+			EXPECT_THAT(w.get(), Gt(0u));
+		EXPECT_THAT(f.size(), Eq(data.size()));
+	}
+
+	auto f = open(std::ios_base::in);
+	std::vector<unsigned char> read(data.size());
+	std::vector<std::future<std::size_t>> reads;
+	{
+		async_file::batch batch{f};
+		for(std::size_t pos = 0; pos < data.size(); pos += chunk)
+			reads.push_back(f.read_at(pos, make_array_view(read.data() + pos, std::min(chunk, data.size() - pos))));
+	}
+	std::size_t total = 0;
+	for(auto& r : reads)
+		total += r.get();
+	EXPECT_THAT(total, Eq(data.size()));
+	EXPECT_TRUE(read == data);
+}
+
+TEST_P(async_file_test, ShortReadAtEnd)
+{
+	if(GetParam() == async_file::backend::io_uring && !has_io_uring())
+		return;
+
+	auto f = open(std::ios_base::in | std::ios_base::out);
+	const unsigned char hello[] = { 'h', 'e', 'l', 'l', 'o' };
+	EXPECT_THAT(f.write_at(0, hello).get(), Eq(5u));
+
+	unsigned char buffer[16];
+	EXPECT_THAT(f.read_at(2, buffer).get(), Eq(3u));
+	EXPECT_THAT(buffer[0], Eq('l'));
+	EXPECT_THAT(f.read_at(100, buffer).get(), Eq(0u));
+	EXPECT_THAT(f.read_at(0, {}).get(), Eq(0u));
+}
+
+TEST_P(async_file_test, RegisteredBuffers)
+{
+	if(GetParam() == async_file::backend::io_uring && !has_io_uring())
+		return;
+
+	auto data = testutil::random_bytes(8192, 5);
+	std::vector<unsigned char> read(data.size());
+	auto f = open(std::ios_base::in | std::ios_base::out);
+	const array_view<unsigned char> buffers[] = { make_array_view(data.data(), data.size()), make_array_view(read.data(), read.size()) };
+	f.register_buffers(buffers);
+	EXPECT_THAT(f.write_at(0, make_array_view(data.data(), data.size())).get(), Eq(data.size()));
+	EXPECT_THAT(f.read_at(100, make_array_view(read.data() + 100, 1000)).get(), Eq(1000u));
+	f.unregister_buffers();
+	EXPECT_THAT(f.read_at(0, make_array_view(read.data(), 100)).get(), Eq(100u));
+	EXPECT_TRUE(std::equal(data.begin(), data.begin() + 1100, read.begin()));
+}
+
+TEST_P(async_file_test, Errors)
+{
+	if(GetParam() == async_file::backend::io_uring && !has_io_uring())
+		return;
+
+	auto f = open(std::ios_base::in);
+	const unsigned char x[] = { 1 };
+	auto w = f.write_at(0, x);
+	EXPECT_THROW(w.get(), std::system_error);
+
+	EXPECT_THROW(async_file("/nonexistent/file", std::ios_base::in), std::system_error);
+}
+
+INSTANTIATE_TEST_CASE_P(async_file, async_file_test, Values(async_file::backend::io_uring, async_file::backend::thread_pool));
+
+#if defined(XTD_ASYNC_FILE_IO_URING)
+namespace
+{
+	// Makes io_uring_enter fail with EIO while set
+	bool fail_submit = false;
+
+	struct FailingEnter
+	{
+		long operator()(int ring, unsigned count) const noexcept
+		{
+			if(__atomic_load_n(&fail_submit, __ATOMIC_RELAXED))
+			{
+				errno = EIO;
+				return -1;
+			}
+			return detail::async_file::Enter{}(ring, count);
+		}
+	};
+
+	using failing_ring = detail::async_file::IoUring<FailingEnter>;
+
+	std::future<std::size_t> read(failing_ring& ring, int fd, unsigned char* data, std::size_t size)
+	{
+		auto op = std::make_unique<detail::async_file::Operation>();
+		op->fd = fd;
+		op->write = false;
+		op->data = data;
+		op->size = size;
+		op->offset = 0;
+		auto future = op->promise.get_future();
+		ring.start(std::move(op));
+		return future;
+	}
+
+	void expect_eio(std::future<std::size_t>& r)
+	{
+		try
+		{
+			r.get();
+			ADD_FAILURE() << "The request did not fail";
+		}
+		catch(const std::system_error& e)
+		{
+			EXPECT_THAT(e.code().value(), Eq(EIO));
+		}
+	}
+}
+
+TEST(async_file, ResubmitFailure)
+{
+	if(!has_io_uring())
+		return;
+
+	// A read from a pipe returns what is available and the rest is resubmitted from the completion thread
+	int fds[2];
+	ASSERT_THAT(::pipe(fds), Eq(0));
+	XTD_FINALLY { ::close(fds[0]); ::close(fds[1]); };
+	XTD_FINALLY { __atomic_store_n(&fail_submit, false, __ATOMIC_RELAXED); };
+	failing_ring ring{4};
+	unsigned char buffer[8];
+	auto r = read(ring, fds[0], buffer, sizeof(buffer));
+	ring.submit();
+
+	__atomic_store_n(&fail_submit, true, __ATOMIC_RELAXED);
+	const unsigned char part[] = { 1, 2, 3 };
+	ASSERT_THAT(::write(fds[1], part, sizeof(part)), Eq(3));
+	expect_eio(r);
+	__atomic_store_n(&fail_submit, false, __ATOMIC_RELAXED);
+
+	// The failed entry was taken back and the ring still works
+	auto r2 = read(ring, fds[0], buffer, sizeof(buffer));
+	ring.submit();
+	const unsigned char whole[8] = { };
+	ASSERT_THAT(::write(fds[1], whole, sizeof(whole)), Eq(8));
+	EXPECT_THAT(r2.get(), Eq(8u));
+}
+
+TEST(async_file, SubmitFailure)
+{
+	if(!has_io_uring())
+		return;
+
+	auto fd = ::open("/dev/zero", O_RDONLY);
+	ASSERT_THAT(fd, Ge(0));
+	XTD_FINALLY { ::close(fd); };
+	XTD_FINALLY { __atomic_store_n(&fail_submit, false, __ATOMIC_RELAXED); };
+	unsigned char buffer[8];
+	__atomic_store_n(&fail_submit, true, __ATOMIC_RELAXED);
+	std::future<std::size_t> r3;
+	{
+		failing_ring ring{4};
+		auto r1 = read(ring, fd, buffer, sizeof(buffer));
+		auto r2 = read(ring, fd, buffer, sizeof(buffer));
+		EXPECT_THROW(ring.submit(), std::system_error);
+		expect_eio(r1);
+		expect_eio(r2);
+
+		// The destructor must neither throw nor hang when it cannot submit
+		r3 = read(ring, fd, buffer, sizeof(buffer));
+	}
+	expect_eio(r3);
+}
+#endif
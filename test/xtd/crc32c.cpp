@@ -0,0 +1,104 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+#include <xtd/crc32c.hpp>
+#include <xtd/iomanip.hpp>
+
+#include "test_util.hpp"
+
+#include <gmock/gmock.h>
+
+#include <sstream>
+#include <vector>
+
+using namespace xtd;
+using namespace testing;
+
+TEST(crc32c, KnownValues)
+{
+	const unsigned char check[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+	EXPECT_THAT(crc32c(check), Eq(0xE3069283u));
+	EXPECT_THAT(crc32c({}), Eq(0u));
+
+	unsigned char zeros[32] = { };
+	EXPECT_THAT(crc32c(zeros), Eq(0x8A9136AAu));
+}
+
+TEST(crc32c, Incremental)
+{
+	auto data = testutil::random_bytes(100000, 3);
+	auto whole = crc32c(make_array_view(data.data(), data.size()));
+	for(auto split : { 0, 1, 7, 8, 777, 50000, 99999 })
+	{
+		auto crc = crc32c(make_array_view(data.data(), split));
+		crc = crc32c(make_array_view(data.data() + split, data.size() - split), crc);
+		EXPECT_THAT(crc, Eq(whole)) << split;
+	}
+}
+
+TEST(crc32c, ImplementationsAgree)
+{
+	auto data = testutil::random_bytes(3 * 8192 * 2 + 3 * 256 + 77, 3);
+	for(std::size_t offset = 0; offset < 9; ++offset)
+	{
+		for(auto size : { std::size_t(0), std::size_t(5), std::size_t(64), std::size_t(3 * 256), std::size_t(3 * 8192 + 100), data.size() - offset })
+		{
+			auto expected = detail::crc32c::software(data.data() + offset, size, 0x1234);
+			EXPECT_THAT(crc32c(make_array_view(data.data() + offset, size), 0x1234), Eq(expected)) << offset << " " << size;
+#if defined(XTD_CRC32C_X86)
+			if(detail::crc32c::has_sse42())
+			{
+				EXPECT_THAT(detail::crc32c::hardware(data.data() + offset, size, 0x1234), Eq(expected)) << offset << " " << size;
+			}
+#endif
+		}
+	}
+}
+
+TEST(crc32c, StreamBuffer)
+{
+	auto data = testutil::random_bytes(50000, 3);
+	std::stringstream ss;
+	{
+		crc32cbuf buf{ss.rdbuf(), 1024};
+		std::ostream out{&buf};
+		out << 'a' << unformatted(data);
+		EXPECT_THAT(buf.checksum(), Eq(crc32c(make_array_view(data.data(), data.size()), crc32c({reinterpret_cast<const unsigned char*>("a"), 1}))));
+		out << put_crc32c << "small" << put_crc32c;
+	}
+	EXPECT_THAT(ss.str().size(), Eq(1 + data.size() + 4 + 5 + 4));
+
+	crc32cbuf buf{ss.rdbuf(), 1024};
+	std::istream in{&buf};
+	char a;
+	std::vector<unsigned char> read;
+	char small[5];
+	in >> a >> unformatted(read, data.size()) >> check_crc32c >> unformatted(small) >> check_crc32c;
+	EXPECT_TRUE(in.good());
+	EXPECT_TRUE(read == data);
+}
+
+TEST(crc32c, StreamBufferDetectsCorruption)
+{
+	std::stringstream ss;
+	{
+		crc32cbuf buf{ss.rdbuf()};
+		std::ostream out{&buf};
+		out << "payload" << put_crc32c;
+	}
+	auto data = ss.str();
+	data[3] ^= 1;
+	std::stringstream corrupt{data};
+	crc32cbuf buf{corrupt.rdbuf()};
+	std::istream in{&buf};
+	char payload[7];
+	in >> unformatted(payload) >> check_crc32c;
+	EXPECT_TRUE(in.fail());
+
+	std::stringstream plain;
+	plain << put_crc32c;
+	EXPECT_TRUE(plain.fail());
+}
@@ -0,0 +1,102 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+#include <xtd/direct_io.hpp>
+
+#include "test_util.hpp"
+
+#include <gmock/gmock.h>
+
+#include <fstream>
+#include <iterator>
+
+using namespace xtd;
+using namespace testing;
+
+namespace
+{
+	class direct_io_test : public testutil::temp_file_test<>
+	{
+	protected:
+		direct_io_test()
+		: temp_file_test("direct_io")
+		{
+			opts.buffer_size = 8192;
+		}
+
+		std::vector<unsigned char> contents()
+		{
+			std::ifstream in{path, std::ios_base::binary};
+			return {std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+		}
+
+		direct_io_options opts;
+	};
+}
+
+TEST_F(direct_io_test, RoundTrip)
+{
+	// Sizes hitting the buffer boundary exactly and leaving unaligned tails
+	for(auto size : { std::size_t(0), std::size_t(1), std::size_t(4096), std::size_t(8192), std::size_t(3 * 8192 + 1000), std::size_t(100003) })
+	{
+		auto data = testutil::random_bytes(size, 9);
+		{
+			direct_writer out{path, opts};
+			// Odd chunk sizes straddling buffers
+			for(std::size_t pos = 0; pos < data.size(); pos += 777)
+				out.write(make_array_view(data.data() + pos, std::min<std::size_t>(777, data.size() - pos)));
+			EXPECT_THAT(out.size(), Eq(size));
+			out.close();
+		}
+		EXPECT_TRUE(contents() == data) << size;
+
+		direct_reader in{path, opts};
+		EXPECT_THAT(in.size(), Eq(size));
+		std::vector<unsigned char> read;
+		for(auto chunk = in.next(); !chunk.empty(); chunk = in.next())
+		{
+			EXPECT_THAT(chunk.size(), Le(opts.buffer_size));
+			read.insert(read.end(), chunk.begin(), chunk.end());
+		}
+		EXPECT_TRUE(read == data) << size;
+		EXPECT_TRUE(in.next().empty());
+	}
+}
+
+TEST_F(direct_io_test, Read)
+{
+	auto data = testutil::random_bytes(50000, 9);
+	{
+		direct_writer out{path, opts};
+		out.write(make_array_view(data.data(), data.size()));
+	}
+	EXPECT_TRUE(contents() == data);
+
+	direct_reader in{path, opts};
+	std::vector<unsigned char> read(data.size() + 10);
+	EXPECT_THAT(in.read(make_array_view(read.data(), 10)), Eq(10u));
+	auto chunk = in.next();
+	EXPECT_THAT(chunk.size(), Eq(opts.buffer_size - 10));
+	EXPECT_TRUE(std::equal(chunk.begin(), chunk.end(), data.begin() + 10));
+	std::copy(chunk.begin(), chunk.end(), read.begin() + 10);
+	EXPECT_THAT(in.read(make_array_view(read.data() + opts.buffer_size, read.size() - opts.buffer_size)), Eq(data.size() - opts.buffer_size));
+	read.resize(data.size());
+	EXPECT_TRUE(read == data);
+}
+
+TEST_F(direct_io_test, ThreadPool)
+{
+	opts.io.engine = async_file::backend::thread_pool;
+	auto data = testutil::random_bytes(30000, 9);
+	{
+		direct_writer out{path, opts};
+		out.write(make_array_view(data.data(), data.size()));
+	}
+	direct_reader in{path, opts};
+	std::vector<unsigned char> read(data.size());
+	EXPECT_THAT(in.read(make_array_view(read.data(), read.size())), Eq(data.size()));
+	EXPECT_TRUE(read == data);
+}
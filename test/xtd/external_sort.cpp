@@ -0,0 +1,133 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+#include <xtd/external_sort.hpp>
+
+#include "test_util.hpp"
+
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <random>
+#include <vector>
+
+#include <glob.h>
+
+using namespace xtd;
+using namespace testing;
+
+namespace
+{
+	class external_sort_test : public testutil::temp_file_test<>
+	{
+	protected:
+		external_sort_test()
+		: temp_file_test("external_sort")
+		, input(path)
+		, output(path + ".sorted")
+		{
+			opts.io.buffer_size = 8192;
+		}
+		~external_sort_test()
+		{
+			::unlink(output.c_str());
+		}
+
+		template<class T>
+		void write(const std::vector<T>& records)
+		{
+			std::ofstream out{input, std::ios_base::binary | std::ios_base::trunc};
+			out.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(T)));
+		}
+		template<class T>
+		std::vector<T> read()
+		{
+			std::ifstream in{output, std::ios_base::binary | std::ios_base::ate};
+			std::vector<T> records(static_cast<std::size_t>(in.tellg()) / sizeof(T));
+			in.seekg(0);
+			in.read(reinterpret_cast<char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(T)));
+			return records;
+		}
+
+		// Run files left behind
+		std::size_t temporaries()
+		{
+			::glob_t g;
+			auto pattern = output + ".run.*";
+			auto n = ::glob(pattern.c_str(), 0, nullptr, &g) == 0 ? g.gl_pathc : 0;
+			::globfree(&g);
+			return n;
+		}
+
+		std::string input;
+		std::string output;
+		external_sort_options opts;
+	};
+
+	struct record
+	{
+		std::uint32_t key;
+		std::uint32_t payload[3];
+	};
+}
+
+TEST_F(external_sort_test, Numbers)
+{
+	std::mt19937_64 rng{1};
+	std::vector<std::uint64_t> v(100003);
+	for(auto& x : v)
+		x = rng() % 50000;
+	write(v);
+	auto expected = v;
+	std::sort(expected.begin(), expected.end());
+
+	// In memory, a single merge and several merge passes
+	for(std::size_t memory : { std::size_t(1) << 24, std::size_t(1) << 18, std::size_t(1) << 14 })
+	{
+		opts.memory = memory;
+		opts.fan_in = 8;
+		EXPECT_THAT(external_sort<std::uint64_t>(input, output, std::less<>{}, opts), Eq(v.size())) << memory;
+		EXPECT_TRUE(read<std::uint64_t>() == expected) << memory;
+		EXPECT_THAT(temporaries(), Eq(0u)) << memory;
+	}
+}
+
+TEST_F(external_sort_test, Records)
+{
+	std::mt19937 rng{2};
+	std::vector<record> v(20000);
+	for(auto& r : v)
+	{
+		r.key = rng() % 1000;
+		r.payload[0] = r.payload[1] = r.payload[2] = r.key * 3;
+	}
+	write(v);
+
+	auto descending = [] (const record& a, const record& b) { return a.key > b.key; };
+	opts.memory = 1 << 15;
+	opts.fan_in = 3;
+	opts.policy.threads = 3;
+	EXPECT_THAT(external_sort<record>(input, output, descending, opts), Eq(v.size()));
+	auto sorted = read<record>();
+	ASSERT_THAT(sorted.size(), Eq(v.size()));
+	EXPECT_TRUE(std::is_sorted(sorted.begin(), sorted.end(), descending));
+	EXPECT_TRUE(std::all_of(sorted.begin(), sorted.end(), [] (const record& r) { return r.payload[0] == r.key * 3 && r.payload[2] == r.key * 3; }));
+	EXPECT_THAT(temporaries(), Eq(0u));
+}
+
+TEST_F(external_sort_test, EmptyAndInvalid)
+{
+	write(std::vector<std::uint32_t>{});
+	EXPECT_THAT(external_sort<std::uint32_t>(input, output), Eq(0u));
+	EXPECT_THAT(read<std::uint32_t>(), IsEmpty());
+
+	write(std::vector<std::uint8_t>(7));
+	EXPECT_THROW(external_sort<std::uint32_t>(input, output), std::runtime_error);
+	EXPECT_THROW(external_sort<std::uint32_t>(input + ".missing", output), std::system_error);
+	EXPECT_THAT(temporaries(), Eq(0u));
+}
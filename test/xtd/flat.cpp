@@ -0,0 +1,225 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+#include <xtd/flat.hpp>
+
+#include <gmock/gmock.h>
+
+#include <vector>
+
+using namespace xtd;
+using namespace testing;
+
+namespace
+{
+	struct Endpoint
+	{
+		std::uint16_t port;
+		flat::string host;
+
+		auto tie() { return std::tie(port, host); }
+	};
+
+	struct Node
+	{
+		flat::ref<Node> left;
+		flat::ref<Node> right;
+
+		auto tie() { return std::tie(left, right); }
+	};
+
+	// Each node refers to the next one twice, which reaches the last one 2^(length - 1) times
+	std::vector<unsigned char> shared_chain(int length)
+	{
+		flat::builder b;
+		auto next = b.create<Node>();
+		for(int i = 1; i < length; ++i)
+		{
+			auto node = b.create<Node>();
+			b.set(node, &Node::left, next);
+			b.set(node, &Node::right, next);
+			next = node;
+		}
+		b.finish(next);
+		return b.release();
+	}
+
+	struct Names
+	{
+		flat::vector<flat::string> names;
+
+		auto tie() { return std::tie(names); }
+	};
+
+	struct Group
+	{
+		flat::vector<flat::ref<Names>> members;
+
+		auto tie() { return std::tie(members); }
+	};
+
+	// Fields resolve offsets from their own address, so they must not be copied out of the buffer
+	static_assert(!std::is_copy_constructible<flat::ref<Node>>::value, "");
+	static_assert(!std::is_copy_assignable<flat::ref<Node>>::value, "");
+	static_assert(!std::is_move_constructible<flat::string>::value, "");
+	static_assert(!std::is_copy_assignable<flat::string>::value, "");
+	static_assert(!std::is_move_constructible<flat::vector<flat::string>>::value, "");
+	static_assert(!std::is_move_assignable<flat::vector<flat::string>>::value, "");
+	static_assert(!std::is_copy_constructible<Endpoint>::value, "");
+
+	struct Config
+	{
+		std::uint32_t version;
+		double scale;
+		flat::string name;
+		flat::vector<std::int32_t> limits;
+		flat::vector<Endpoint> endpoints;
+		flat::vector<flat::string> tags;
+		flat::ref<Config> parent;
+
+		auto tie() { return std::tie(version, scale, name, limits, endpoints, tags, parent); }
+	};
+
+	std::vector<unsigned char> sample()
+	{
+		flat::builder b{16};
+		auto parent = b.create<Config>();
+		b.get(parent).version = 1;
+
+		auto config = b.create<Config>();
+		b.get(config).version = 2;
+		b.get(config).scale = 0.5;
+		b.set(config, &Config::name, b.create_string("main"));
+		const std::int32_t limits[] = { 1, -2, 3 };
+		b.set(config, &Config::limits, b.create_vector(make_array_view(limits)));
+
+		auto endpoints = b.create_vector<Endpoint>(2);
+		b.get(endpoints, 0).port = 80;
+		b.get(endpoints, 1).port = 443;
+		b.set(endpoints, 0, &Endpoint::host, b.create_string("localhost"));
+		b.set(endpoints, 1, &Endpoint::host, b.create_string("example.com"));
+		b.set(config, &Config::endpoints, endpoints);
+
+		const flat::offset<flat::string> tags[] = { b.create_string("a"), b.create_string("") };
+		b.set(config, &Config::tags, b.create_vector(make_array_view(tags)));
+		b.set(config, &Config::parent, parent);
+		b.finish(config);
+		return b.release();
+	}
+}
+
+TEST(flat, ReadInPlace)
+{
+	auto buffer = sample();
+	auto bytes = make_array_view(buffer.data(), buffer.size());
+	ASSERT_TRUE(flat::verify<Config>(bytes));
+
+	auto& c = flat::root<Config>(bytes);
+	EXPECT_THAT(c.version, Eq(2u));
+	EXPECT_THAT(c.scale, Eq(0.5));
+	EXPECT_THAT(c.name.view(), Eq(string_view{"main"}));
+	EXPECT_THAT(c.name.c_str(), StrEq("main"));
+	EXPECT_THAT(std::vector<std::int32_t>(c.limits.begin(), c.limits.end()), ElementsAre(1, -2, 3));
+	ASSERT_THAT(c.endpoints.size(), Eq(2u));
+	EXPECT_THAT(c.endpoints[0].port, Eq(80));
+	EXPECT_THAT(c.endpoints[0].host.view(), Eq(string_view{"localhost"}));
+	EXPECT_THAT(c.endpoints[1].host.view(), Eq(string_view{"example.com"}));
+	ASSERT_THAT(c.tags.size(), Eq(2u));
+	EXPECT_THAT(c.tags[0].view(), Eq(string_view{"a"}));
+	EXPECT_TRUE(c.tags[1].empty());
+	ASSERT_TRUE(c.parent.get());
+	EXPECT_THAT(c.parent->version, Eq(1u));
+	EXPECT_FALSE(c.parent->parent.get());
+	EXPECT_TRUE(c.parent->name.empty());
+	EXPECT_TRUE(c.parent->endpoints.empty());
+
+	// Views refer into the buffer
+	auto first = static_cast<const void*>(bytes.data());
+	auto last = static_cast<const void*>(bytes.data() + bytes.size());
+	EXPECT_THAT(static_cast<const void*>(c.name.c_str()), AllOf(Ge(first), Lt(last)));
+	EXPECT_THAT(static_cast<const void*>(c.limits.view().data()), AllOf(Ge(first), Lt(last)));
+}
+
+TEST(flat, Relocatable)
+{
+	auto buffer = sample();
+	std::vector<unsigned char> copy(buffer.size() + 64);
+	std::copy(buffer.begin(), buffer.end(), copy.begin() + 32);
+	buffer.assign(buffer.size(), 0);
+
+	auto bytes = make_array_view(copy.data() + 32, buffer.size());
+	ASSERT_TRUE(flat::verify<Config>(bytes));
+	EXPECT_THAT(flat::root<Config>(bytes).endpoints[1].host.view(), Eq(string_view{"example.com"}));
+}
+
+TEST(flat, VerifyRejectsTruncation)
+{
+	auto buffer = sample();
+	for(std::size_t n = 0; n < buffer.size(); ++n)
+		EXPECT_FALSE(flat::verify<Config>(make_array_view(buffer.data(), n))) << n;
+}
+
+TEST(flat, VerifyRejectsCorruption)
+{
+	auto buffer = sample();
+	// Flipping bits anywhere must never make verify read out of bounds
+	std::size_t rejected = 0;
+	for(std::size_t i = 0; i < buffer.size(); ++i)
+	{
+		for(int bit : { 0, 3, 7 })
+		{
+			auto corrupt = buffer;
+			corrupt[i] ^= static_cast<unsigned char>(1 << bit);
+			rejected += !flat::verify<Config>(make_array_view(corrupt.data(), corrupt.size()));
+		}
+	}
+	EXPECT_THAT(rejected, Gt(0u));
+
+	// Misaligned buffers are rejected
+	std::vector<unsigned char> shifted(buffer.size() + 1);
+	std::copy(buffer.begin(), buffer.end(), shifted.begin() + 1);
+	EXPECT_FALSE(flat::verify<Config>(make_array_view(shifted.data() + 1, buffer.size())));
+}
+
+TEST(flat, VerifyRejectsCycles)
+{
+	flat::builder b;
+	auto config = b.create<Config>();
+	b.set(config, &Config::parent, config);
+	b.finish(config);
+	EXPECT_FALSE(flat::verify<Config>(b.data()));
+	EXPECT_THAT(flat::root<Config>(b.data()).parent.get(), Eq(&flat::root<Config>(b.data())));
+}
+
+TEST(flat, VerifyLimitsSharedReferences)
+{
+	// Within max_depth, but would take 2^40 visits
+	auto chain = shared_chain(40);
+	EXPECT_FALSE(flat::verify<Node>(make_array_view(chain.data(), chain.size())));
+
+	// Sharing is fine as long as it stays within the budget
+	auto small = shared_chain(6);
+	auto bytes = make_array_view(small.data(), small.size());
+	EXPECT_FALSE(flat::verify<Node>(bytes, 64, 62));
+	EXPECT_TRUE(flat::verify<Node>(bytes, 64, 63));
+}
+
+TEST(flat, VerifyLimitsSharedVectors)
+{
+	// Every member refers to the same vector of strings
+	flat::builder b;
+	const flat::offset<flat::string> strings[] = { b.create_string("a"), b.create_string("b"), b.create_string("c") };
+	auto names = b.create<Names>();
+	b.set(names, &Names::names, b.create_vector(make_array_view(strings)));
+	const flat::offset<Names> shared[] = { names, names, names, names };
+	auto group = b.create<Group>();
+	b.set(group, &Group::members, b.create_vector(make_array_view(shared)));
+	b.finish(group);
+
+	// 1 group, 1 vector of members, 4 times 1 member, 1 vector and 3 strings
+	EXPECT_FALSE(flat::verify<Group>(b.data(), 64, 21));
+	EXPECT_TRUE(flat::verify<Group>(b.data(), 64, 22));
+}
@@ -0,0 +1,122 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+#include <xtd/group_by.hpp>
+
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace xtd;
+using namespace testing;
+
+namespace
+{
+	struct expected_group
+	{
+		std::uint64_t count = 0;
+		double sum = 0;
+		double min = 0;
+		double max = 0;
+	};
+
+	template<class Key, class Value>
+	std::map<Key, expected_group> expected_groups(const std::vector<Key>& keys, const std::vector<Value>& values)
+	{
+		std::map<Key, expected_group> result;
+		for(std::size_t i = 0; i < keys.size(); ++i)
+		{
+			auto& g = result[keys[i]];
+			g.min = g.count == 0 ? values[i] : std::min<double>(g.min, values[i]);
+			g.max = g.count == 0 ? values[i] : std::max<double>(g.max, values[i]);
+			++g.count;
+			g.sum += values[i];
+		}
+		return result;
+	}
+
+	template<class Key, class Value>
+	void expect_groups(const group_aggregates<Key, Value>& actual, const std::map<Key, expected_group>& expected)
+	{
+		ASSERT_THAT(actual.size(), Eq(expected.size()));
+		ASSERT_THAT(actual.counts.size(), Eq(expected.size()));
+		ASSERT_THAT(actual.maxs.size(), Eq(expected.size()));
+		for(std::size_t i = 0; i < actual.size(); ++i)
+		{
+			auto it = expected.find(actual.keys[i]);
+			ASSERT_TRUE(it != expected.end()) << actual.keys[i];
+			EXPECT_THAT(actual.counts[i], Eq(it->second.count)) << actual.keys[i];
+			EXPECT_THAT(static_cast<double>(actual.sums[i]), DoubleNear(it->second.sum, 1e-6)) << actual.keys[i];
+			EXPECT_THAT(static_cast<double>(actual.mins[i]), Eq(it->second.min)) << actual.keys[i];
+			EXPECT_THAT(static_cast<double>(actual.maxs[i]), Eq(it->second.max)) << actual.keys[i];
+			EXPECT_THAT(actual.mean(i), DoubleNear(it->second.sum / it->second.count, 1e-9)) << actual.keys[i];
+		}
+	}
+}
+
+TEST(group_by, Aggregates)
+{
+	std::vector<int> keys = { 3, -1, 3, 7, -1, 3 };
+	std::vector<double> values = { 1.5, 2, -4, 8, 0.5, 2.5 };
+	auto groups = group_by(keys, values);
+	// Groups appear in the order they are first seen
+	EXPECT_THAT(groups.keys, ElementsAre(3, -1, 7));
+	EXPECT_THAT(groups.counts, ElementsAre(3u, 2u, 1u));
+	EXPECT_THAT(groups.sums, ElementsAre(0, 2.5, 8));
+	EXPECT_THAT(groups.mins, ElementsAre(-4, 0.5, 8));
+	EXPECT_THAT(groups.maxs, ElementsAre(2.5, 2, 8));
+	EXPECT_THAT(groups.mean(1), DoubleEq(1.25));
+
+	auto none = group_by(std::vector<int>{}, std::vector<double>{});
+	EXPECT_THAT(none.size(), Eq(0u));
+}
+
+TEST(group_by, ManyGroups)
+{
+	// Enough groups for the table to grow several times, and integer sums which must not overflow the value type
+	std::mt19937_64 rng{1};
+	for(std::uint64_t distinct : { 1, 10, 1000, 100000 })
+	{
+		std::vector<std::uint64_t> keys(200000);
+		std::vector<std::uint16_t> values(keys.size());
+		for(std::size_t i = 0; i < keys.size(); ++i)
+		{
+			keys[i] = (rng() % distinct) << 20;
+			values[i] = static_cast<std::uint16_t>(rng());
+		}
+		expect_groups(group_by(keys, values), expected_groups(keys, values));
+	}
+}
+
+TEST(group_by, Parallel)
+{
+	std::mt19937 rng{2};
+	for(std::uint32_t distinct : { 3, 5000, 300000 })
+	{
+		std::vector<std::uint32_t> keys(400000);
+		std::vector<float> values(keys.size());
+		for(std::size_t i = 0; i < keys.size(); ++i)
+		{
+			keys[i] = rng() % distinct;
+			values[i] = static_cast<float>(rng() % 1000) - 500;
+		}
+		auto expected = expected_groups(keys, values);
+		for(unsigned threads : { 1, 2, 3, 8 })
+			expect_groups(group_by(execution::parallel_policy{threads}, keys, values), expected);
+	}
+
+	// Too small to partition
+	std::vector<short> keys = { 1, 2, 1 };
+	std::vector<int> values = { -5, 4, 6 };
+	auto groups = group_by(execution::par, keys, values);
+	EXPECT_THAT(groups.keys, ElementsAre(1, 2));
+	EXPECT_THAT(groups.sums, ElementsAre(1, 4));
+	EXPECT_THAT(groups.mins, ElementsAre(-5, 4));
+}
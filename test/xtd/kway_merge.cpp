@@ -0,0 +1,201 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+#include <xtd/kway_merge.hpp>
+#include <xtd/iomanip.hpp>
+
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+using namespace xtd;
+using namespace testing;
+
+namespace
+{
+	// Sorted runs of random lengths with many duplicates within and across runs
+	std::vector<std::vector<int>> make_runs(std::size_t k, std::size_t max_length, unsigned seed)
+	{
+		std::mt19937 rng{seed};
+		std::vector<std::vector<int>> runs(k);
+		for(auto& run : runs)
+		{
+			run.resize(rng() % (max_length + 1));
+			for(auto& x : run)
+				x = static_cast<int>(rng() % 1000);
+			std::sort(run.begin(), run.end());
+		}
+		return runs;
+	}
+
+	std::vector<array_view<const int>> views(const std::vector<std::vector<int>>& runs)
+	{
+		std::vector<array_view<const int>> result;
+		for(auto& run : runs)
+			result.push_back(make_array_view(run.data(), run.size()));
+		return result;
+	}
+
+	std::vector<int> expected_merge(const std::vector<std::vector<int>>& runs)
+	{
+		std::vector<int> result;
+		for(auto& run : runs)
+			result.insert(result.end(), run.begin(), run.end());
+		std::sort(result.begin(), result.end());
+		return result;
+	}
+}
+
+TEST(kway_merge, Merge)
+{
+	for(std::size_t k : { 0, 1, 2, 3, 7, 16, 100 })
+	{
+		auto runs = make_runs(k, 1000, static_cast<unsigned>(k));
+		auto expected = expected_merge(runs);
+		std::vector<int> out(expected.size() + 1, -1);
+		EXPECT_THAT(kway_merge(views(runs), out), Eq(expected.size())) << k;
+		EXPECT_TRUE(std::equal(expected.begin(), expected.end(), out.begin())) << k;
+		EXPECT_THAT(out.back(), Eq(-1)) << k;
+	}
+}
+
+TEST(kway_merge, ParallelMerge)
+{
+	for(std::size_t k : { 1, 2, 5, 33 })
+	{
+		auto runs = make_runs(k, 300000 / k, static_cast<unsigned>(k) + 100);
+		auto expected = expected_merge(runs);
+		for(unsigned threads : { 2, 3, 7 })
+		{
+			std::vector<int> out(expected.size());
+			EXPECT_THAT(kway_merge(execution::parallel_policy{threads}, views(runs), out), Eq(expected.size())) << k;
+			EXPECT_TRUE(out == expected) << k << ' ' << threads;
+		}
+	}
+
+	// All runs equal, selection has to split within ties
+	std::vector<std::vector<int>> same(4, std::vector<int>(100000, 7));
+	std::vector<int> out(400000);
+	kway_merge(execution::parallel_policy{3}, views(same), out);
+	EXPECT_TRUE(out == std::vector<int>(400000, 7));
+}
+
+TEST(kway_merge, Stable)
+{
+	// Ordered by key only, the second member tells the run
+	using P = std::pair<int, int>;
+	auto by_key = [] (const P& a, const P& b) { return a.first < b.first; };
+	std::vector<std::vector<P>> runs(5);
+	for(int r = 0; r < 5; ++r)
+		for(int i = 0; i < 40000; ++i)
+			runs[static_cast<std::size_t>(r)].emplace_back(i / 1000, r);
+	std::vector<array_view<const P>> v;
+	for(auto& run : runs)
+		v.push_back(make_array_view(run.data(), run.size()));
+
+	std::vector<P> expected;
+	for(auto& run : runs)
+		expected.insert(expected.end(), run.begin(), run.end());
+	std::stable_sort(expected.begin(), expected.end(), by_key);
+
+	std::vector<P> out(expected.size());
+	kway_merge(v, out, by_key);
+	EXPECT_TRUE(out == expected);
+	out.assign(out.size(), P{});
+	kway_merge(execution::parallel_policy{4}, v, out, by_key);
+	EXPECT_TRUE(out == expected);
+}
+
+TEST(kway_merge, OneComparisonPerLevel)
+{
+	// 16 runs make a tree of 4 levels
+	auto runs = make_runs(16, 1000, 5);
+	auto expected = expected_merge(runs);
+	std::size_t comparisons = 0;
+	auto counting = [&comparisons] (int a, int b) { ++comparisons; return a < b; };
+	std::vector<int> out(expected.size());
+	kway_merge(views(runs), out, counting);
+	EXPECT_TRUE(out == expected);
+	EXPECT_THAT(comparisons, Le(15 + 4 * expected.size()));
+}
+
+TEST(kway_merge, Batches)
+{
+	auto runs = make_runs(10, 500, 3);
+	auto expected = expected_merge(runs);
+	kway_merger<int> merger{views(runs)};
+	std::vector<int> merged;
+	std::vector<int> buffer(37);
+	while(auto n = merger.read(make_array_view(buffer.data(), buffer.size())))
+		merged.insert(merged.end(), buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(n));
+	EXPECT_TRUE(merger.empty());
+	EXPECT_TRUE(merged == expected);
+
+	kway_merger<int, std::greater<>> none{{}};
+	EXPECT_TRUE(none.empty());
+	EXPECT_THAT(none.read(make_array_view(buffer.data(), buffer.size())), Eq(0u));
+}
+
+TEST(kway_merge, Readers)
+{
+	auto runs = make_runs(20, 3000, 4);
+	runs[3].clear();
+	auto expected = expected_merge(runs);
+	std::vector<std::stringstream> files(runs.size());
+	for(std::size_t i = 0; i < runs.size(); ++i)
+		files[i] << unformatted(runs[i]);
+
+	// Blocks smaller than the runs
+	std::vector<binary_run_reader<int>> readers;
+	for(auto& f : files)
+		readers.emplace_back(f, 100);
+	kway_merger<int> merger{readers};
+	std::vector<int> out(expected.size() + 10);
+	EXPECT_THAT(merger.read(make_array_view(out.data(), out.size())), Eq(expected.size()));
+	out.resize(expected.size());
+	EXPECT_TRUE(out == expected);
+}
+
+TEST(kway_merge, TruncatedRun)
+{
+	std::stringstream file;
+	std::uint32_t values[] = { 1, 2, 3 };
+	file << unformatted(values) << 'x';
+	binary_run_reader<std::uint32_t> reader{file};
+	EXPECT_THROW(reader.next(), std::runtime_error);
+}
+
+TEST(kway_merge, NonPodRecords)
+{
+	// Trivially copyable, but not POD because of the initializers
+	struct record
+	{
+		std::uint64_t key = 0;
+		std::uint32_t value = 0;
+	};
+	std::vector<record> runs[2] = { { {1, 10}, {4, 40}, {5, 50} }, { {2, 20}, {3, 30} } };
+	std::stringstream files[2];
+	for(int i = 0; i < 2; ++i)
+		files[i].write(reinterpret_cast<const char*>(runs[i].data()), static_cast<std::streamsize>(runs[i].size() * sizeof(record)));
+
+	std::vector<binary_run_reader<record>> readers;
+	for(auto& f : files)
+		readers.emplace_back(f, 2);
+	auto by_key = [] (const record& a, const record& b) { return a.key < b.key; };
+	kway_merger<record, decltype(by_key)> merger{readers, by_key};
+	std::vector<record> out(8);
+	ASSERT_THAT(merger.read(make_array_view(out.data(), out.size())), Eq(5u));
+	for(std::size_t i = 0; i < 5; ++i)
+	{
+		EXPECT_THAT(out[i].key, Eq(i + 1));
+		EXPECT_THAT(out[i].value, Eq(10 * (i + 1)));
+	}
+}
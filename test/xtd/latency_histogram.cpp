@@ -0,0 +1,128 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+#include <xtd/latency_histogram.hpp>
+
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace xtd;
+using namespace testing;
+
+TEST(latency_histogram, Buckets)
+{
+	latency_histogram h{3, 1};
+	// Exact up to 2^(precision + 1), then 8 buckets per power of two
+	for(std::uint64_t v = 0; v < 16; ++v)
+	{
+		EXPECT_THAT(h.bucket(v), Eq(v));
+		EXPECT_THAT(h.lowest(h.bucket(v)), Eq(v));
+		EXPECT_THAT(h.highest(h.bucket(v)), Eq(v));
+	}
+	EXPECT_THAT(h.bucket(16), Eq(h.bucket(17)));
+	EXPECT_THAT(h.bucket(18), Eq(h.bucket(17) + 1));
+	EXPECT_THAT(h.highest(h.bucket(~std::uint64_t(0))), Eq(~std::uint64_t(0)));
+	EXPECT_THAT(h.buckets().size(), Eq(h.bucket(~std::uint64_t(0)) + 1));
+
+	// Consecutive buckets cover all values, each at most 2^-precision of its values wide
+	std::mt19937_64 rng{1};
+	for(int i = 0; i < 10000; ++i)
+	{
+		auto v = rng() >> (rng() % 64);
+		auto b = h.bucket(v);
+		EXPECT_THAT(h.lowest(b), Le(v));
+		EXPECT_THAT(h.highest(b), Ge(v));
+		EXPECT_THAT(static_cast<double>(h.highest(b) - h.lowest(b)), Le(static_cast<double>(v) / 8));
+		if(b > 0)
+		{
+			EXPECT_THAT(h.highest(b - 1) + 1, Eq(h.lowest(b)));
+		}
+	}
+}
+
+TEST(latency_histogram, Percentiles)
+{
+	latency_histogram empty;
+	EXPECT_THAT(empty.count(), Eq(0u));
+	EXPECT_THAT(empty.percentile(99), Eq(0u));
+	EXPECT_THAT(empty.mean(), Eq(0));
+
+	latency_histogram h;
+	std::vector<std::uint64_t> values;
+	std::mt19937_64 rng{2};
+	std::exponential_distribution<double> dist{1. / 50000};
+	for(int i = 0; i < 100000; ++i)
+		values.push_back(static_cast<std::uint64_t>(dist(rng)) + 100);
+	for(auto v : values)
+		h.record(v);
+	h.record(7, 0);
+	std::sort(values.begin(), values.end());
+
+	EXPECT_THAT(h.count(), Eq(values.size()));
+	std::uint64_t sum = 0;
+	for(auto v : values)
+		sum += v;
+	EXPECT_THAT(h.sum(), Eq(sum));
+	EXPECT_THAT(h.min(), AllOf(Le(values.front()), Ge(values.front() - values.front() / 128)));
+	EXPECT_THAT(h.max(), AllOf(Ge(values.back()), Le(values.back() + values.back() / 128)));
+	for(double p : { 0., 1., 50., 90., 99., 99.9, 100. })
+	{
+		auto rank = std::max<std::size_t>(static_cast<std::size_t>(std::ceil(p / 100 * static_cast<double>(values.size()))), 1);
+		auto expected = values[rank - 1];
+		EXPECT_THAT(h.percentile(p), AllOf(Ge(expected), Le(expected + expected / 128))) << p;
+	}
+	h.clear();
+	EXPECT_THAT(h.count(), Eq(0u));
+	EXPECT_THAT(h.sum(), Eq(0u));
+}
+
+TEST(latency_histogram, Threads)
+{
+	latency_histogram h{7, 3};
+	std::vector<std::thread> threads;
+	for(int t = 0; t < 6; ++t)
+		threads.emplace_back([&h, t] { for(std::uint64_t i = 0; i < 20000; ++i) h.record(i * 10 + static_cast<std::uint64_t>(t)); });
+	// Reading while recording
+	EXPECT_THAT(h.count(), Le(120000u));
+	for(auto& t : threads)
+		t.join();
+	EXPECT_THAT(h.count(), Eq(120000u));
+	EXPECT_THAT(h.percentile(50), AllOf(Ge(100000u), Le(101000u)));
+
+	latency_histogram other{7, 1};
+	other.record(5, 10);
+	h.merge(other);
+	EXPECT_THAT(h.count(), Eq(120010u));
+	EXPECT_THAT(h.min(), Eq(0u));
+	EXPECT_THAT(h.percentile(0.01), Eq(5u));
+}
+
+TEST(latency_histogram, Serialization)
+{
+	latency_histogram h{10, 2};
+	for(std::uint64_t v : { 1, 1000, 1000, 123456789 })
+		h.record(v);
+	std::stringstream s;
+	h.write(s);
+	EXPECT_THAT(s.str().size(), Eq(24u + 3 * 12));
+
+	auto copy = latency_histogram::read(s);
+	EXPECT_THAT(copy.precision(), Eq(10u));
+	EXPECT_TRUE(copy.buckets() == h.buckets());
+	EXPECT_THAT(copy.sum(), Eq(h.sum()));
+
+	std::stringstream truncated{s.str().substr(0, 30)};
+	EXPECT_THROW(latency_histogram::read(truncated), std::runtime_error);
+	std::stringstream garbage{std::string(40, 'x')};
+	EXPECT_THROW(latency_histogram::read(garbage), std::runtime_error);
+}
@@ -0,0 +1,175 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+#include <xtd/lz.hpp>
+#include <xtd/iomanip.hpp>
+
+#include "test_util.hpp"
+
+#include <gmock/gmock.h>
+
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace xtd;
+using namespace testing;
+
+namespace
+{
+	std::vector<unsigned char> text_corpus(std::size_t size)
+	{
+		const char* words[] = { "lorem ", "ipsum ", "dolor ", "sit ", "amet, ", "consectetur ", "adipiscing ", "elit.\n" };
+		std::minstd_rand rng{42};
+		std::vector<unsigned char> v;
+		while(v.size() < size)
+		{
+			auto w = words[rng() % 8];
+			v.insert(v.end(), w, w + std::strlen(w));
+		}
+		v.resize(size);
+		return v;
+	}
+
+	std::vector<unsigned char> roundtrip(const std::vector<unsigned char>& in, lz::level lvl)
+	{
+		std::vector<unsigned char> packed(lz::compress_bound(in.size()));
+		auto n = lz::compress(make_array_view(in.data(), in.size()), make_array_view(packed.data(), packed.size()), lvl);
+		EXPECT_THAT(n, Le(packed.size()));
+		std::vector<unsigned char> out(in.size());
+		EXPECT_THAT(lz::decompress(make_array_view(packed.data(), n), make_array_view(out.data(), out.size())), Eq(in.size()));
+		return out;
+	}
+}
+
+TEST(lz, RoundTrip)
+{
+	for(auto lvl : { lz::level::fast, lz::level::high })
+	{
+		for(auto size : { 0, 1, 12, 13, 100, 4096, 300000 })
+		{
+			auto text = text_corpus(size);
+			EXPECT_THAT(roundtrip(text, lvl), Eq(text)) << "text " << size;
+			auto noise = testutil::random_bytes(size, 7);
+			EXPECT_THAT(roundtrip(noise, lvl), Eq(noise)) << "random " << size;
+		}
+		auto zeros = std::vector<unsigned char>(100000, 0);
+		EXPECT_THAT(roundtrip(zeros, lvl), Eq(zeros));
+	}
+}
+
+TEST(lz, Ratio)
+{
+	auto text = text_corpus(1 << 20);
+	std::vector<unsigned char> packed(lz::compress_bound(text.size()));
+	auto fast = lz::compress(make_array_view(text.data(), text.size()), make_array_view(packed.data(), packed.size()), lz::level::fast);
+	auto high = lz::compress(make_array_view(text.data(), text.size()), make_array_view(packed.data(), packed.size()), lz::level::high);
+	EXPECT_THAT(fast, Lt(text.size() / 2));
+	EXPECT_THAT(high, Le(fast));
+}
+
+TEST(lz, KnownBlock)
+{
+	// "abcabcabcabcabcabc" encoded by hand: 3 literals, match at offset 3 of length 10, 5 trailing literals
+	const unsigned char block[] = { 0x36, 'a', 'b', 'c', 0x03, 0x00, 0x50, 'b', 'c', 'a', 'b', 'c' };
+	unsigned char out[18];
+	ASSERT_THAT(lz::decompress(block, out), Eq(18u));
+	EXPECT_THAT(std::string(out, out + 18), Eq("abcabcabcabcabcabc"));
+}
+
+TEST(lz, DestinationTooSmall)
+{
+	auto text = text_corpus(1000);
+	std::vector<unsigned char> packed(10);
+	EXPECT_THROW(lz::compress(make_array_view(text.data(), text.size()), make_array_view(packed.data(), packed.size())), std::length_error);
+
+	packed.resize(lz::compress_bound(text.size()));
+	auto n = lz::compress(make_array_view(text.data(), text.size()), make_array_view(packed.data(), packed.size()));
+	std::vector<unsigned char> out(text.size() - 1);
+	EXPECT_THROW(lz::decompress(make_array_view(packed.data(), n), make_array_view(out.data(), out.size())), std::length_error);
+}
+
+TEST(lz, MalformedInput)
+{
+	unsigned char out[64];
+	const unsigned char truncated[] = { 0xF0 };
+	EXPECT_THROW(lz::decompress(truncated, out), lz::format_error);
+	const unsigned char bad_offset[] = { 0x10, 'a', 0x05, 0x00, 0x00 };
+	EXPECT_THROW(lz::decompress(bad_offset, out), lz::format_error);
+	const unsigned char zero_offset[] = { 0x10, 'a', 0x00, 0x00, 0x00 };
+	EXPECT_THROW(lz::decompress(zero_offset, out), lz::format_error);
+}
+
+TEST(lz, StreamBuffers)
+{
+	auto values = std::vector<int>(200000);
+	for(std::size_t i = 0; i < values.size(); ++i)
+		values[i] = static_cast<int>(i % 1000);
+
+	std::stringstream ss;
+	{
+		lz::compressbuf buf{ss.rdbuf(), lz::level::high, 1 << 14};
+		std::ostream out{&buf};
+		out << unformatted(values) << "tail";
+		out.flush();
+		out << 'x';
+	}
+	EXPECT_THAT(ss.str().size(), Lt(values.size() * sizeof(int) / 2));
+
+	lz::decompressbuf buf{ss.rdbuf(), 1 << 14};
+	std::istream in{&buf};
+	std::vector<int> read;
+	std::string tail;
+	in >> unformatted(read, values.size()) >> tail;
+	EXPECT_TRUE(read == values);
+	EXPECT_THAT(tail, Eq("tailx"));
+	EXPECT_THAT(in.get(), Eq(std::char_traits<char>::eof()));
+}
+
+TEST(lz, StreamBufferMalformed)
+{
+	std::stringstream ss;
+	{
+		lz::compressbuf buf{ss.rdbuf()};
+		std::ostream out{&buf};
+		out << std::string(1000, 'a');
+	}
+	auto data = ss.str();
+	data.resize(data.size() / 2);
+	std::stringstream truncated{data};
+	lz::decompressbuf buf{truncated.rdbuf()};
+	std::istream in{&buf};
+	std::string s;
+	in >> s;
+	EXPECT_TRUE(in.bad());
+}
+
+TEST(lz, StreamBufferOversizedBlock)
+{
+	// Blocks larger than the block size are rejected before anything is allocated for them
+	std::stringstream ss;
+	{
+		lz::compressbuf buf{ss.rdbuf(), lz::level::fast, 1 << 14};
+		std::ostream out{&buf};
+		out << std::string(20000, 'a');
+	}
+	auto data = ss.str();
+	std::stringstream small{data};
+	lz::decompressbuf buf{small.rdbuf(), 1 << 12};
+	std::istream in{&buf};
+	std::string s;
+	in >> s;
+	EXPECT_TRUE(in.bad());
+
+	const unsigned char header[] = { 0x00, 0x00, 0x00, 0x7E, 0x10, 0x00, 0x00, 0x00 };
+	std::stringstream huge{std::string(header, header + sizeof(header))};
+	lz::decompressbuf huge_buf{huge.rdbuf()};
+	std::istream huge_in{&huge_buf};
+	huge_in >> s;
+	EXPECT_TRUE(huge_in.bad());
+}
@@ -0,0 +1,203 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+#include <xtd/numeric.hpp>
+#include <xtd/array_view.hpp>
+
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace xtd;
+using namespace testing;
+
+TEST(numeric, Accumulate)
+{
+	const int values[] = { 1, 2, 3, 4 };
+	EXPECT_THAT(xtd::accumulate(std::begin(values), std::end(values), 0), Eq(10));
+	EXPECT_THAT(xtd::accumulate(std::begin(values), std::end(values), 1, std::multiplies<>{}), Eq(24));
+	EXPECT_THAT(xtd::accumulate(std::begin(values), std::begin(values), 5), Eq(5));
+	EXPECT_THAT(xtd::accumulate(std::vector<int>(values, values + 4), 0), Eq(10));
+}
+
+TEST(numeric, Reduce)
+{
+	for(std::size_t n : { 0, 1, 7, 8, 31, 32, 33, 1000, 100003, 300007 })
+	{
+		std::vector<int> v(n);
+		for(std::size_t i = 0; i < n; ++i)
+			v[i] = static_cast<int>(i % 997) - 50;
+		auto expected = std::accumulate(v.begin(), v.end(), 3);
+		EXPECT_THAT(reduce(v, 3), Eq(expected)) << n;
+		EXPECT_THAT(reduce(execution::parallel_policy{4}, v, 3), Eq(expected)) << n;
+
+		std::vector<double> d(v.begin(), v.end());
+		EXPECT_THAT(reduce(d), DoubleEq(expected - 3)) << n;
+		EXPECT_THAT(reduce(execution::par, d), DoubleEq(expected - 3)) << n;
+	}
+}
+
+TEST(numeric, ReduceOperations)
+{
+	std::array<std::uint64_t, 40> v;
+	v.fill(2);
+	EXPECT_THAT(reduce(v, std::uint64_t(1), std::multiplies<>{}), Eq(std::uint64_t(1) << 40));
+	EXPECT_THAT(reduce(v, std::uint64_t(0), [] (auto a, auto b) { return std::max(a, b); }), Eq(2u));
+
+	// Accumulates in the type of init
+	std::vector<unsigned char> bytes(1000, 200);
+	EXPECT_THAT(reduce(bytes, 0u), Eq(200000u));
+	EXPECT_THAT(reduce(bytes), Eq(static_cast<unsigned char>(200000)));
+
+	std::vector<std::string> strings = { "a", "b", "c", "d", "e", "f", "g", "h", "i" };
+	EXPECT_THAT(reduce(strings).size(), Eq(9u));
+
+	const float floats[] = { 1.5f, 2.5f };
+	EXPECT_THAT(reduce(make_array_view(floats)), FloatEq(4.f));
+}
+
+TEST(numeric, ParallelReduceExceptions)
+{
+	std::vector<int> v(1 << 20, 1);
+	auto op = [] (int a, int b) { if(a + b > 100000) throw std::overflow_error{"too big"}; return a + b; };
+	EXPECT_THROW(reduce(execution::parallel_policy{4}, v, 0, op), std::overflow_error);
+}
+
+TEST(numeric, AccurateSums)
+{
+	// 0.1f is not representable, the exact sum of its float value is known in double precision
+	std::vector<float> tenths(1000003, 0.1f);
+	const double exact = 1000003 * double(0.1f);
+	EXPECT_THAT(std::abs(xtd::accumulate(tenths, 0.f) - exact) / exact, Gt(1e-3));
+	EXPECT_THAT(std::abs(pairwise_sum(tenths) - exact) / exact, Lt(1e-6));
+	EXPECT_THAT(std::abs(kahan_sum(tenths) - exact) / exact, Lt(1e-7));
+	EXPECT_THAT(std::abs(neumaier_sum(tenths) - exact) / exact, Lt(1e-7));
+
+	// Elements larger than the partial sum
+	std::vector<double> cancelling;
+	for(int i = 0; i < 10001; ++i)
+		cancelling.insert(cancelling.end(), { 1.0, 1e16, 1.0, -1e16 });
+	EXPECT_THAT(xtd::accumulate(cancelling, 0.0), Eq(0.0));
+	EXPECT_THAT(neumaier_sum(cancelling), Eq(20002.0));
+	const double small[] = { 1.0, 1e100, 1.0, -1e100 };
+	EXPECT_THAT(neumaier_sum(make_array_view(small)), Eq(2.0));
+
+	EXPECT_THAT(pairwise_sum(std::vector<double>{}), Eq(0.0));
+	EXPECT_THAT(kahan_sum(std::vector<float>{ 1.5f }), Eq(1.5f));
+}
+
+TEST(numeric, AccurateSumsAreDeterministic)
+{
+	std::mt19937 rng{7};
+	std::uniform_real_distribution<double> dist{-1e6, 1e6};
+	std::vector<double> v(1000003);
+	for(auto& x : v)
+		x = dist(rng) * std::pow(10.0, static_cast<int>(rng() % 20) - 10);
+
+	auto pairwise = pairwise_sum(v);
+	auto kahan = kahan_sum(v);
+	auto neumaier = neumaier_sum(v);
+	for(unsigned threads : { 1, 2, 3, 7 })
+	{
+		execution::parallel_policy policy{threads};
+		EXPECT_THAT(pairwise_sum(policy, v), Eq(pairwise)) << threads;
+		EXPECT_THAT(kahan_sum(policy, v), Eq(kahan)) << threads;
+		EXPECT_THAT(neumaier_sum(policy, v), Eq(neumaier)) << threads;
+	}
+}
+
+TEST(numeric, Scan)
+{
+	for(std::size_t n : { 0, 1, 3, 4, 8, 9, 33, 1000, 300007 })
+	{
+		std::vector<int> v(n);
+		for(std::size_t i = 0; i < n; ++i)
+			v[i] = static_cast<int>(i % 997) - 50;
+		std::vector<int> expected(n);
+		std::partial_sum(v.begin(), v.end(), expected.begin());
+		for(auto& x : expected)
+			x += 3;
+		auto total = n ? expected.back() : 3;
+
+		std::vector<int> out(n);
+		EXPECT_THAT(inclusive_scan(v, out, 3), Eq(total)) << n;
+		EXPECT_TRUE(out == expected) << n;
+		out.assign(n, 0);
+		EXPECT_THAT(inclusive_scan(execution::parallel_policy{4}, v, out, 3), Eq(total)) << n;
+		EXPECT_TRUE(out == expected) << n;
+
+		// Exclusive results are the inclusive ones shifted by one
+		expected.insert(expected.begin(), 3);
+		expected.pop_back();
+		EXPECT_THAT(exclusive_scan(v, out, 3), Eq(total)) << n;
+		EXPECT_TRUE(out == expected) << n;
+		out.assign(n, 0);
+		EXPECT_THAT(exclusive_scan(execution::parallel_policy{3}, v, out, 3), Eq(total)) << n;
+		EXPECT_TRUE(out == expected) << n;
+
+		// In place
+		EXPECT_THAT(exclusive_scan(execution::par, v, v, 3), Eq(total)) << n;
+		EXPECT_TRUE(v == expected) << n;
+	}
+}
+
+TEST(numeric, ScanTypes)
+{
+	// Small integers are exact in floating point, so regrouping does not change the result
+	std::vector<double> d(1001);
+	std::vector<float> f(d.size());
+	std::vector<std::int64_t> i64(d.size());
+	for(std::size_t i = 0; i < d.size(); ++i)
+		i64[i] = static_cast<std::int64_t>(i % 13) - 6;
+	std::copy(i64.begin(), i64.end(), d.begin());
+	std::copy(i64.begin(), i64.end(), f.begin());
+	std::vector<std::int64_t> expected(i64.size());
+	std::partial_sum(i64.begin(), i64.end(), expected.begin());
+
+	EXPECT_THAT(inclusive_scan(i64, i64), Eq(expected.back()));
+	EXPECT_TRUE(i64 == expected);
+	EXPECT_THAT(inclusive_scan(d, d), DoubleEq(expected.back()));
+	EXPECT_TRUE(std::equal(d.begin(), d.end(), expected.begin()));
+	EXPECT_THAT(exclusive_scan(f, f, -0.f), FloatEq(expected.back()));
+	EXPECT_THAT(f[0], Eq(0.f));
+	EXPECT_TRUE(std::signbit(f[0]));
+	EXPECT_TRUE(std::equal(f.begin() + 1, f.end(), expected.begin()));
+
+	// Offsets of variable length records, accumulated in a wider type
+	std::vector<std::uint32_t> lengths(100, 3000000000u);
+	std::vector<std::uint64_t> offsets(lengths.size());
+	EXPECT_THAT(exclusive_scan(lengths, offsets), Eq(300000000000u));
+	EXPECT_THAT(offsets[99], Eq(297000000000u));
+
+	// init may have a different type than the output, it is converted before accumulating
+	std::fill(offsets.begin(), offsets.end(), 0);
+	exclusive_scan(lengths, offsets, 0);
+	EXPECT_THAT(offsets[99], Eq(297000000000u));
+	std::fill(offsets.begin(), offsets.end(), 0);
+	exclusive_scan(execution::parallel_policy{2}, lengths, offsets, 0);
+	EXPECT_THAT(offsets[99], Eq(297000000000u));
+	std::vector<std::uint32_t> small = { 1, 2, 3 };
+	EXPECT_THAT(inclusive_scan(small, offsets, 1), Eq(7));
+	EXPECT_THAT(inclusive_scan(execution::par, small, offsets, 1), Eq(7));
+	EXPECT_THAT(offsets[2], Eq(7u));
+
+	// Not commutative, applied in order
+	std::vector<std::string> strings = { "a", "b", "c" };
+	std::vector<std::string> prefixes(3);
+	EXPECT_THAT(inclusive_scan(strings, prefixes, std::string{">"}), Eq(">abc"));
+	EXPECT_THAT(prefixes, ElementsAre(">a", ">ab", ">abc"));
+
+	std::array<unsigned, 4> factors = {{ 1, 2, 3, 4 }};
+	std::array<unsigned, 4> products;
+	EXPECT_THAT(inclusive_scan(factors, products, 1u, std::multiplies<>{}), Eq(24u));
+	EXPECT_THAT(products, ElementsAre(1u, 2u, 6u, 24u));
+}
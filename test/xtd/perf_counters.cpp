@@ -0,0 +1,102 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+#include <xtd/perf_counters.hpp>
+
+#include <gmock/gmock.h>
+
+#include <iostream>
+#include <memory>
+#include <vector>
+
+using namespace xtd;
+using namespace testing;
+
+namespace
+{
+	// Containers and CI machines may forbid perf_event_open entirely
+	std::unique_ptr<perf_counters> open_counters()
+	{
+		try
+		{
+			return std::make_unique<perf_counters>();
+		}
+		catch(const std::system_error& e)
+		{
+			std::cout << "perf_event_open unavailable: " << e.what() << '\n';
+			return nullptr;
+		}
+	}
+
+	volatile std::uint64_t sink;
+
+	void work()
+	{
+		std::uint64_t x = 1;
+		for(int i = 0; i < 10000000; ++i)
+			x = x * 6364136223846793005u + 1442695040888963407u;
+		sink = x;
+	}
+}
+
+TEST(perf_counters, Counts)
+{
+	perf_counts a;
+	a.cycles = 200;
+	a.instructions = 300;
+	EXPECT_THAT(a.ipc(), DoubleEq(1.5));
+	EXPECT_THAT(perf_counts{}.ipc(), Eq(0));
+	auto b = a + a;
+	EXPECT_THAT(b.instructions, Eq(600u));
+	EXPECT_THAT((b - a).cycles, Eq(200u));
+}
+
+TEST(perf_counters, Read)
+{
+	auto counters = open_counters();
+	if(!counters)
+		return;
+	auto before = counters->read();
+	work();
+	auto delta = counters->read() - before;
+	if(counters->available(perf_event::task_clock))
+	{
+		EXPECT_THAT(delta.task_clock, Gt(1000000u));
+	}
+	if(counters->available(perf_event::instructions))
+	{
+		EXPECT_THAT(delta.instructions, Gt(10000000u));
+	}
+	else
+	{
+		EXPECT_THAT(delta.instructions, Eq(0u));
+	}
+}
+
+TEST(perf_counters, Scope)
+{
+	auto counters = open_counters();
+	if(!counters)
+		return;
+	std::vector<perf_counts> samples;
+	for(int i = 0; i < 2; ++i)
+	{
+		XTD_PERF_SCOPE(*counters, delta) { samples.push_back(delta); };
+		work();
+	}
+	ASSERT_THAT(samples.size(), Eq(2u));
+	if(counters->available(perf_event::task_clock))
+	{
+		EXPECT_THAT(samples[1].task_clock, Gt(1000000u));
+	}
+
+	bool called = false;
+	{
+		auto sampler = make_perf_sampler(*counters, [&] (const perf_counts&) { called = true; });
+		EXPECT_FALSE(called);
+	}
+	EXPECT_TRUE(called);
+}
@@ -0,0 +1,172 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+#include <xtd/serialize.hpp>
+
+#include <gmock/gmock.h>
+
+#include <sstream>
+
+using namespace xtd;
+using namespace testing;
+
+namespace
+{
+	struct Point
+	{
+		float x, y;
+		bool operator==(const Point& p) const { return x == p.x && y == p.y; }
+	};
+
+	struct Inner
+	{
+		std::string name;
+		optional<int> limit;
+
+		auto tie() { return std::tie(name, limit); }
+		bool operator==(const Inner& other) const { return name == other.name && limit == other.limit; }
+	};
+
+	struct Record
+	{
+		std::uint32_t id = 0;
+		double weight = 0;
+		char tag = 0;
+		std::string name;
+		std::vector<Point> points;
+		std::vector<Inner> children;
+		optional<Inner> extra;
+		std::uint16_t trailer = 0;
+
+		auto tie() { return std::tie(id, weight, tag, name, points, children, extra, trailer); }
+		bool operator==(const Record& r) const
+		{
+			return id == r.id && weight == r.weight && tag == r.tag && name == r.name && points == r.points
+				&& children == r.children && extra == r.extra && trailer == r.trailer;
+		}
+	};
+
+	struct View
+	{
+		std::uint8_t kind;
+		string_view key;
+		string_view value;
+
+		auto tie() { return std::tie(kind, key, value); }
+	};
+
+	Record sample()
+	{
+		Record r;
+		r.id = 42;
+		r.weight = 2.5;
+		r.tag = 'x';
+		r.name = "record";
+		r.points = { {1, 2}, {3, 4}, {5, 6} };
+		r.children = { {"a", nullopt}, {"bb", 7} };
+		r.extra = Inner{"extra", 9};
+		r.trailer = 0xBEEF;
+		return r;
+	}
+}
+
+TEST(serialize, Layout)
+{
+	auto bytes = serialize(std::make_tuple(std::uint32_t(1), char(2), std::string("ab")));
+	// Blittable members are packed without padding, sizes are LEB128 encoded
+	ASSERT_THAT(bytes.size(), Eq(4u + 1 + 1 + 2));
+	EXPECT_THAT(bytes[5], Eq(2));
+	EXPECT_THAT(bytes[6], Eq('a'));
+
+	auto big = serialize(std::string(300, 'z'));
+	ASSERT_THAT(big.size(), Eq(302u));
+	EXPECT_THAT(big[0], Eq(0xAC));
+	EXPECT_THAT(big[1], Eq(0x02));
+}
+
+TEST(serialize, BufferRoundTrip)
+{
+	auto out = sample();
+	auto bytes = serialize(out);
+
+	Record in;
+	EXPECT_THAT(deserialize(make_array_view(bytes.data(), bytes.size()), in), Eq(bytes.size()));
+	EXPECT_TRUE(in == out);
+}
+
+TEST(serialize, StreamRoundTrip)
+{
+	auto out = std::vector<Record>{ sample(), Record{}, sample() };
+	out[1].name = "empty";
+
+	std::stringstream ss;
+	ss << serialized(out) << serialized(out[0].id);
+	EXPECT_THAT(ss.str(), Eq(std::string(reinterpret_cast<const char*>(serialize(out).data()), serialize(out).size()) + std::string("\x2A\0\0\0", 4)));
+
+	std::vector<Record> in;
+	std::uint32_t id;
+	ss >> serialized(in) >> serialized(id);
+	EXPECT_TRUE(ss.good());
+	EXPECT_TRUE(in == out);
+	EXPECT_THAT(id, Eq(42u));
+}
+
+TEST(serialize, StringViewsReferToBuffer)
+{
+	std::string key = "key", value = "value";
+	auto bytes = serialize(View{3, key, value});
+
+	View in;
+	deserialize(make_array_view(bytes.data(), bytes.size()), in);
+	EXPECT_THAT(in.kind, Eq(3));
+	EXPECT_THAT(in.key, Eq(string_view{"key"}));
+	EXPECT_THAT(in.value, Eq(string_view{"value"}));
+	EXPECT_THAT(static_cast<const void*>(in.key.data()), Eq(static_cast<const void*>(bytes.data() + 2)));
+}
+
+TEST(serialize, TruncatedBuffer)
+{
+	auto bytes = serialize(sample());
+	for(std::size_t n = 0; n < bytes.size(); ++n)
+	{
+		Record in;
+		EXPECT_THROW(deserialize(make_array_view(bytes.data(), n), in), serialization_error) << n;
+	}
+}
+
+TEST(serialize, TruncatedStream)
+{
+	auto bytes = serialize(sample());
+	std::stringstream ss{std::string(bytes.begin(), bytes.end() - 1)};
+	Record in;
+	ss >> serialized(in);
+	EXPECT_TRUE(ss.fail());
+
+	// A huge length prefix must not allocate before reading fails
+	std::stringstream huge{std::string("\xFF\xFF\xFF\xFF\x0F", 5)};
+	std::vector<double> v;
+	huge >> serialized(v);
+	EXPECT_TRUE(huge.fail());
+	EXPECT_THAT(v.capacity(), Lt(1u << 20));
+
+	// Also for elements which are not blittable
+	std::stringstream huge_strings{std::string("\xFF\xFF\xFF\xFF\x0F\x01x", 7)};
+	std::vector<std::string> strings;
+	huge_strings >> serialized(strings);
+	EXPECT_TRUE(huge_strings.fail());
+	EXPECT_THAT(strings.capacity(), Lt(1u << 20));
+}
+
+TEST(serialize, MalformedOptional)
+{
+	const unsigned char bytes[] = { 2, 0, 0, 0, 0 };
+	optional<int> x;
+	EXPECT_THROW(deserialize(bytes, x), serialization_error);
+
+	std::stringstream ss{std::string(bytes, bytes + sizeof(bytes))};
+	ss >> serialized(x);
+	EXPECT_TRUE(ss.fail());
+}
@@ -0,0 +1,106 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+#include <xtd/spanstream.hpp>
+#include <xtd/iomanip.hpp>
+
+#include <gmock/gmock.h>
+
+#include <cstdint>
+
+using namespace xtd;
+using namespace testing;
+
+TEST(spanstream, ReadInPlace)
+{
+	const char data[] = "\x01\x02\x03\x04 42 rest";
+	ispanstream in{make_array_view(data, sizeof(data) - 1)};
+	std::uint32_t x;
+	int n;
+	std::string word;
+	in >> unformatted(x) >> n >> word;
+	EXPECT_FALSE(in.fail());
+	EXPECT_THAT(x, Eq(0x04030201u));
+	EXPECT_THAT(n, Eq(42));
+	EXPECT_THAT(word, Eq("rest"));
+	EXPECT_THAT(static_cast<const void*>(in.span().data()), Eq(static_cast<const void*>(data)));
+
+	in >> word;
+	EXPECT_TRUE(in.eof());
+	EXPECT_TRUE(in.fail());
+}
+
+TEST(spanstream, ReadStringView)
+{
+	ispanstream in{string_view{"abcdef"}};
+	char c[4];
+	in >> unformatted(c, 3);
+	EXPECT_THAT(std::string(c, 3), Eq("abc"));
+	EXPECT_THAT(in.tellg(), Eq(3));
+	in.seekg(-2, std::ios_base::end);
+	EXPECT_THAT(in.get(), Eq('e'));
+	in.seekg(1);
+	EXPECT_THAT(in.get(), Eq('b'));
+	EXPECT_TRUE(in.unget().good());
+	EXPECT_THAT(in.get(), Eq('b'));
+	in.seekg(7);
+	EXPECT_TRUE(in.fail());
+}
+
+TEST(spanstream, WriteInPlace)
+{
+	char buffer[8];
+	ospanstream out{buffer};
+	std::uint16_t ab = 0x4241;
+	out << unformatted(ab) << 12 << 'x';
+	EXPECT_TRUE(out.good());
+	EXPECT_THAT(std::string(out.span().data(), out.span().size()), Eq("AB12x"));
+	EXPECT_THAT(static_cast<void*>(out.span().data()), Eq(static_cast<void*>(buffer)));
+
+	// Overflowing the range fails the stream without writing past its end
+	out << "overflow";
+	EXPECT_TRUE(out.bad());
+	EXPECT_THAT(out.span().size(), Eq(8u));
+
+	out.clear();
+	out.seekp(2);
+	out << "34";
+	EXPECT_THAT(std::string(buffer, 4), Eq("AB34"));
+	EXPECT_THAT(out.span().size(), Eq(4u));
+}
+
+TEST(spanstream, ReadWrite)
+{
+	char buffer[6] = "xxxxx";
+	spanstream io{make_array_view(buffer, 5)};
+	io << "ab";
+	char c[3];
+	io >> unformatted(c);
+	EXPECT_THAT(std::string(c, 3), Eq("abx"));
+	EXPECT_THAT(io.span().size(), Eq(5u));
+}
+
+TEST(spanstream, ReadOnlyRange)
+{
+	// A const range disables writing only until the next writable one
+	const char text[] = "abc";
+	char buffer[6] = "xxxxx";
+	spanstream io{make_array_view(buffer, 5)};
+	io.rdbuf()->span(make_array_view(text, 3));
+	EXPECT_THAT(io.rdbuf()->sputc('y'), Eq(std::char_traits<char>::eof()));
+	EXPECT_THAT(io.rdbuf()->sgetc(), Eq('a'));
+	io.span(make_array_view(buffer, 5));
+	io << "ab";
+	EXPECT_TRUE(io.good());
+	EXPECT_THAT(std::string(buffer, 5), Eq("abxxx"));
+
+	viewbuf out{make_array_view(buffer, 5), std::ios_base::out};
+	out.span(make_array_view(text, 3));
+	EXPECT_THAT(out.sputc('y'), Eq(std::char_traits<char>::eof()));
+	out.span(make_array_view(buffer, 5));
+	EXPECT_THAT(out.sputc('z'), Eq('z'));
+	EXPECT_THAT(buffer[0], Eq('z'));
+}
@@ -0,0 +1,104 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+#include <xtd/static_search.hpp>
+
+#include <gmock/gmock.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace xtd;
+using namespace testing;
+
+namespace
+{
+	// Every lower bound of a sorted array with duplicates, including values between and outside the elements
+	template<class Index, class T>
+	void check(const std::vector<T>& sorted)
+	{
+		Index index{make_array_view(sorted.data(), sorted.size())};
+		EXPECT_THAT(index.size(), Eq(sorted.size()));
+		for(T value = -2; value < static_cast<T>(2 * sorted.size() + 3); ++value)
+		{
+			auto expected = static_cast<std::size_t>(std::lower_bound(sorted.begin(), sorted.end(), value) - sorted.begin());
+			ASSERT_THAT(index.lower_bound(value), Eq(expected)) << sorted.size() << " " << value;
+			ASSERT_THAT(index.contains(value), Eq(std::binary_search(sorted.begin(), sorted.end(), value))) << sorted.size() << " " << value;
+		}
+	}
+
+	template<class T>
+	std::vector<T> sorted_values(std::size_t n, unsigned seed)
+	{
+		std::mt19937 rng{seed};
+		std::vector<T> v(n);
+		for(auto& x : v)
+			x = static_cast<T>(rng() % (2 * n + 1));
+		std::sort(v.begin(), v.end());
+		return v;
+	}
+}
+
+TEST(static_search, BranchlessLowerBound)
+{
+	for(std::size_t n = 0; n < 70; ++n)
+	{
+		auto v = sorted_values<int>(n, static_cast<unsigned>(n));
+		for(int value = -1; value < static_cast<int>(2 * n + 2); ++value)
+			ASSERT_THAT(branchless_lower_bound(v, value), Eq(v.data() + (std::lower_bound(v.begin(), v.end(), value) - v.begin()))) << n << " " << value;
+	}
+	const int descending[] = { 9, 7, 7, 3 };
+	EXPECT_THAT(branchless_lower_bound(make_array_view(descending), 7, std::greater<>{}), Eq(descending + 1));
+}
+
+TEST(static_search, Eytzinger)
+{
+	// Every shape of the last level for small sizes
+	for(std::size_t n = 0; n < 70; ++n)
+		check<eytzinger_index<int>>(sorted_values<int>(n, static_cast<unsigned>(n)));
+	check<eytzinger_index<int>>(sorted_values<int>(10000, 1));
+	check<eytzinger_index<double>>(sorted_values<double>(1000, 2));
+	check<eytzinger_index<std::int64_t>>(sorted_values<std::int64_t>(4097, 3));
+}
+
+TEST(static_search, StaticBtree)
+{
+	for(std::size_t n = 0; n < 70; ++n)
+	{
+		auto v = sorted_values<int>(n, static_cast<unsigned>(n));
+		check<static_btree<int>>(v);
+		check<static_btree<int, 4>>(v);
+		check<static_btree<int, 1>>(v);
+		check<static_btree<int, 3>>(v);
+	}
+	check<static_btree<int>>(sorted_values<int>(100000, 1));
+	check<static_btree<int, 2>>(sorted_values<int>(10000, 1));
+	check<static_btree<float>>(sorted_values<float>(5000, 2));
+	check<static_btree<std::uint64_t>>(sorted_values<std::uint64_t>(5000, 2));
+	check<static_btree<std::int8_t>>(sorted_values<std::int8_t>(40, 2));
+
+	std::vector<int> v = { 1, 2, 3 };
+	static_btree<int> tree{make_array_view(v.data(), v.size())};
+	EXPECT_THAT(tree[2], Eq(3));
+}
+
+TEST(static_search, Strings)
+{
+	std::vector<std::string> words = { "apple", "fig", "fig", "kiwi", "pear", "plum" };
+	auto view = make_array_view(words.data(), words.size());
+	eytzinger_index<std::string> e{view};
+	static_btree<std::string, 2> b{view};
+	for(auto& w : { "a", "fig", "grape", "plum", "z" })
+	{
+		auto expected = static_cast<std::size_t>(std::lower_bound(words.begin(), words.end(), w) - words.begin());
+		EXPECT_THAT(e.lower_bound(w), Eq(expected)) << w;
+		EXPECT_THAT(b.lower_bound(w), Eq(expected)) << w;
+	}
+	EXPECT_TRUE(e.contains("kiwi"));
+	EXPECT_FALSE(b.contains("grape"));
+	EXPECT_TRUE(eytzinger_index<std::string>{}.empty());
+}
@@ -0,0 +1,159 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+#include <xtd/statistics.hpp>
+
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace xtd;
+using namespace testing;
+
+namespace
+{
+	std::vector<double> normal(std::size_t n, unsigned seed)
+	{
+		std::mt19937_64 rng{seed};
+		std::normal_distribution<double> dist{1e6, 3};
+		std::vector<double> v(n);
+		for(auto& x : v)
+			x = dist(rng);
+		return v;
+	}
+
+	// Two pass reference
+	void expect_stats(const running_stats& stats, const std::vector<double>& v)
+	{
+		double mean = 0;
+		for(auto x : v)
+			mean += x;
+		mean /= static_cast<double>(v.size());
+		double m2 = 0;
+		for(auto x : v)
+			m2 += (x - mean) * (x - mean);
+		EXPECT_THAT(stats.count(), Eq(v.size()));
+		EXPECT_THAT(stats.mean(), DoubleNear(mean, 1e-9 * std::abs(mean)));
+		EXPECT_THAT(stats.variance(), DoubleNear(m2 / static_cast<double>(v.size()), 1e-6));
+		EXPECT_THAT(stats.min(), Eq(*std::min_element(v.begin(), v.end())));
+		EXPECT_THAT(stats.max(), Eq(*std::max_element(v.begin(), v.end())));
+	}
+}
+
+TEST(statistics, RunningStats)
+{
+	running_stats empty;
+	EXPECT_TRUE(empty.empty());
+	EXPECT_THAT(empty.mean(), Eq(0));
+	EXPECT_THAT(empty.variance(), Eq(0));
+	EXPECT_TRUE(std::isnan(empty.min()));
+
+	running_stats s;
+	for(double x : { 2, 4, 4, 4, 5, 5, 7, 9 })
+		s.push(x);
+	EXPECT_THAT(s.count(), Eq(8u));
+	EXPECT_THAT(s.mean(), DoubleEq(5));
+	EXPECT_THAT(s.variance(), DoubleEq(4));
+	EXPECT_THAT(s.stddev(), DoubleEq(2));
+	EXPECT_THAT(s.sample_variance(), DoubleEq(32. / 7));
+	EXPECT_THAT(s.sum(), DoubleEq(40));
+	EXPECT_THAT(s.min(), Eq(2));
+	EXPECT_THAT(s.max(), Eq(9));
+	s.clear();
+	EXPECT_TRUE(s.empty());
+}
+
+TEST(statistics, Batches)
+{
+	// A large mean and small variance, where the naive sum of squares loses all precision
+	for(std::size_t n : { 1, 3, 255, 256, 257, 1000, 100003 })
+	{
+		auto v = normal(n, static_cast<unsigned>(n));
+		expect_stats(statistics(v), v);
+
+		// Batches and single values mixed, and merged accumulators, give the same result
+		running_stats a, b;
+		auto half = n / 2;
+		a.push({v.data(), half / 3});
+		for(auto i = half / 3; i < half; ++i)
+			a.push(v[i]);
+		b.push({v.data() + half, n - half});
+		a.merge(b);
+		a.merge(running_stats{});
+		expect_stats(a, v);
+
+		running_stats c;
+		c.push(v);
+		expect_stats(c, v);
+	}
+}
+
+TEST(statistics, Parallel)
+{
+	auto v = normal(300007, 5);
+	for(unsigned threads : { 1, 2, 3, 8 })
+		expect_stats(statistics(execution::parallel_policy{threads}, v), v);
+	EXPECT_TRUE(statistics(execution::par, std::vector<double>{}).empty());
+}
+
+TEST(statistics, Quantiles)
+{
+	quantile_sketch empty;
+	EXPECT_TRUE(std::isnan(empty.quantile(0.5)));
+	EXPECT_THAT(empty.rank(1), Eq(0));
+
+	std::mt19937_64 rng{7};
+	std::vector<double> v(1000000);
+	for(std::size_t i = 0; i < v.size(); ++i)
+		v[i] = static_cast<double>(i);
+	std::shuffle(v.begin(), v.end(), rng);
+
+	quantile_sketch sketch;
+	sketch.push(v);
+	EXPECT_THAT(sketch.count(), Eq(v.size()));
+	EXPECT_THAT(sketch.retained(), Lt(1000u));
+	EXPECT_THAT(sketch.quantile(0), Eq(0));
+	EXPECT_THAT(sketch.quantile(1), Eq(999999));
+	for(double q : { 0.01, 0.25, 0.5, 0.9, 0.99, 0.999 })
+	{
+		EXPECT_THAT(sketch.quantile(q) / static_cast<double>(v.size()), DoubleNear(q, 0.02)) << q;
+		EXPECT_THAT(sketch.rank(q * static_cast<double>(v.size())), DoubleNear(q, 0.02)) << q;
+	}
+
+	// Sketches of parts merge into one of the whole, and single values are the same as batches
+	quantile_sketch merged;
+	for(std::size_t part = 0; part < 10; ++part)
+	{
+		quantile_sketch s{200, part};
+		for(std::size_t i = part * v.size() / 10; i < (part + 1) * v.size() / 10; ++i)
+			s.push(v[i]);
+		merged.merge(s);
+	}
+	EXPECT_THAT(merged.count(), Eq(v.size()));
+	EXPECT_THAT(merged.min(), Eq(0));
+	EXPECT_THAT(merged.max(), Eq(999999));
+	for(double q : { 0.01, 0.5, 0.99 })
+		EXPECT_THAT(merged.quantile(q) / static_cast<double>(v.size()), DoubleNear(q, 0.02)) << q;
+}
+
+TEST(statistics, SmallSketch)
+{
+	// Exact while nothing was compacted, NaNs ignored
+	quantile_sketch s;
+	double values[] = { 5, 1, std::nan(""), 4, 2, 3 };
+	s.push(values);
+	EXPECT_THAT(s.count(), Eq(5u));
+	EXPECT_THAT(s.quantile(0.5), Eq(3));
+	EXPECT_THAT(s.quantile(0.2), Eq(1));
+	EXPECT_THAT(s.quantile(0.21), Eq(2));
+	EXPECT_THAT(s.rank(4), DoubleEq(0.8));
+	s.clear();
+	EXPECT_TRUE(s.empty());
+	EXPECT_TRUE(std::isnan(s.max()));
+}
@@ -0,0 +1,67 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+/**
+ \file
+ Helpers shared by the tests: pseudo-random test data and a fixture creating a temporary file.
+
+ \author Miro Knejp
+ */
+
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <unistd.h>
+
+namespace testutil
+{
+	/// `size` pseudo-random bytes, the same for every call with the same `seed`.
+	inline std::vector<unsigned char> random_bytes(std::size_t size, unsigned seed)
+	{
+		std::minstd_rand rng{seed};
+		std::vector<unsigned char> v(size);
+		for(auto& x : v)
+			x = static_cast<unsigned char>(rng());
+		return v;
+	}
+
+	/**
+	 A fixture creating an empty file before each test and removing it afterwards.
+
+	 The file is created in `TMPDIR`, or `/tmp` if it is not set, so tests of `O_DIRECT` can be pointed away from a tmpfs which does not support it.
+	 */
+	template<class Base = ::testing::Test>
+	class temp_file_test : public Base
+	{
+	protected:
+		/// Create a file whose name starts with `xtd-<name>-`.
+		explicit temp_file_test(const char* name)
+		{
+			auto dir = std::getenv("TMPDIR");
+			auto pattern = std::string{dir && *dir ? dir : "/tmp"} + "/xtd-" + name + "-XXXXXX";
+			std::vector<char> buffer(pattern.c_str(), pattern.c_str() + pattern.size() + 1);
+			auto fd = ::mkstemp(buffer.data());
+			if(fd < 0)
+				throw std::system_error{errno, std::system_category(), "mkstemp"};
+			::close(fd);
+			path = buffer.data();
+		}
+		~temp_file_test()
+		{
+			::unlink(path.c_str());
+		}
+
+		std::string path;
+	};
+}
@@ -0,0 +1,129 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+#include <xtd/top_k.hpp>
+
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace xtd;
+using namespace testing;
+
+namespace
+{
+	template<class T, class Compare = std::less<>>
+	std::vector<T> expected_top_k(std::vector<T> v, std::size_t k, Compare comp = {})
+	{
+		std::sort(v.begin(), v.end(), [&] (const T& a, const T& b) { return comp(b, a); });
+		v.resize(std::min(k, v.size()));
+		return v;
+	}
+}
+
+template<class T>
+class top_k_typed : public Test { };
+
+using top_k_types = Types<std::int8_t, std::uint16_t, std::int32_t, std::uint64_t, float, double>;
+TYPED_TEST_CASE(top_k_typed, top_k_types);
+
+TYPED_TEST(top_k_typed, TopK)
+{
+	using T = TypeParam;
+	std::mt19937 rng{3};
+	for(std::size_t n : { 0, 1, 5, 64, 65, 1000, 100003 })
+	{
+		std::vector<T> v(n);
+		for(auto& x : v)
+			x = static_cast<T>(rng() % 100);
+		for(std::size_t k : { 0, 1, 3, 100, 200 })
+		{
+			EXPECT_TRUE(top_k(v, k) == expected_top_k(v, k)) << n << ' ' << k;
+			EXPECT_TRUE(top_k(v, k, std::greater<>{}) == expected_top_k(v, k, std::greater<>{})) << n << ' ' << k;
+		}
+	}
+}
+
+TYPED_TEST(top_k_typed, AccumulatorBatches)
+{
+	using T = TypeParam;
+	std::mt19937 rng{5};
+	std::vector<T> all;
+	top_k_accumulator<T> largest{10};
+	top_k_accumulator<T, std::greater<T>> smallest{10};
+	// Ascending values make every block pass the filter, random ones almost none once the threshold is high
+	for(std::size_t batch = 0; batch < 20; ++batch)
+	{
+		std::vector<T> v(batch * 37);
+		for(std::size_t i = 0; i < v.size(); ++i)
+			v[i] = static_cast<T>(batch % 2 ? i % 120 : rng() % 120);
+		largest.push(make_array_view(v.data(), v.size()));
+		smallest.push(make_array_view(v.data(), v.size()));
+		all.insert(all.end(), v.begin(), v.end());
+	}
+	EXPECT_TRUE(largest.full());
+	EXPECT_TRUE(largest.sorted() == expected_top_k(all, 10));
+	EXPECT_THAT(largest.threshold(), Eq(expected_top_k(all, 10).back()));
+	EXPECT_TRUE(smallest.sorted() == expected_top_k(all, 10, std::greater<>{}));
+}
+
+TEST(top_k, Accumulator)
+{
+	top_k_accumulator<int> acc{3};
+	EXPECT_THAT(acc.k(), Eq(3u));
+	EXPECT_THAT(acc.size(), Eq(0u));
+	acc.push(5);
+	acc.push(1);
+	EXPECT_FALSE(acc.full());
+	EXPECT_THAT(acc.threshold(), Eq(1));
+	acc.push(3);
+	acc.push(4);
+	acc.push(0);
+	EXPECT_TRUE(acc.full());
+	EXPECT_THAT(acc.threshold(), Eq(3));
+	EXPECT_THAT(acc.sorted(), ElementsAre(5, 4, 3));
+
+	// Thread local accumulators combined
+	top_k_accumulator<int> other{3};
+	const int values[] = { 2, 9, 4, 6 };
+	other.push(make_array_view(values));
+	acc.merge(other);
+	EXPECT_THAT(acc.sorted(), ElementsAre(9, 6, 5));
+
+	auto released = acc.release();
+	EXPECT_THAT(released, UnorderedElementsAre(9, 6, 5));
+	EXPECT_THAT(acc.size(), Eq(0u));
+	acc.push(7);
+	EXPECT_THAT(acc.sorted(), ElementsAre(7));
+	acc.clear();
+	EXPECT_THAT(acc.size(), Eq(0u));
+
+	top_k_accumulator<int> none{0};
+	none.push(1);
+	none.push(make_array_view(values));
+	EXPECT_THAT(none.size(), Eq(0u));
+}
+
+TEST(top_k, Candidates)
+{
+	// Scores with ids, compared with a custom predicate
+	std::vector<std::pair<float, std::string>> candidates;
+	for(int i = 0; i < 1000; ++i)
+		candidates.emplace_back(static_cast<float>((i * 7919) % 1000), std::to_string(i));
+	auto by_score = [] (const auto& a, const auto& b) { return a.first < b.first; };
+	auto best = top_k(candidates, 3, by_score);
+	ASSERT_THAT(best.size(), Eq(3u));
+	EXPECT_THAT(best[0].first, Eq(999.f));
+	EXPECT_THAT(best[1].first, Eq(998.f));
+	EXPECT_THAT(best[2].first, Eq(997.f));
+	EXPECT_THAT(std::stoi(best[0].second) * 7919 % 1000, Eq(999));
+}
@@ -0,0 +1,89 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+#include <xtd/trace.hpp>
+
+#include <gmock/gmock.h>
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace xtd;
+using namespace testing;
+
+namespace
+{
+	std::size_t occurrences(const std::string& s, const std::string& what)
+	{
+		std::size_t n = 0;
+		for(auto pos = s.find(what); pos != std::string::npos; pos = s.find(what, pos + 1))
+			++n;
+		return n;
+	}
+
+	void traced(int depth)
+	{
+		XTD_TRACE_SCOPE("traced");
+		if(depth > 0)
+			traced(depth - 1);
+	}
+}
+
+TEST(trace, Session)
+{
+	traced(3); // Not recorded without a session
+
+	// Settings of the caller's stream neither affect the events nor are changed by them
+	std::stringstream out;
+	out.setf(std::ios_base::hex | std::ios_base::showpos, std::ios_base::basefield | std::ios_base::showpos);
+	out.precision(9);
+	{
+		trace_options opts;
+		opts.interval = std::chrono::milliseconds{1};
+		trace_session session{out, opts};
+		{
+			XTD_TRACE_SCOPE("outer \"quoted\"");
+			traced(9);
+		}
+		std::vector<std::thread> threads;
+		for(int t = 0; t < 4; ++t)
+			threads.emplace_back([] { for(int i = 0; i < 1000; ++i) traced(0); });
+		for(auto& t : threads)
+			t.join();
+		session.flush();
+		EXPECT_THAT(session.events(), Eq(4011u));
+		EXPECT_THAT(session.dropped(), Eq(0u));
+	}
+	traced(3);
+
+	auto json = out.str();
+	EXPECT_THAT(json, StartsWith("{\"traceEvents\":[\n{"));
+	EXPECT_THAT(json, EndsWith("\n],\"displayTimeUnit\":\"ns\"}\n"));
+	EXPECT_THAT(occurrences(json, "\"ph\":\"X\""), Eq(4011u));
+	EXPECT_THAT(occurrences(json, "{\"name\":\"traced\""), Eq(4010u));
+	EXPECT_THAT(occurrences(json, "{\"name\":\"outer \\\"quoted\\\"\""), Eq(1u));
+	EXPECT_THAT(occurrences(json, "},\n{"), Eq(4010u));
+	EXPECT_THAT(occurrences(json, "+"), Eq(0u));
+	EXPECT_THAT(out.flags() & std::ios_base::basefield, Eq(std::ios_base::hex));
+	EXPECT_TRUE(out.flags() & std::ios_base::showpos);
+	EXPECT_THAT(out.precision(), Eq(9));
+}
+
+TEST(trace, Dropped)
+{
+	std::stringstream out;
+	trace_options opts;
+	opts.interval = std::chrono::hours{1};
+	opts.buffer_size = 100;
+	trace_session session{out, opts};
+	// A new thread gets a buffer of 128 events
+	std::thread{[] { for(int i = 0; i < 200; ++i) traced(0); }}.join();
+	session.flush();
+	EXPECT_THAT(session.events(), Eq(128u));
+	EXPECT_THAT(session.dropped(), Eq(72u));
+}
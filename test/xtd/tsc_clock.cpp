@@ -0,0 +1,90 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+#include <xtd/tsc_clock.hpp>
+
+#include <gmock/gmock.h>
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace xtd;
+using namespace testing;
+
+namespace
+{
+	void sleep_ms(int ms)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds{ms});
+	}
+}
+
+TEST(tsc_clock, Now)
+{
+	EXPECT_THAT(tsc_clock::frequency(), Gt(1e6));
+	if(!tsc_clock::uses_tsc())
+	{
+		EXPECT_THAT(tsc_clock::frequency(), DoubleEq(1e9));
+	}
+
+	// Agrees with steady_clock to well within a millisecond
+	auto steady = std::chrono::steady_clock::now().time_since_epoch();
+	auto tsc = tsc_clock::now().time_since_epoch();
+	EXPECT_THAT(std::abs((tsc - steady).count()), Lt(1000000));
+
+	auto a = tsc_clock::now();
+	sleep_ms(20);
+	auto b = tsc_clock::now();
+	EXPECT_THAT((b - a).count(), AllOf(Ge(19000000), Lt(200000000)));
+}
+
+TEST(tsc_clock, Conversions)
+{
+	auto t0 = tsc_clock::ticks();
+	sleep_ms(10);
+	auto t1 = tsc_clock::ordered_ticks();
+	EXPECT_THAT(t1, Gt(t0));
+	EXPECT_THAT(tsc_clock::to_duration(static_cast<std::int64_t>(t1 - t0)).count(), AllOf(Ge(9000000), Lt(100000000)));
+	EXPECT_THAT(tsc_clock::to_duration(0).count(), Eq(0));
+	EXPECT_THAT(tsc_clock::to_duration(static_cast<std::int64_t>(tsc_clock::frequency())).count(), AllOf(Ge(999999000), Le(1000001000)));
+
+	std::vector<std::uint64_t> ticks = { t0, t1, t0 - 1000, t1 + 1000 };
+	std::vector<std::int64_t> ns(ticks.size());
+	tsc_clock::to_nanoseconds(make_array_view(ticks.data(), ticks.size()), make_array_view(ns.data(), ns.size()));
+	for(std::size_t i = 0; i < ticks.size(); ++i)
+		EXPECT_THAT(ns[i], Eq(tsc_clock::from_ticks(ticks[i]).time_since_epoch().count())) << i;
+}
+
+TEST(tsc_clock, Stopwatch)
+{
+	stopwatch idle{false};
+	EXPECT_FALSE(idle.running());
+	sleep_ms(5);
+	EXPECT_THAT(idle.elapsed().count(), Eq(0));
+
+	stopwatch watch;
+	EXPECT_TRUE(watch.running());
+	sleep_ms(10);
+	watch.stop();
+	auto first = watch.elapsed();
+	EXPECT_THAT(first.count(), AllOf(Ge(9000000), Lt(100000000)));
+	sleep_ms(10);
+	EXPECT_THAT(watch.elapsed(), Eq(first));
+
+	// Intervals add up
+	watch.start();
+	sleep_ms(10);
+	auto both = watch.restart();
+	EXPECT_THAT(both.count(), Ge(first.count() + 9000000));
+	EXPECT_TRUE(watch.running());
+	EXPECT_THAT(watch.elapsed(), Lt(both));
+
+	watch.reset();
+	EXPECT_FALSE(watch.running());
+	EXPECT_THAT(watch.elapsed_ticks(), Eq(0u));
+}
@@ -6,14 +6,33 @@
 
 /**
  \file
- Provides `constexpr` and container overloads of `<algorithm>'.
+ Provides `constexpr` and container overloads of `<algorithm>', compile time sorting and searching for lookup tables, vectorized searches for the extremes of contiguous ranges, radix sorting, parallel sorting, branchless binary search and set operations on sorted arrays.
  
  \author Miro Knejp
  */
 
 #pragma once
+#include <xtd/execution.hpp>
+#include <xtd/string_view.hpp>
+
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <random>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__) && (defined(__GNUC__) || defined(__clang__))
+#define XTD_ALGORITHM_SSE2 1
+#include <emmintrin.h>
+#endif
 
 namespace xtd
 {
@@ -50,4 +69,1266 @@ namespace xtd
 			x = *x > *it ? it : x;
 		return *x;
 	}
+
+	/// \name Compile time sorting and searching
+	/**
+	 `constexpr` versions of `std::sort`, `std::lower_bound` and `std::unique`, and helpers building `std::array` lookup tables during compilation.
+
+	 The algorithms have a `constexpr_` prefix, as unconstrained templates of the standard names would be found by argument dependent lookup for iterators over `xtd` types and make unqualified calls such as `using std::sort; sort(first, last);` ambiguous.
+
+	 `constexpr_sort` is a heapsort, so it needs no recursion and few steps of constant evaluation, and like `std::sort` it is not stable. The iterator algorithms work on raw arrays in `constexpr` functions, since the iterators of `std::array` cannot be used during constant evaluation before C++17. Searching a `std::array` with `constexpr_lower_bound` returns an index instead. `sorted` returns a sorted copy of a `std::array` and `generate_array` fills one with `f(0)` to `f(N - 1)`. In C++14 lambdas cannot be used in constant expressions, so comparisons and generators must be function objects with a `constexpr` call operator, such as `std::less<>`.
+
+	 ~~~cpp
+	 constexpr auto primes = xtd::sorted(std::array<int, 5>{{ 7, 2, 11, 3, 5 }});
+	 static_assert(primes[xtd::constexpr_lower_bound(primes, 4)] == 5, "");
+
+	 struct square { constexpr int operator()(std::size_t i) const { return int(i * i); } };
+	 constexpr auto squares = xtd::generate_array<16>(square{});
+	 ~~~
+	 */
+	//@{
+	template<class RandomIt, class Compare = std::less<>>
+	constexpr void constexpr_sort(RandomIt first, RandomIt last, Compare comp = {});
+	template<class RandomIt, class T, class Compare = std::less<>>
+	constexpr RandomIt constexpr_lower_bound(RandomIt first, RandomIt last, const T& value, Compare comp = {});
+	template<class T, std::size_t N, class U, class Compare = std::less<>>
+	constexpr std::size_t constexpr_lower_bound(const std::array<T, N>& array, const U& value, Compare comp = {});
+	template<class ForwardIt, class BinaryPredicate = std::equal_to<>>
+	constexpr ForwardIt constexpr_unique(ForwardIt first, ForwardIt last, BinaryPredicate pred = {});
+	template<class T, std::size_t N, class Compare = std::less<>>
+	constexpr std::array<T, N> sorted(const std::array<T, N>& array, Compare comp = {});
+	template<std::size_t N, class F>
+	constexpr auto generate_array(F f) -> std::array<decltype(f(std::size_t{})), N>;
+	//@}
+
+	/// How `argmin`, `argmax`, `min_element`, `max_element` and `minmax` treat NaN elements.
+	enum class nan_policy
+	{
+		/// NaN elements are skipped, like missing values. The result is NaN only if all elements are NaN.
+		ignore,
+		/// Any NaN element makes the result NaN, the position of a NaN is the first one.
+		propagate,
+	};
+
+	namespace detail
+	{
+		namespace algorithm
+		{
+			template<class Range>
+			using contiguous_value_t = std::remove_cv_t<std::remove_pointer_t<decltype(std::declval<const Range&>().data() + std::declval<const Range&>().size())>>;
+		}
+	}
+
+	/// \name Extremes of contiguous ranges
+	/**
+	 Find the smallest or largest elements of a contiguous range.
+
+	 `argmin` and `argmax` return the index of the first smallest or largest element, or `range.size()` if the range is empty. `min_element` and `max_element` return a pointer to it, or past the end if the range is empty. `minmax` returns the values of both and requires a non-empty range.
+
+	 For arithmetic types the range is searched with SIMD instructions and several independent accumulators, then the position is located by a second vectorized pass for the first element equal to the result, which usually ends early. Other types fall back to a plain loop using `operator<`. Elements that compare equal, such as `0.0` and `-0.0`, are equally small.
+
+	 The `nan_policy` only matters for floating point types. Unlike `std::min_element` the result does not depend on where NaN elements appear.
+
+	 ~~~cpp
+	 std::vector<double> column = ...;
+	 auto i = xtd::argmin(column);
+	 auto bounds = xtd::minmax(column, xtd::nan_policy::propagate);
+	 ~~~
+	 */
+	//@{
+	template<class Range>
+	std::size_t argmin(const Range& range, nan_policy nans = nan_policy::ignore) noexcept;
+	template<class Range>
+	std::size_t argmax(const Range& range, nan_policy nans = nan_policy::ignore) noexcept;
+	template<class Range>
+	auto min_element(const Range& range, nan_policy nans = nan_policy::ignore) noexcept -> decltype(range.data());
+	template<class Range>
+	auto max_element(const Range& range, nan_policy nans = nan_policy::ignore) noexcept -> decltype(range.data());
+	template<class Range>
+	std::pair<detail::algorithm::contiguous_value_t<Range>, detail::algorithm::contiguous_value_t<Range>> minmax(const Range& range, nan_policy nans = nan_policy::ignore) noexcept;
+	//@}
+
+	/// \name Radix sort
+	/**
+	 Sort a contiguous range of integers, `float`, `double` or `string_view` in ascending order without comparisons.
+
+	 Numbers are sorted least significant byte first in one stable pass per byte, after mapping them to unsigned integers of the same order (flipping the sign bit, or all bits of negative floating point numbers). Passes in which all elements have the same byte are skipped, so small value ranges cost fewer passes. Floating point numbers are ordered by their bits: `-0.0` comes before `0.0`, positive NaN after infinity and negative NaN before negative infinity.
+
+	 `string_view` elements are sorted most significant byte first, ordering bytes as `unsigned char`, and small partitions are finished with `std::sort`.
+
+	 The overload taking `values` sorts `keys` and moves each element of `values` along with its key, which `values` must have as many elements as `keys` for. It is stable, so equal keys keep the order of their values.
+
+	 All overloads need a temporary buffer the size of the input. The parallel overloads of numbers split every pass into one part per thread, each counting bytes into its own histogram and moving its elements to positions derived from all histograms. Strings are always sorted on the calling thread.
+
+	 ~~~cpp
+	 std::vector<std::uint64_t> keys = ...;
+	 std::vector<std::uint32_t> rows = ...;
+	 xtd::radix_sort(xtd::execution::par, keys, rows);
+	 ~~~
+	 */
+	//@{
+	template<class Range>
+	void radix_sort(Range&& range);
+	template<class Range>
+	void radix_sort(const execution::parallel_policy& policy, Range&& range);
+	template<class KeyRange, class ValueRange, class = detail::algorithm::contiguous_value_t<std::remove_reference_t<KeyRange>>>
+	void radix_sort(KeyRange&& keys, ValueRange&& values);
+	template<class KeyRange, class ValueRange>
+	void radix_sort(const execution::parallel_policy& policy, KeyRange&& keys, ValueRange&& values);
+	//@}
+
+	/**
+	 Sort a contiguous range with `comp` on multiple threads, using `execution::par` if no policy is given.
+
+	 This is a sample sort: splitters taken from a sorted random sample of the range divide it into several buckets per thread. Every thread moves its part of the range to the buckets, after which the threads sort one bucket at a time with `std::sort` until none are left. Values occurring repeatedly in the sample get a bucket of their own which needs no sorting, so many equal elements do not leave all work to one thread. Like `std::sort` it is not stable.
+
+	 Needs a temporary buffer the size of the range plus two bytes per element. Small ranges, a single thread and element types whose move constructor may throw are sorted with `std::sort` directly. If `comp` throws the exception is rethrown after all threads have finished, leaving the range in an unspecified state.
+
+	 ~~~cpp
+	 std::vector<record> records = ...;
+	 xtd::parallel_sort(records, [] (const record& a, const record& b) { return a.time < b.time; });
+	 ~~~
+	 */
+	template<class Range, class Compare = std::less<>, class = detail::algorithm::contiguous_value_t<std::remove_reference_t<Range>>>
+	void parallel_sort(Range&& range, Compare comp = {});
+	/// \copydoc parallel_sort
+	template<class Range, class Compare = std::less<>>
+	void parallel_sort(const execution::parallel_policy& policy, Range&& range, Compare comp = {});
+
+	/**
+	 Find the first element of the sorted contiguous `range` not ordered before `value` by `comp`, or the end of the range, like `std::lower_bound`.
+
+	 The search range is halved with a conditional move instead of a branch, so the loop always runs `log2(size)` iterations without mispredictions, and both possible next middle elements are prefetched. This is faster than `std::lower_bound` for arrays which fit in cache and for unpredictable queries. For large arrays searched many times `eytzinger_index` and `static_btree` in <xtd/static_search.hpp> avoid most cache misses.
+	 */
+	template<class Range, class T, class Compare = std::less<>>
+	auto branchless_lower_bound(const Range& range, const T& value, Compare comp = {}) -> decltype(range.data());
+
+	/// \name Sorted sets
+	/**
+	 Set operations on contiguous ranges sorted ascending without duplicates, such as posting lists.
+
+	 `set_intersection_count` returns the size of the intersection of `a` and `b`. `intersect` writes the intersection to `out`, which must have room for the smaller of both. `merge_union` writes the union to `out`, which must have room for both. `difference` writes the elements of `a` not in `b` to `out`, which must have room for `a`. They return the number of elements written, in ascending order.
+
+	 For 32 bit integers blocks of four elements of each range are compared all against all in SIMD registers, advancing the block with the smaller last element. Other types use a merge without unpredictable branches. If one range is much smaller than the other, each of its elements is instead located in the larger one by galloping: probing 1, 2, 4, ... elements ahead of the previous position and then searching the last step binary, so the cost depends mostly on the smaller range.
+
+	 ~~~cpp
+	 std::vector<std::uint32_t> hits(std::min(docs_a.size(), docs_b.size()));
+	 hits.resize(xtd::intersect(docs_a, docs_b, hits));
+	 ~~~
+	 */
+	//@{
+	template<class Range1, class Range2>
+	std::size_t set_intersection_count(const Range1& a, const Range2& b) noexcept;
+	template<class Range1, class Range2, class OutRange>
+	std::size_t intersect(const Range1& a, const Range2& b, OutRange&& out) noexcept;
+	template<class Range1, class Range2, class OutRange>
+	std::size_t merge_union(const Range1& a, const Range2& b, OutRange&& out) noexcept;
+	template<class Range1, class Range2, class OutRange>
+	std::size_t difference(const Range1& a, const Range2& b, OutRange&& out) noexcept;
+	//@}
+}
+
+////////////////////////////////////////////////////////////////////////
+// Private parts, do not look.
+//
+
+#if defined(__GNUC__) || defined(__clang__)
+#define XTD_ALGORITHM_VECTOR_EXTENSIONS 1
+#endif
+
+namespace xtd
+{
+	namespace detail
+	{
+		namespace algorithm
+		{
+			template<class T>
+			constexpr std::enable_if_t<std::is_floating_point<T>::value, bool> is_nan(const T& x) noexcept { return x != x; }
+			template<class T>
+			constexpr std::enable_if_t<!std::is_floating_point<T>::value, bool> is_nan(const T&) noexcept { return false; }
+
+			// std::swap is not constexpr before C++20
+			template<class T>
+			constexpr void constexpr_swap(T& a, T& b)
+			{
+				auto t = std::move(a);
+				a = std::move(b);
+				b = std::move(t);
+			}
+
+			template<class RandomIt, class Compare>
+			constexpr void sift_down(RandomIt first, std::ptrdiff_t i, std::ptrdiff_t n, Compare& comp)
+			{
+				for(;;)
+				{
+					auto child = 2 * i + 1;
+					if(child >= n)
+						return;
+					if(child + 1 < n && comp(first[child], first[child + 1]))
+						++child;
+					if(!comp(first[i], first[child]))
+						return;
+					constexpr_swap(first[i], first[child]);
+					i = child;
+				}
+			}
+
+			// Unlike std::array a plain array member can be modified in constant expressions
+			template<class T, std::size_t N>
+			struct ConstexprArray
+			{
+				T data[N > 0 ? N : 1];
+			};
+
+			template<class T, std::size_t N, std::size_t... I>
+			constexpr ConstexprArray<T, N> to_constexpr_array(const std::array<T, N>& array, std::index_sequence<I...>)
+			{
+				return {{ array[I]... }};
+			}
+			template<class T, std::size_t N, std::size_t... I>
+			constexpr std::array<T, N> to_std_array(const ConstexprArray<T, N>& array, std::index_sequence<I...>)
+			{
+				return {{ array.data[I]... }};
+			}
+			template<class F, std::size_t... I>
+			constexpr auto generate_array(F& f, std::index_sequence<I...>) -> std::array<decltype(f(std::size_t{})), sizeof...(I)>
+			{
+				return {{ f(I)... }};
+			}
+
+			template<class T>
+			struct Extremes
+			{
+				T min;
+				T max;
+				bool nan;
+			};
+
+			// The smallest and/or largest element of a non-empty range starting with a non-NaN element, and whether it contains NaN
+			template<bool Min, bool Max, class T>
+			Extremes<T> extremes_scalar(const T* p, std::size_t n, Extremes<T> e) noexcept
+			{
+				for(std::size_t i = 0; i < n; ++i)
+				{
+					if(Min && p[i] < e.min)
+						e.min = p[i];
+					if(Max && e.max < p[i])
+						e.max = p[i];
+					e.nan |= is_nan(p[i]);
+				}
+				return e;
+			}
+
+			// The first i with p[i] equal to value, or NaN if Nan is set
+			template<bool Nan, class T>
+			std::size_t find_scalar(const T* p, std::size_t n, const T& value) noexcept
+			{
+				for(std::size_t i = 0; i < n; ++i)
+					if(Nan ? is_nan(p[i]) : p[i] == value)
+						return i;
+				return n;
+			}
+
+#if defined(XTD_ALGORITHM_VECTOR_EXTENSIONS)
+
+			template<class T>
+			struct IsVectorizable : std::integral_constant<bool, std::is_arithmetic<T>::value && !std::is_same<T, bool>::value && !std::is_same<T, long double>::value> { };
+
+#if defined(__AVX__)
+			constexpr std::size_t vector_size = 32;
+#else
+			constexpr std::size_t vector_size = 16; // SSE2 and NEON
+#endif
+
+			// Whether any lane of a comparison result is set
+			template<class M>
+			bool any(const M& mask) noexcept
+			{
+				std::uint64_t words[sizeof(M) / 8];
+				std::memcpy(words, &mask, sizeof(M));
+				std::uint64_t x = 0;
+				for(auto w : words)
+					x |= w;
+				return x != 0;
+			}
+
+			// Four independent accumulators for each extreme; comparing with the accumulator as second operand skips NaN
+			template<bool Min, bool Max, class T>
+			Extremes<T> extremes(const T* p, std::size_t n, std::true_type /* vectorizable */) noexcept
+			{
+				typedef T V __attribute__((vector_size(vector_size)));
+				using M = decltype(V{} != V{});
+				constexpr std::size_t lanes = sizeof(V) / sizeof(T);
+				constexpr std::size_t block = 4 * lanes;
+				Extremes<T> e{p[0], p[0], false};
+				if(n < 2 * block)
+					return extremes_scalar<Min, Max>(p, n, e);
+
+				V seed;
+				for(std::size_t k = 0; k < lanes; ++k)
+					seed[k] = p[0];
+				V lo0 = seed, lo1 = seed, lo2 = seed, lo3 = seed;
+				V hi0 = seed, hi1 = seed, hi2 = seed, hi3 = seed;
+				M nan = {};
+				V x0, x1, x2, x3;
+				std::size_t i = 0;
+				for(const auto end = n - n % block; i < end; i += block)
+				{
+					std::memcpy(&x0, p + i, sizeof(V));
+					std::memcpy(&x1, p + i + lanes, sizeof(V));
+					std::memcpy(&x2, p + i + 2 * lanes, sizeof(V));
+					std::memcpy(&x3, p + i + 3 * lanes, sizeof(V));
+					if(Min)
+					{
+						lo0 = x0 < lo0 ? x0 : lo0;
+						lo1 = x1 < lo1 ? x1 : lo1;
+						lo2 = x2 < lo2 ? x2 : lo2;
+						lo3 = x3 < lo3 ? x3 : lo3;
+					}
+					if(Max)
+					{
+						hi0 = hi0 < x0 ? x0 : hi0;
+						hi1 = hi1 < x1 ? x1 : hi1;
+						hi2 = hi2 < x2 ? x2 : hi2;
+						hi3 = hi3 < x3 ? x3 : hi3;
+					}
+					if(std::is_floating_point<T>::value)
+						nan |= (x0 != x0) | (x1 != x1) | (x2 != x2) | (x3 != x3);
+				}
+				lo0 = lo1 < lo0 ? lo1 : lo0;
+				lo2 = lo3 < lo2 ? lo3 : lo2;
+				lo0 = lo2 < lo0 ? lo2 : lo0;
+				hi0 = hi0 < hi1 ? hi1 : hi0;
+				hi2 = hi2 < hi3 ? hi3 : hi2;
+				hi0 = hi0 < hi2 ? hi2 : hi0;
+				for(std::size_t k = 0; k < lanes; ++k)
+				{
+					if(lo0[k] < e.min)
+						e.min = lo0[k];
+					if(e.max < hi0[k])
+						e.max = hi0[k];
+				}
+				e.nan = any(nan);
+				return extremes_scalar<Min, Max>(p + i, n - i, e);
+			}
+
+			template<bool Nan, class T>
+			std::size_t find(const T* p, std::size_t n, const T& value, std::true_type /* vectorizable */) noexcept
+			{
+				typedef T V __attribute__((vector_size(vector_size)));
+				constexpr std::size_t lanes = sizeof(V) / sizeof(T);
+				constexpr std::size_t block = 4 * lanes;
+				V v;
+				for(std::size_t k = 0; k < lanes; ++k)
+					v[k] = value;
+				V x0, x1, x2, x3;
+				std::size_t i = 0;
+				for(const auto end = n - n % block; i < end; i += block)
+				{
+					std::memcpy(&x0, p + i, sizeof(V));
+					std::memcpy(&x1, p + i + lanes, sizeof(V));
+					std::memcpy(&x2, p + i + 2 * lanes, sizeof(V));
+					std::memcpy(&x3, p + i + 3 * lanes, sizeof(V));
+					if(Nan ? any((x0 != x0) | (x1 != x1) | (x2 != x2) | (x3 != x3)) : any((x0 == v) | (x1 == v) | (x2 == v) | (x3 == v)))
+						break;
+				}
+				// Locate the match within the block
+				return i + find_scalar<Nan>(p + i, n - i, value);
+			}
+
+#endif // XTD_ALGORITHM_VECTOR_EXTENSIONS
+
+			template<bool Min, bool Max, class T>
+			Extremes<T> extremes(const T* p, std::size_t n, std::false_type /* vectorizable */) noexcept
+			{
+				return extremes_scalar<Min, Max>(p + 1, n - 1, Extremes<T>{p[0], p[0], false});
+			}
+
+			template<bool Nan, class T>
+			std::size_t find(const T* p, std::size_t n, const T& value, std::false_type /* vectorizable */) noexcept
+			{
+				return find_scalar<Nan>(p, n, value);
+			}
+
+#if defined(XTD_ALGORITHM_VECTOR_EXTENSIONS)
+			template<class T>
+			using vectorizable = IsVectorizable<T>;
+#else
+			template<class T>
+			using vectorizable = std::false_type;
+#endif
+
+			// Skip leading NaN elements, whose position is the result if there are only NaN elements or they propagate
+			template<class T>
+			std::size_t skip_nan(const T* p, std::size_t n, nan_policy nans, bool& done) noexcept
+			{
+				std::size_t start = 0;
+				while(start < n && is_nan(p[start]))
+					++start;
+				done = start > 0 && (start == n || nans == nan_policy::propagate);
+				return start;
+			}
+
+			template<bool Max, class T>
+			std::size_t arg_extreme(const T* p, std::size_t n, nan_policy nans) noexcept
+			{
+				if(n == 0)
+					return 0;
+				bool done;
+				auto start = skip_nan(p, n, nans, done);
+				if(done)
+					return 0;
+				p += start;
+				n -= start;
+				auto e = extremes<!Max, Max>(p, n, vectorizable<T>{});
+				if(e.nan && nans == nan_policy::propagate)
+					return start + find<true>(p, n, e.min, vectorizable<T>{});
+				return start + find<false>(p, n, Max ? e.max : e.min, vectorizable<T>{});
+			}
+
+			////////////////////////////////////////////////////////////////////////
+			// Radix sort
+
+			// Maps keys to unsigned integers of the same order
+			template<class T, class = void>
+			struct RadixKey : std::false_type { };
+			template<class T>
+			struct RadixKey<T, std::enable_if_t<std::is_integral<T>::value && !std::is_same<T, bool>::value>> : std::true_type
+			{
+				using type = std::make_unsigned_t<T>;
+				static type bits(T x) noexcept
+				{
+					return std::is_signed<T>::value ? static_cast<type>(static_cast<type>(x) ^ (type(1) << (8 * sizeof(T) - 1))) : static_cast<type>(x);
+				}
+			};
+			template<class T, class U>
+			struct FloatRadixKey : std::true_type
+			{
+				using type = U;
+				static U bits(T x) noexcept
+				{
+					U u;
+					std::memcpy(&u, &x, sizeof(U));
+					// Negative: flip all bits to reverse their order, positive: set the sign bit
+					auto sign = static_cast<U>(u >> (8 * sizeof(U) - 1));
+					return u ^ (static_cast<U>(-sign) | (U(1) << (8 * sizeof(U) - 1)));
+				}
+			};
+			template<>
+			struct RadixKey<float> : FloatRadixKey<float, std::uint32_t> { };
+			template<>
+			struct RadixKey<double> : FloatRadixKey<double, std::uint64_t> { };
+
+			// Below this size sorting numbers by comparison is faster
+			constexpr std::size_t radix_sort_threshold = 256;
+			// Minimum number of elements per thread
+			constexpr std::size_t radix_sort_grain = 1 << 16;
+
+			using RadixHistogram = std::array<std::size_t, 256>;
+
+			template<class T>
+			unsigned radix_digit(const T& x, unsigned shift) noexcept
+			{
+				return static_cast<unsigned>(RadixKey<T>::bits(x) >> shift) & 0xFF;
+			}
+
+			// Whether all elements have the same digit
+			inline bool radix_trivial(const RadixHistogram& counts, std::size_t n) noexcept
+			{
+				return std::find(counts.begin(), counts.end(), n) != counts.end();
+			}
+
+			// Turn counts into start positions, continuing at base
+			inline std::size_t radix_offsets(RadixHistogram& counts, std::size_t base) noexcept
+			{
+				for(auto& c : counts)
+				{
+					auto x = c;
+					c = base;
+					base += x;
+				}
+				return base;
+			}
+
+			template<bool HasValues, class T, class V>
+			void radix_scatter(const T* keys, T* keys_out, V* values, V* values_out, std::size_t first, std::size_t last, unsigned shift, RadixHistogram& offsets)
+			{
+				for(auto i = first; i < last; ++i)
+				{
+					auto o = offsets[radix_digit(keys[i], shift)]++;
+					keys_out[o] = keys[i];
+					if(HasValues)
+						values_out[o] = std::move(values[i]);
+				}
+			}
+
+			// Ping-pong buffers for the keys and optionally values
+			template<bool HasValues, class T, class V>
+			struct RadixBuffers
+			{
+				RadixBuffers(T* keys, V* values, std::size_t n)
+				: key_buffer{new T[n]}
+				, value_buffer{HasValues ? new V[n] : nullptr}
+				, keys{keys}, keys_out{key_buffer.get()}
+				, values{values}, values_out{value_buffer.get()}
+				{ }
+
+				void swap() noexcept
+				{
+					std::swap(keys, keys_out);
+					std::swap(values, values_out);
+				}
+				// Whether the sorted elements are in the temporary buffers
+				bool swapped() const noexcept { return keys == key_buffer.get(); }
+
+				std::unique_ptr<T[]> key_buffer;
+				std::unique_ptr<V[]> value_buffer;
+				T* keys;
+				T* keys_out;
+				V* values;
+				V* values_out;
+			};
+
+			template<bool HasValues, class T, class V>
+			void lsd_sort(T* keys, V* values, std::size_t n)
+			{
+				if(!HasValues && n < radix_sort_threshold)
+				{
+					std::sort(keys, keys + n, [] (const T& a, const T& b) { return RadixKey<T>::bits(a) < RadixKey<T>::bits(b); });
+					return;
+				}
+				// Count all digits in one pass
+				RadixHistogram counts[sizeof(T)] = {};
+				for(std::size_t i = 0; i < n; ++i)
+				{
+					auto bits = RadixKey<T>::bits(keys[i]);
+					for(unsigned d = 0; d < sizeof(T); ++d)
+						++counts[d][static_cast<unsigned>(bits >> (8 * d)) & 0xFF];
+				}
+				RadixBuffers<HasValues, T, V> b{keys, values, n};
+				for(unsigned d = 0; d < sizeof(T); ++d)
+				{
+					if(radix_trivial(counts[d], n))
+						continue;
+					radix_offsets(counts[d], 0);
+					radix_scatter<HasValues>(b.keys, b.keys_out, b.values, b.values_out, 0, n, 8 * d, counts[d]);
+					b.swap();
+				}
+				if(b.swapped())
+				{
+					std::copy(b.keys, b.keys + n, keys);
+					if(HasValues)
+						std::move(b.values, b.values + n, values);
+				}
+			}
+
+			template<bool HasValues, class T, class V>
+			void lsd_sort(const xtd::execution::parallel_policy& policy, T* keys, V* values, std::size_t n)
+			{
+				if(n < 2 * radix_sort_grain || policy.concurrency() == 1)
+					return lsd_sort<HasValues>(keys, values, n);
+				std::vector<RadixHistogram> counts(std::min<std::size_t>(policy.concurrency(), n / radix_sort_grain + 1));
+				RadixBuffers<HasValues, T, V> b{keys, values, n};
+				for(unsigned d = 0; d < sizeof(T); ++d)
+				{
+					// Counting and scattering split the range into the same chunks
+					auto chunks = detail::execution::parallel_for(policy, n, radix_sort_grain, [&] (std::size_t chunk, std::size_t first, std::size_t last)
+					{
+						auto& c = counts[chunk];
+						c.fill(0);
+						for(auto i = first; i < last; ++i)
+							++c[radix_digit(b.keys[i], 8 * d)];
+					});
+					RadixHistogram total = {};
+					for(std::size_t chunk = 0; chunk < chunks; ++chunk)
+						for(unsigned digit = 0; digit < 256; ++digit)
+							total[digit] += counts[chunk][digit];
+					if(radix_trivial(total, n))
+						continue;
+					// Each chunk writes its elements of a digit after those of the chunks before it
+					std::size_t base = 0;
+					for(unsigned digit = 0; digit < 256; ++digit)
+						for(std::size_t chunk = 0; chunk < chunks; ++chunk)
+						{
+							auto x = counts[chunk][digit];
+							counts[chunk][digit] = base;
+							base += x;
+						}
+					detail::execution::parallel_for(policy, n, radix_sort_grain, [&] (std::size_t chunk, std::size_t first, std::size_t last)
+					{
+						radix_scatter<HasValues>(b.keys, b.keys_out, b.values, b.values_out, first, last, 8 * d, counts[chunk]);
+					});
+					b.swap();
+				}
+				if(b.swapped())
+				{
+					detail::execution::parallel_for(policy, n, radix_sort_grain, [&] (std::size_t, std::size_t first, std::size_t last)
+					{
+						std::copy(b.keys + first, b.keys + last, keys + first);
+						if(HasValues)
+							std::move(b.values + first, b.values + last, values + first);
+					});
+				}
+			}
+
+			// Below this size partitions of strings are sorted by comparison
+			constexpr std::size_t msd_sort_threshold = 32;
+
+			// Sort strings which are equal up to depth
+			inline void msd_sort(xtd::string_view* p, std::size_t n)
+			{
+				if(n < 2)
+					return;
+				struct Partition
+				{
+					std::size_t first;
+					std::size_t size;
+					std::size_t depth;
+				};
+				// Bucket 0 holds the strings ending at depth
+				auto digit = [] (xtd::string_view s, std::size_t depth) -> unsigned
+				{
+					return depth < s.size() ? 1u + static_cast<unsigned char>(s[depth]) : 0u;
+				};
+				std::unique_ptr<xtd::string_view[]> buffer{new xtd::string_view[n]};
+				std::vector<Partition> stack{{0, n, 0}};
+				while(!stack.empty())
+				{
+					auto part = stack.back();
+					stack.pop_back();
+					auto s = p + part.first;
+					if(part.size < msd_sort_threshold)
+					{
+						std::sort(s, s + part.size, [depth = part.depth] (xtd::string_view a, xtd::string_view b)
+						{
+							auto n = std::min(a.size(), b.size()) - depth;
+							auto cmp = n ? std::memcmp(a.data() + depth, b.data() + depth, n) : 0;
+							return cmp != 0 ? cmp < 0 : a.size() < b.size();
+						});
+						continue;
+					}
+					std::array<std::size_t, 257> counts = {};
+					for(std::size_t i = 0; i < part.size; ++i)
+						++counts[digit(s[i], part.depth)];
+					if(counts[0] == part.size)
+						continue; // All equal
+					if(std::find(counts.begin() + 1, counts.end(), part.size) != counts.end())
+					{
+						// Common prefix, no need to move anything
+						stack.push_back({part.first, part.size, part.depth + 1});
+						continue;
+					}
+					std::array<std::size_t, 257> offsets;
+					std::size_t base = 0;
+					for(unsigned d = 0; d < 257; ++d)
+					{
+						offsets[d] = base;
+						base += counts[d];
+					}
+					auto out = buffer.get() + part.first;
+					for(std::size_t i = 0; i < part.size; ++i)
+						out[offsets[digit(s[i], part.depth)]++] = s[i];
+					std::copy(out, out + part.size, s);
+					auto first = part.first + counts[0];
+					for(unsigned d = 1; d < 257; first += counts[d++])
+						if(counts[d] > 1)
+							stack.push_back({first, counts[d], part.depth + 1});
+				}
+			}
+
+			template<class T>
+			void radix_sort_keys(T* p, std::size_t n)
+			{
+				static_assert(RadixKey<T>::value, "xtd::radix_sort: Only integers, float, double and string_view are supported.");
+				lsd_sort<false>(p, static_cast<char*>(nullptr), n);
+			}
+			template<class T>
+			void radix_sort_keys(const xtd::execution::parallel_policy& policy, T* p, std::size_t n)
+			{
+				static_assert(RadixKey<T>::value, "xtd::radix_sort: Only integers, float, double and string_view are supported.");
+				lsd_sort<false>(policy, p, static_cast<char*>(nullptr), n);
+			}
+			inline void radix_sort_keys(xtd::string_view* p, std::size_t n)
+			{
+				msd_sort(p, n);
+			}
+			inline void radix_sort_keys(const xtd::execution::parallel_policy&, xtd::string_view* p, std::size_t n)
+			{
+				msd_sort(p, n);
+			}
+
+			////////////////////////////////////////////////////////////////////////
+			// Sorted sets
+
+			// Galloping is used if one range is this many times larger than the other
+			constexpr std::size_t gallop_ratio = 32;
+
+			// The first position at or after first of an element not less than x, probing 1, 2, 4, ... elements ahead
+			template<class T>
+			std::size_t gallop(const T* p, std::size_t first, std::size_t n, const T& x) noexcept
+			{
+				auto lo = first;
+				auto hi = first;
+				for(std::size_t step = 1; hi < n && p[hi] < x; step *= 2)
+				{
+					lo = hi + 1;
+					hi += step;
+				}
+				return static_cast<std::size_t>(std::lower_bound(p + lo, p + std::min(hi, n), x) - p);
+			}
+
+			// Write the matches of small in large, or count them if out is null
+			template<class T>
+			std::size_t intersect_gallop(const T* small, std::size_t ns, const T* large, std::size_t nl, T* out) noexcept
+			{
+				std::size_t k = 0;
+				for(std::size_t i = 0, j = 0; i < ns; ++i)
+				{
+					j = gallop(large, j, nl, small[i]);
+					if(j == nl)
+						break;
+					if(!(small[i] < large[j]))
+					{
+						if(out)
+							out[k] = small[i];
+						++k;
+						++j;
+					}
+				}
+				return k;
+			}
+
+			// Writes x at out[k] unconditionally, which is in bounds because k is at most the smaller of i and j
+			template<class T>
+			std::size_t intersect_scalar(const T* a, std::size_t i, std::size_t na, const T* b, std::size_t j, std::size_t nb, T* out) noexcept
+			{
+				std::size_t k = 0;
+				while(i < na && j < nb)
+				{
+					auto x = a[i];
+					auto y = b[j];
+					if(out)
+						out[k] = x;
+					k += !(x < y) && !(y < x);
+					i += !(y < x);
+					j += !(x < y);
+				}
+				return k;
+			}
+
+#if defined(XTD_ALGORITHM_SSE2)
+
+			// Blocks of four 32 bit integers compared against all rotations of the other block
+			inline unsigned block_matches(const void* a, const void* b) noexcept
+			{
+				auto va = _mm_loadu_si128(static_cast<const __m128i*>(a));
+				auto vb = _mm_loadu_si128(static_cast<const __m128i*>(b));
+				auto m0 = _mm_or_si128(_mm_cmpeq_epi32(va, vb), _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, 0x39)));
+				auto m1 = _mm_or_si128(_mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, 0x4E)), _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, 0x93)));
+				return static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_or_si128(m0, m1))));
+			}
+
+			template<class T>
+			using IsBlockComparable = std::integral_constant<bool, std::is_integral<T>::value && sizeof(T) == 4>;
+
+			template<class T>
+			std::size_t intersect(const T* a, std::size_t na, const T* b, std::size_t nb, T* out, std::true_type /* block comparable */) noexcept
+			{
+				std::size_t i = 0, j = 0, k = 0;
+				while(i + 4 <= na && j + 4 <= nb)
+				{
+					auto mask = block_matches(a + i, b + j);
+					if(out)
+						for(; mask; mask &= mask - 1)
+							out[k++] = a[i + static_cast<unsigned>(__builtin_ctz(mask))];
+					else
+						k += static_cast<unsigned>(__builtin_popcount(mask));
+					auto a_last = a[i + 3];
+					auto b_last = b[j + 3];
+					i += a_last <= b_last ? 4 : 0;
+					j += b_last <= a_last ? 4 : 0;
+				}
+				return k + intersect_scalar(a, i, na, b, j, nb, out ? out + k : out);
+			}
+
+#endif // XTD_ALGORITHM_SSE2
+
+			template<class T>
+			std::size_t intersect(const T* a, std::size_t na, const T* b, std::size_t nb, T* out, std::false_type /* block comparable */) noexcept
+			{
+				return intersect_scalar(a, 0, na, b, 0, nb, out);
+			}
+
+#if defined(XTD_ALGORITHM_SSE2)
+			template<class T>
+			using block_comparable = IsBlockComparable<T>;
+#else
+			template<class T>
+			using block_comparable = std::false_type;
+#endif
+
+			template<class T>
+			std::size_t intersect(const T* a, std::size_t na, const T* b, std::size_t nb, T* out) noexcept
+			{
+				if(na > nb)
+				{
+					std::swap(a, b);
+					std::swap(na, nb);
+				}
+				if(na * gallop_ratio < nb)
+					return intersect_gallop(a, na, b, nb, out);
+				return intersect(a, na, b, nb, out, block_comparable<T>{});
+			}
+
+			// The elements of a from position i on which are not in b, skipping the first ones flagged in found
+			template<class T>
+			std::size_t difference_scalar(const T* a, std::size_t i, std::size_t na, const T* b, std::size_t j, std::size_t nb, T* out, unsigned found) noexcept
+			{
+				std::size_t k = 0;
+				for(; found && i < na; ++i, found >>= 1)
+				{
+					if(found & 1)
+						continue;
+					while(j < nb && b[j] < a[i])
+						++j;
+					if(j == nb || a[i] < b[j])
+						out[k++] = a[i];
+				}
+				// Writes x at out[k] unconditionally, which is in bounds because k is at most i
+				while(i < na && j < nb)
+				{
+					auto x = a[i];
+					auto y = b[j];
+					out[k] = x;
+					k += x < y;
+					i += !(y < x);
+					j += !(x < y);
+				}
+				return static_cast<std::size_t>(std::copy(a + i, a + na, out + k) - out);
+			}
+
+#if defined(XTD_ALGORITHM_SSE2)
+
+			// Matches are collected until a block of a is done, as they may be in several blocks of b
+			template<class T>
+			std::size_t difference(const T* a, std::size_t na, const T* b, std::size_t nb, T* out, std::true_type /* block comparable */) noexcept
+			{
+				std::size_t i = 0, j = 0, k = 0;
+				unsigned found = 0;
+				while(i + 4 <= na && j + 4 <= nb)
+				{
+					found |= block_matches(a + i, b + j);
+					auto a_last = a[i + 3];
+					auto b_last = b[j + 3];
+					if(a_last <= b_last)
+					{
+						for(auto missing = ~found & 0xF; missing; missing &= missing - 1)
+							out[k++] = a[i + static_cast<unsigned>(__builtin_ctz(missing))];
+						found = 0;
+						i += 4;
+					}
+					j += b_last <= a_last ? 4 : 0;
+				}
+				return k + difference_scalar(a, i, na, b, j, nb, out + k, found);
+			}
+
+#endif // XTD_ALGORITHM_SSE2
+
+			template<class T>
+			std::size_t difference(const T* a, std::size_t na, const T* b, std::size_t nb, T* out, std::false_type /* block comparable */) noexcept
+			{
+				return difference_scalar(a, 0, na, b, 0, nb, out, 0);
+			}
+
+			template<class T>
+			std::size_t difference(const T* a, std::size_t na, const T* b, std::size_t nb, T* out) noexcept
+			{
+				if(na * gallop_ratio < nb)
+				{
+					std::size_t k = 0;
+					for(std::size_t i = 0, j = 0; i < na; ++i)
+					{
+						j = gallop(b, j, nb, a[i]);
+						if(j == nb || a[i] < b[j])
+							out[k++] = a[i];
+					}
+					return k;
+				}
+				if(nb * gallop_ratio < na)
+				{
+					// Copy the runs of a between elements of b
+					std::size_t i = 0, k = 0;
+					for(std::size_t j = 0; j < nb && i < na; ++j)
+					{
+						auto next = gallop(a, i, na, b[j]);
+						k = static_cast<std::size_t>(std::copy(a + i, a + next, out + k) - out);
+						i = next < na && !(b[j] < a[next]) ? next + 1 : next;
+					}
+					return static_cast<std::size_t>(std::copy(a + i, a + na, out + k) - out);
+				}
+				return difference(a, na, b, nb, out, block_comparable<T>{});
+			}
+
+			template<class T>
+			std::size_t merge_union(const T* a, std::size_t na, const T* b, std::size_t nb, T* out) noexcept
+			{
+				if(na > nb)
+				{
+					std::swap(a, b);
+					std::swap(na, nb);
+				}
+				std::size_t i = 0, j = 0, k = 0;
+				if(na * gallop_ratio < nb)
+				{
+					// Copy the runs of b between elements of a
+					for(; i < na; ++i)
+					{
+						auto next = gallop(b, j, nb, a[i]);
+						k = static_cast<std::size_t>(std::copy(b + j, b + next, out + k) - out);
+						j = next < nb && !(a[i] < b[next]) ? next + 1 : next;
+						out[k++] = a[i];
+					}
+				}
+				else
+				{
+					while(i < na && j < nb)
+					{
+						auto x = a[i];
+						auto y = b[j];
+						out[k++] = y < x ? y : x;
+						i += !(y < x);
+						j += !(x < y);
+					}
+				}
+				k = static_cast<std::size_t>(std::copy(a + i, a + na, out + k) - out);
+				return static_cast<std::size_t>(std::copy(b + j, b + nb, out + k) - out);
+			}
+
+			////////////////////////////////////////////////////////////////////////
+			// Parallel sort
+
+			// Minimum number of elements per thread
+			constexpr std::size_t sort_grain = 1 << 14;
+			// Sample elements per bucket
+			constexpr std::size_t sort_oversampling = 16;
+			// Bucket ids are stored in 16 bits
+			constexpr std::size_t sort_max_splitters = (1 << 15) - 1;
+
+			// Uninitialized storage destroying its elements once all are constructed
+			template<class T>
+			class SortBuffer
+			{
+			public:
+				explicit SortBuffer(std::size_t n) : _p{std::allocator<T>{}.allocate(n)}, _n{n} { }
+				SortBuffer(const SortBuffer&) = delete;
+				SortBuffer& operator=(const SortBuffer&) = delete;
+				~SortBuffer()
+				{
+					if(_constructed)
+						for(std::size_t i = 0; i < _n; ++i)
+							_p[i].~T();
+					std::allocator<T>{}.deallocate(_p, _n);
+				}
+
+				T* data() const noexcept { return _p; }
+				void constructed() noexcept { _constructed = true; }
+
+			private:
+				T* _p;
+				std::size_t _n;
+				bool _constructed = false;
+			};
+
+			template<class T, class Compare>
+			void parallel_sort(const xtd::execution::parallel_policy& policy, T* p, std::size_t n, Compare& comp)
+			{
+				const std::size_t threads = policy.concurrency();
+				if(n < 2 * sort_grain || threads == 1 || !std::is_nothrow_move_constructible<T>::value)
+					return std::sort(p, p + n, comp);
+
+				// Splitters are every sort_oversampling'th element of a sorted sample, without duplicates
+				const auto buckets = std::min(std::min(4 * threads, n / sort_grain), sort_max_splitters);
+				std::vector<const T*> sample(buckets * sort_oversampling);
+				std::minstd_rand rng{static_cast<std::minstd_rand::result_type>(n)};
+				std::uniform_int_distribution<std::size_t> index{0, n - 1};
+				for(auto& x : sample)
+					x = p + index(rng);
+				std::sort(sample.begin(), sample.end(), [&] (const T* a, const T* b) { return comp(*a, *b); });
+				std::vector<const T*> splitters;
+				for(auto i = sort_oversampling; i < sample.size(); i += sort_oversampling)
+					if(splitters.empty() || comp(*splitters.back(), *sample[i]))
+						splitters.push_back(sample[i]);
+
+				// Bucket 2i holds the elements between splitters i - 1 and i, bucket 2i + 1 those equal to splitter i
+				const auto classes = 2 * splitters.size() + 1;
+				std::unique_ptr<std::uint16_t[]> ids{new std::uint16_t[n]};
+				std::vector<std::vector<std::size_t>> counts(std::min(threads, n / sort_grain + 1), std::vector<std::size_t>(classes));
+				auto chunks = detail::execution::parallel_for(policy, n, sort_grain, [&] (std::size_t chunk, std::size_t first, std::size_t last)
+				{
+					auto c = comp;
+					auto& count = counts[chunk];
+					for(auto i = first; i < last; ++i)
+					{
+						auto j = static_cast<std::size_t>(std::lower_bound(splitters.begin(), splitters.end(), &p[i], [&] (const T* a, const T* b) { return c(*a, *b); }) - splitters.begin());
+						auto id = 2 * j + (j < splitters.size() && !c(p[i], *splitters[j]));
+						ids[i] = static_cast<std::uint16_t>(id);
+						++count[id];
+					}
+				});
+
+				// Each chunk moves its elements of a bucket after those of the chunks before it
+				std::vector<std::size_t> starts(classes + 1);
+				std::size_t base = 0;
+				for(std::size_t b = 0; b < classes; ++b)
+				{
+					starts[b] = base;
+					for(std::size_t chunk = 0; chunk < chunks; ++chunk)
+					{
+						auto x = counts[chunk][b];
+						counts[chunk][b] = base;
+						base += x;
+					}
+				}
+				starts[classes] = n;
+				SortBuffer<T> buffer{n};
+				detail::execution::parallel_for(policy, n, sort_grain, [&] (std::size_t chunk, std::size_t first, std::size_t last)
+				{
+					auto& offsets = counts[chunk];
+					for(auto i = first; i < last; ++i)
+						::new(static_cast<void*>(buffer.data() + offsets[ids[i]]++)) T(std::move(p[i]));
+				});
+				buffer.constructed();
+
+				// Threads take the next bucket when done, balancing buckets of different sizes
+				std::atomic<std::size_t> next{0};
+				detail::execution::parallel_for(policy, threads, 1, [&] (std::size_t, std::size_t, std::size_t)
+				{
+					auto c = comp;
+					for(std::size_t b; (b = next++) < classes;)
+					{
+						auto first = buffer.data() + starts[b];
+						auto last = buffer.data() + starts[b + 1];
+						if(b % 2 == 0)
+							std::sort(first, last, c);
+						std::move(first, last, p + starts[b]);
+					}
+				});
+			}
+		}
+	}
+}
+
+template<class Range>
+std::size_t xtd::argmin(const Range& range, nan_policy nans) noexcept
+{
+	return detail::algorithm::arg_extreme<false>(range.data(), range.size(), nans);
+}
+
+template<class Range>
+std::size_t xtd::argmax(const Range& range, nan_policy nans) noexcept
+{
+	return detail::algorithm::arg_extreme<true>(range.data(), range.size(), nans);
+}
+
+template<class Range>
+auto xtd::min_element(const Range& range, nan_policy nans) noexcept -> decltype(range.data())
+{
+	return range.data() + argmin(range, nans);
+}
+
+template<class Range>
+auto xtd::max_element(const Range& range, nan_policy nans) noexcept -> decltype(range.data())
+{
+	return range.data() + argmax(range, nans);
+}
+
+template<class Range>
+auto xtd::minmax(const Range& range, nan_policy nans) noexcept -> std::pair<detail::algorithm::contiguous_value_t<Range>, detail::algorithm::contiguous_value_t<Range>>
+{
+	using T = detail::algorithm::contiguous_value_t<Range>;
+	assert(range.size() > 0 && "xtd::minmax: The range must not be empty.");
+	auto p = range.data();
+	auto n = range.size();
+	bool done;
+	auto start = detail::algorithm::skip_nan(p, n, nans, done);
+	if(done)
+		return {p[0], p[0]};
+	auto e = detail::algorithm::extremes<true, true>(p + start, n - start, detail::algorithm::vectorizable<T>{});
+	if(e.nan && nans == nan_policy::propagate)
+		return {std::numeric_limits<T>::quiet_NaN(), std::numeric_limits<T>::quiet_NaN()};
+	return {e.min, e.max};
+}
+
+template<class Range>
+void xtd::radix_sort(Range&& range)
+{
+	detail::algorithm::radix_sort_keys(range.data(), range.size());
+}
+
+template<class Range>
+void xtd::radix_sort(const execution::parallel_policy& policy, Range&& range)
+{
+	detail::algorithm::radix_sort_keys(policy, range.data(), range.size());
+}
+
+template<class KeyRange, class ValueRange, class>
+void xtd::radix_sort(KeyRange&& keys, ValueRange&& values)
+{
+	using T = detail::algorithm::contiguous_value_t<std::remove_reference_t<KeyRange>>;
+	static_assert(detail::algorithm::RadixKey<T>::value, "xtd::radix_sort: Only integer, float and double keys are supported with values.");
+	assert(values.size() >= keys.size() && "xtd::radix_sort: Each key needs a value.");
+	detail::algorithm::lsd_sort<true>(keys.data(), values.data(), keys.size());
+}
+
+template<class KeyRange, class ValueRange>
+void xtd::radix_sort(const execution::parallel_policy& policy, KeyRange&& keys, ValueRange&& values)
+{
+	using T = detail::algorithm::contiguous_value_t<std::remove_reference_t<KeyRange>>;
+	static_assert(detail::algorithm::RadixKey<T>::value, "xtd::radix_sort: Only integer, float and double keys are supported with values.");
+	assert(values.size() >= keys.size() && "xtd::radix_sort: Each key needs a value.");
+	detail::algorithm::lsd_sort<true>(policy, keys.data(), values.data(), keys.size());
+}
+
+template<class Range, class T, class Compare>
+auto xtd::branchless_lower_bound(const Range& range, const T& value, Compare comp) -> decltype(range.data())
+{
+	auto base = range.data();
+	auto n = range.size();
+	if(n == 0)
+		return base;
+	while(n > 1)
+	{
+		auto half = n / 2;
+#if defined(__GNUC__) || defined(__clang__)
+		__builtin_prefetch(base + half / 2);
+		__builtin_prefetch(base + half + half / 2);
+#endif
+		base = comp(base[half], value) ? base + half : base;
+		n -= half;
+	}
+	return base + comp(*base, value);
+}
+
+template<class Range, class Compare, class>
+void xtd::parallel_sort(Range&& range, Compare comp)
+{
+	parallel_sort(execution::par, range, std::move(comp));
+}
+
+template<class Range, class Compare>
+void xtd::parallel_sort(const execution::parallel_policy& policy, Range&& range, Compare comp)
+{
+	detail::algorithm::parallel_sort(policy, range.data(), range.size(), comp);
+}
+
+template<class Range1, class Range2>
+std::size_t xtd::set_intersection_count(const Range1& a, const Range2& b) noexcept
+{
+	using T = detail::algorithm::contiguous_value_t<Range1>;
+	static_assert(std::is_same<T, detail::algorithm::contiguous_value_t<Range2>>::value, "xtd::set_intersection_count: Both ranges must have the same element type.");
+	return detail::algorithm::intersect(a.data(), a.size(), b.data(), b.size(), static_cast<T*>(nullptr));
+}
+
+template<class Range1, class Range2, class OutRange>
+std::size_t xtd::intersect(const Range1& a, const Range2& b, OutRange&& out) noexcept
+{
+	static_assert(std::is_same<detail::algorithm::contiguous_value_t<Range1>, detail::algorithm::contiguous_value_t<Range2>>::value, "xtd::intersect: Both ranges must have the same element type.");
+	assert(out.size() >= std::min(a.size(), b.size()) && "xtd::intersect: The output range is too small.");
+	return detail::algorithm::intersect(a.data(), a.size(), b.data(), b.size(), out.data());
+}
+
+template<class Range1, class Range2, class OutRange>
+std::size_t xtd::merge_union(const Range1& a, const Range2& b, OutRange&& out) noexcept
+{
+	static_assert(std::is_same<detail::algorithm::contiguous_value_t<Range1>, detail::algorithm::contiguous_value_t<Range2>>::value, "xtd::merge_union: Both ranges must have the same element type.");
+	assert(out.size() >= a.size() + b.size() && "xtd::merge_union: The output range is too small.");
+	return detail::algorithm::merge_union(a.data(), a.size(), b.data(), b.size(), out.data());
+}
+
+template<class Range1, class Range2, class OutRange>
+std::size_t xtd::difference(const Range1& a, const Range2& b, OutRange&& out) noexcept
+{
+	static_assert(std::is_same<detail::algorithm::contiguous_value_t<Range1>, detail::algorithm::contiguous_value_t<Range2>>::value, "xtd::difference: Both ranges must have the same element type.");
+	assert(out.size() >= a.size() && "xtd::difference: The output range is too small.");
+	return detail::algorithm::difference(a.data(), a.size(), b.data(), b.size(), out.data());
+}
+
+////////////////////////////////////////////////////////////////////////
+// Compile time sorting and searching
+//
+
+template<class RandomIt, class Compare>
+constexpr void xtd::constexpr_sort(RandomIt first, RandomIt last, Compare comp)
+{
+	auto n = last - first;
+	for(auto i = n / 2; i > 0; --i)
+		detail::algorithm::sift_down(first, i - 1, n, comp);
+	for(auto i = n - 1; i > 0; --i)
+	{
+		detail::algorithm::constexpr_swap(first[0], first[i]);
+		detail::algorithm::sift_down(first, 0, i, comp);
+	}
+}
+
+template<class RandomIt, class T, class Compare>
+constexpr RandomIt xtd::constexpr_lower_bound(RandomIt first, RandomIt last, const T& value, Compare comp)
+{
+	auto n = last - first;
+	while(n > 0)
+	{
+		auto half = n / 2;
+		if(comp(first[half], value))
+		{
+			first += half + 1;
+			n -= half + 1;
+		}
+		else
+			n = half;
+	}
+	return first;
+}
+
+template<class T, std::size_t N, class U, class Compare>
+constexpr std::size_t xtd::constexpr_lower_bound(const std::array<T, N>& array, const U& value, Compare comp)
+{
+	std::size_t first = 0;
+	auto n = N;
+	while(n > 0)
+	{
+		auto half = n / 2;
+		if(comp(array[first + half], value))
+		{
+			first += half + 1;
+			n -= half + 1;
+		}
+		else
+			n = half;
+	}
+	return first;
+}
+
+template<class ForwardIt, class BinaryPredicate>
+constexpr ForwardIt xtd::constexpr_unique(ForwardIt first, ForwardIt last, BinaryPredicate pred)
+{
+	if(first == last)
+		return last;
+	auto result = first;
+	while(++first != last)
+		if(!pred(*result, *first) && ++result != first)
+			*result = std::move(*first);
+	return ++result;
+}
+
+template<class T, std::size_t N, class Compare>
+constexpr std::array<T, N> xtd::sorted(const std::array<T, N>& array, Compare comp)
+{
+	auto copy = detail::algorithm::to_constexpr_array(array, std::make_index_sequence<N>{});
+	xtd::constexpr_sort(copy.data, copy.data + N, comp);
+	return detail::algorithm::to_std_array(copy, std::make_index_sequence<N>{});
+}
+
+template<std::size_t N, class F>
+constexpr auto xtd::generate_array(F f) -> std::array<decltype(f(std::size_t{})), N>
+{
+	return detail::algorithm::generate_array(f, std::make_index_sequence<N>{});
 }
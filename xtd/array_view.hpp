@@ -16,6 +16,7 @@
 #include <algorithm>
 #include <cassert>
 #include <iterator>
+#include <type_traits>
 
 namespace xtd
 {
@@ -79,6 +80,14 @@ public:
 	{
 	}
 	
+	/// Construct from an array_view whose element type is convertible to `T` by qualification (e.g. `array_view<int>` to `array_view<const int>`).
+	template<class U, class = std::enable_if_t<std::is_convertible<U(*)[], T(*)[]>::value>>
+	constexpr array_view(const array_view<U>& other) noexcept
+	: _data(other.data())
+	, _len(other.size())
+	{
+	}
+	
 	constexpr array_view(const array_view& s) noexcept = default;
 	array_view& operator = (const array_view& s) noexcept = default;
 	
@@ -0,0 +1,839 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+/**
+ \file
+ Asynchronous positional file I/O returning futures.
+
+ On Linux requests are submitted to an io_uring instance created through raw system calls, so no additional library is required. Where io_uring is not available (older kernels, restricted containers, other POSIX systems) a small thread pool performs blocking `pread` and `pwrite` calls instead.
+
+ ~~~cpp
+ xtd::async_file f{"snapshot.bin", std::ios_base::in};
+ std::vector<unsigned char> a(1 << 20), b(1 << 20);
+ std::future<std::size_t> ra, rb;
+ {
+     xtd::async_file::batch batch{f}; // Submitted together at the end of the scope
+     ra = f.read_at(0, a);
+     rb = f.read_at(a.size(), b);
+ }
+ consume(a, ra.get());
+ ~~~
+
+ \author Miro Knejp
+ */
+
+#pragma once
+
+#include <xtd/array_view.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <ios>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define XTD_ASYNC_FILE_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+namespace xtd
+{
+	class async_file;
+	struct async_file_options;
+
+	namespace detail
+	{
+		namespace async_file
+		{
+			class Engine;
+		}
+	}
+}
+
+/// How requests of an async_file are carried out.
+struct xtd::async_file_options
+{
+	enum class backend
+	{
+		/// Use io_uring if available, otherwise the thread pool.
+		automatic,
+		/// Use io_uring or fail.
+		io_uring,
+		/// Use blocking calls on a pool of threads.
+		thread_pool,
+	};
+
+	backend engine = backend::automatic;
+	/// Maximum number of requests in flight at once with io_uring. Further requests block until others complete.
+	unsigned queue_depth = 64;
+	/// Number of threads used by the thread pool.
+	unsigned threads = 4;
+};
+
+/**
+ A file whose reads and writes at explicit offsets complete asynchronously.
+
+ Each request returns a `std::future` holding the number of bytes transferred, which is less than requested only if a read reaches the end of the file. Failures are reported as `std::system_error` through the future. The memory passed to a request must stay valid until its future is ready.
+
+ Requests are submitted immediately unless a `batch` is active, in which case they are collected and passed to the kernel with a single system call at the end of the batch. Requests may complete in any order.
+
+ The destructor waits for all requests in flight to complete. Requests still collected by a batch are submitted first, or failed if that is not possible.
+ */
+class xtd::async_file
+{
+public:
+	using options = async_file_options;
+	using backend = async_file_options::backend;
+
+	class batch;
+
+	/**
+	 Open the file at `path`.
+
+	 `mode` follows `std::fopen`: `in` opens an existing file for reading, `out` creates or truncates a file for writing, `in | out` opens an existing file for both unless `trunc` is also given.
+
+	 \throws std::system_error if the file cannot be opened or the requested backend is not available.
+	 */
+	async_file(const std::string& path, std::ios_base::openmode mode, const options& opts = {});
+	/// Take ownership of the open file descriptor `fd`, e.g. to use flags such as `O_DIRECT`.
+	explicit async_file(int fd, const options& opts = {});
+	async_file(async_file&& other) noexcept;
+	async_file& operator=(async_file&& other) noexcept;
+	~async_file();
+
+	/// Read up to `buffer.size()` bytes starting at `offset` into `buffer`.
+	std::future<std::size_t> read_at(std::uint64_t offset, array_view<unsigned char> buffer);
+	/// Write `buffer` to the file starting at `offset`.
+	std::future<std::size_t> write_at(std::uint64_t offset, array_view<const unsigned char> buffer);
+
+	/**
+	 Submit all requests collected by active batches.
+
+	 \throws std::system_error if the requests cannot be passed to the kernel, in which case their futures hold the same error.
+	 */
+	void submit();
+
+	/**
+	 Register memory with the kernel to avoid mapping it for every request.
+
+	 Requests whose memory lies completely in one of the registered buffers use it automatically. Replaces previously registered buffers and waits for requests in flight to complete first. Has no effect for the thread pool.
+
+	 \throws std::system_error if the buffers cannot be registered, e.g. because they exceed `RLIMIT_MEMLOCK`.
+	 */
+	void register_buffers(array_view<const array_view<unsigned char>> buffers);
+	/// Unregister all buffers. Waits for requests in flight to complete first.
+	void unregister_buffers();
+
+	/// The backend in use.
+	backend engine() const noexcept;
+	/// The file's current size in bytes.
+	std::uint64_t size() const;
+	/// The underlying file descriptor.
+	int native_handle() const noexcept { return _fd; }
+
+private:
+	std::future<std::size_t> start(bool write, std::uint64_t offset, unsigned char* data, std::size_t size);
+
+	int _fd = -1;
+	std::unique_ptr<detail::async_file::Engine> _engine;
+	unsigned _batch_depth = 0;
+};
+
+/**
+ While alive, requests to the file are collected and submitted together when the outermost batch ends.
+
+ If the destructor fails to submit the requests, the error is only reported through their futures. Call `submit` to end the batch early and see the error as an exception.
+ */
+class xtd::async_file::batch
+{
+public:
+	explicit batch(async_file& file) noexcept : _file(file) { ++_file._batch_depth; }
+	batch(const batch&) = delete;
+	batch& operator=(const batch&) = delete;
+	~batch()
+	{
+		if(!_active || --_file._batch_depth != 0)
+			return;
+		try
+		{
+			_file.submit();
+		}
+		catch(const std::system_error&)
+		{
+			// The futures of the requests hold the error
+		}
+	}
+
+	/**
+	 End the batch, submitting the collected requests if it is the outermost one.
+
+	 \throws std::system_error if the requests cannot be passed to the kernel, in which case their futures hold the same error.
+	 */
+	void submit()
+	{
+		if(!_active)
+			return;
+		_active = false;
+		if(--_file._batch_depth == 0)
+			_file.submit();
+	}
+
+private:
+	async_file& _file;
+	bool _active = true;
+};
+
+////////////////////////////////////////////////////////////////////////
+// Private parts, do not look.
+//
+
+namespace xtd
+{
+	namespace detail
+	{
+		namespace async_file
+		{
+			struct Operation
+			{
+				std::promise<std::size_t> promise;
+				int fd;
+				bool write;
+				unsigned char* data;
+				std::size_t size;
+				std::uint64_t offset;
+				std::size_t done = 0;
+				int fixed = -1; // Index of the registered buffer containing data
+				iovec iov;
+			};
+
+			inline std::system_error error(int code, const char* what)
+			{
+				return std::system_error{code, std::system_category(), what};
+			}
+
+			class Engine
+			{
+			public:
+				virtual ~Engine() = default;
+
+				virtual xtd::async_file::backend type() const noexcept = 0;
+				// Queue an operation, it is not necessarily passed on before submit()
+				virtual void start(std::unique_ptr<Operation> op) = 0;
+				virtual void submit() = 0;
+				virtual void register_buffers(array_view<const array_view<unsigned char>>) { }
+			};
+
+			////////////////////////////////////////////////////////////////////////
+			// Thread pool
+			//
+
+			class ThreadPool : public Engine
+			{
+			public:
+				explicit ThreadPool(unsigned threads)
+				{
+					threads = std::max(threads, 1u);
+					_threads.reserve(threads);
+					for(unsigned i = 0; i < threads; ++i)
+						_threads.emplace_back([this] { work(); });
+				}
+				~ThreadPool()
+				{
+					{
+						std::lock_guard<std::mutex> lock{_mutex};
+						move_pending();
+						_stop = true;
+					}
+					_work.notify_all();
+					for(auto& t : _threads)
+						t.join();
+				}
+
+				xtd::async_file::backend type() const noexcept override { return xtd::async_file::backend::thread_pool; }
+
+				void start(std::unique_ptr<Operation> op) override
+				{
+					std::lock_guard<std::mutex> lock{_mutex};
+					_pending.push_back(std::move(op));
+				}
+
+				void submit() override
+				{
+					{
+						std::lock_guard<std::mutex> lock{_mutex};
+						move_pending();
+					}
+					_work.notify_all();
+				}
+
+			private:
+				void move_pending()
+				{
+					for(auto& op : _pending)
+						_queue.push_back(std::move(op));
+					_pending.clear();
+				}
+
+				void work()
+				{
+					for(;;)
+					{
+						std::unique_ptr<Operation> op;
+						{
+							std::unique_lock<std::mutex> lock{_mutex};
+							_work.wait(lock, [this] { return _stop || !_queue.empty(); });
+							if(_queue.empty())
+								return;
+							op = std::move(_queue.front());
+							_queue.pop_front();
+						}
+						run(*op);
+					}
+				}
+
+				static void run(Operation& op)
+				{
+					while(op.done < op.size)
+					{
+						auto p = op.data + op.done;
+						auto n = op.size - op.done;
+						auto offset = static_cast<off_t>(op.offset + op.done);
+						auto result = op.write ? ::pwrite(op.fd, p, n, offset) : ::pread(op.fd, p, n, offset);
+						if(result < 0)
+						{
+							if(errno == EINTR)
+								continue;
+							op.promise.set_exception(std::make_exception_ptr(error(errno, op.write ? "xtd::async_file::write_at" : "xtd::async_file::read_at")));
+							return;
+						}
+						if(result == 0)
+							break;
+						op.done += static_cast<std::size_t>(result);
+					}
+					op.promise.set_value(op.done);
+				}
+
+				std::mutex _mutex;
+				std::condition_variable _work;
+				std::vector<std::unique_ptr<Operation>> _pending; // Held back by a batch
+				std::deque<std::unique_ptr<Operation>> _queue;
+				bool _stop = false;
+				std::vector<std::thread> _threads;
+			};
+
+#if defined(XTD_ASYNC_FILE_IO_URING)
+
+			////////////////////////////////////////////////////////////////////////
+			// io_uring
+			//
+
+			// Passes count entries of the submission queue to the kernel
+			struct Enter
+			{
+				long operator()(int ring, unsigned count) const noexcept
+				{
+					return ::syscall(__NR_io_uring_enter, ring, count, 0, 0, nullptr, 0);
+				}
+			};
+
+			// Submissions go through Submit, which tests replace to simulate failures
+			template<class Submit = Enter>
+			class IoUring : public Engine
+			{
+			public:
+				explicit IoUring(unsigned entries)
+				{
+					io_uring_params params;
+					std::memset(&params, 0, sizeof(params));
+					_ring = static_cast<int>(::syscall(__NR_io_uring_setup, std::max(entries, 1u), &params));
+					if(_ring < 0)
+						throw error(errno, "xtd::async_file: io_uring_setup");
+					_entries = params.sq_entries;
+
+					_sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+					_cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+					if(params.features & IORING_FEAT_SINGLE_MMAP)
+						_sq_size = _cq_size = std::max(_sq_size, _cq_size);
+					_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+
+					_sq = map(_sq_size, IORING_OFF_SQ_RING);
+					_cq = (params.features & IORING_FEAT_SINGLE_MMAP) ? _sq : map(_cq_size, IORING_OFF_CQ_RING);
+					_sqes = static_cast<io_uring_sqe*>(map(_sqes_size, IORING_OFF_SQES));
+					if(!_sq || !_cq || !_sqes)
+					{
+						auto code = errno;
+						unmap();
+						throw error(code, "xtd::async_file: mapping io_uring");
+					}
+
+					auto sq = static_cast<unsigned char*>(_sq);
+					_sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+					_sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+					_sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+					_sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+					auto cq = static_cast<unsigned char*>(_cq);
+					_cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+					_cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+					_cq_mask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+					_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+					_reaper = std::thread{[this] { reap(); }};
+				}
+				~IoUring()
+				{
+					{
+						std::lock_guard<std::mutex> lock{_mutex};
+						try
+						{
+							flush();
+						}
+						catch(const std::system_error&)
+						{
+							// The requests which could not be submitted have been failed
+						}
+						_stop = true;
+					}
+					_reap.notify_all();
+					// The reaper returns once every submitted request has completed
+					_reaper.join();
+					unmap();
+				}
+
+				xtd::async_file::backend type() const noexcept override { return xtd::async_file::backend::io_uring; }
+
+				void start(std::unique_ptr<Operation> op) override
+				{
+					std::unique_lock<std::mutex> lock{_mutex};
+					if(_in_flight == _entries)
+					{
+						// Requests held back by a batch would never complete and make room
+						flush();
+						_space.wait(lock, [this] { return _in_flight < _entries; });
+					}
+					for(std::size_t i = 0; i < _buffers.size(); ++i)
+					{
+						auto& b = _buffers[i];
+						if(op->data >= b.data() && op->size <= b.size() && static_cast<std::size_t>(op->data - b.data()) <= b.size() - op->size)
+						{
+							op->fixed = static_cast<int>(i);
+							break;
+						}
+					}
+					prepare(op.release());
+					++_in_flight;
+				}
+
+				void submit() override
+				{
+					std::lock_guard<std::mutex> lock{_mutex};
+					flush();
+				}
+
+				void register_buffers(array_view<const array_view<unsigned char>> buffers) override
+				{
+					std::unique_lock<std::mutex> lock{_mutex};
+					flush();
+					_space.wait(lock, [this] { return _in_flight == 0; });
+					if(!_buffers.empty())
+					{
+						::syscall(__NR_io_uring_register, _ring, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+						_buffers.clear();
+					}
+					if(buffers.empty())
+						return;
+					std::vector<iovec> iovs;
+					iovs.reserve(buffers.size());
+					for(auto& b : buffers)
+						iovs.push_back({b.data(), b.size()});
+					if(::syscall(__NR_io_uring_register, _ring, IORING_REGISTER_BUFFERS, iovs.data(), static_cast<unsigned>(iovs.size())) < 0)
+						throw error(errno, "xtd::async_file::register_buffers");
+					_buffers.assign(buffers.begin(), buffers.end());
+				}
+
+			private:
+				void* map(std::size_t size, off_t offset) noexcept
+				{
+					auto p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring, offset);
+					return p == MAP_FAILED ? nullptr : p;
+				}
+
+				void unmap() noexcept
+				{
+					if(_sqes)
+						::munmap(_sqes, _sqes_size);
+					if(_cq && _cq != _sq)
+						::munmap(_cq, _cq_size);
+					if(_sq)
+						::munmap(_sq, _sq_size);
+					::close(_ring);
+				}
+
+				// The following require _mutex to be locked
+
+				io_uring_sqe* next_sqe() noexcept
+				{
+					// There is always room as the number of operations in flight is limited to the queue size
+					auto sqe = &_sqes[*_sq_tail & _sq_mask];
+					std::memset(sqe, 0, sizeof(*sqe));
+					return sqe;
+				}
+
+				void push_sqe() noexcept
+				{
+					auto tail = *_sq_tail;
+					_sq_array[tail & _sq_mask] = tail & _sq_mask;
+					__atomic_store_n(_sq_tail, tail + 1, __ATOMIC_RELEASE);
+					++_unsubmitted;
+				}
+
+				// Queue the not yet transferred part of op
+				void prepare(Operation* op) noexcept
+				{
+					auto sqe = next_sqe();
+					sqe->fd = op->fd;
+					sqe->off = op->offset + op->done;
+					sqe->user_data = reinterpret_cast<std::uintptr_t>(op);
+					// Linux transfers at most 0x7FFFF000 bytes per call, the rest is resubmitted
+					auto n = std::min<std::size_t>(op->size - op->done, 0x7FFFF000);
+					if(op->fixed >= 0)
+					{
+						sqe->opcode = op->write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+						sqe->addr = reinterpret_cast<std::uintptr_t>(op->data + op->done);
+						sqe->len = static_cast<unsigned>(n);
+						sqe->buf_index = static_cast<std::uint16_t>(op->fixed);
+					}
+					else
+					{
+						sqe->opcode = op->write ? IORING_OP_WRITEV : IORING_OP_READV;
+						op->iov = {op->data + op->done, n};
+						sqe->addr = reinterpret_cast<std::uintptr_t>(&op->iov);
+						sqe->len = 1;
+					}
+					push_sqe();
+				}
+
+				// Pass queued entries to the kernel. If that fails the entries it did not consume are withdrawn and their operations failed before the error is thrown.
+				void flush()
+				{
+					while(_unsubmitted > 0)
+					{
+						auto n = Submit{}(_ring, _unsubmitted);
+						if(n < 0)
+						{
+							if(errno == EINTR || errno == EAGAIN || errno == EBUSY)
+								continue;
+							auto e = error(errno, "xtd::async_file: io_uring_enter");
+							withdraw(std::make_exception_ptr(e));
+							throw e;
+						}
+						_unsubmitted -= static_cast<unsigned>(n);
+						_submitted += static_cast<unsigned>(n);
+						_reap.notify_one();
+					}
+				}
+
+				// Take back the unsubmitted entries from the end of the ring, so they are never submitted after their operations are gone
+				void withdraw(std::exception_ptr e) noexcept
+				{
+					auto tail = *_sq_tail;
+					for(; _unsubmitted > 0; --_unsubmitted)
+					{
+						--tail;
+						auto op = reinterpret_cast<Operation*>(static_cast<std::uintptr_t>(_sqes[_sq_array[tail & _sq_mask]].user_data));
+						op->promise.set_exception(e);
+						delete op;
+						--_in_flight;
+					}
+					__atomic_store_n(_sq_tail, tail, __ATOMIC_RELEASE);
+					_space.notify_all();
+				}
+
+				// Only waits in the kernel while completions are outstanding, so stopping does not depend on submitting anything
+				void reap()
+				{
+					for(;;)
+					{
+						{
+							std::unique_lock<std::mutex> lock{_mutex};
+							_reap.wait(lock, [this] { return _stop || _submitted > 0; });
+							if(_submitted == 0)
+								return;
+						}
+						::syscall(__NR_io_uring_enter, _ring, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+						auto head = *_cq_head;
+						auto tail = __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE);
+						unsigned reaped = 0;
+						for(; head != tail; ++head, ++reaped)
+						{
+							auto& cqe = _cqes[head & _cq_mask];
+							complete(reinterpret_cast<Operation*>(static_cast<std::uintptr_t>(cqe.user_data)), cqe.res);
+						}
+						__atomic_store_n(_cq_head, head, __ATOMIC_RELEASE);
+						std::lock_guard<std::mutex> lock{_mutex};
+						_submitted -= reaped;
+					}
+				}
+
+				void complete(Operation* op, int result)
+				{
+					if(result == -EINTR || result == -EAGAIN || (result > 0 && op->done + static_cast<std::size_t>(result) < op->size))
+					{
+						if(result > 0)
+							op->done += static_cast<std::size_t>(result);
+						std::lock_guard<std::mutex> lock{_mutex};
+						// Entries held back by a batch are ahead in the ring and would be submitted with this one, leave it to the batch
+						auto held = _unsubmitted > 0;
+						prepare(op);
+						if(!held)
+						{
+							try
+							{
+								flush();
+							}
+							catch(const std::system_error&)
+							{
+								// op has been failed
+							}
+						}
+						return;
+					}
+					if(result < 0)
+						fail(op, std::make_exception_ptr(error(-result, op->write ? "xtd::async_file::write_at" : "xtd::async_file::read_at")));
+					else
+					{
+						op->done += static_cast<std::size_t>(result);
+						op->promise.set_value(op->done);
+						finish(op);
+					}
+				}
+
+				void fail(Operation* op, std::exception_ptr e)
+				{
+					op->promise.set_exception(e);
+					finish(op);
+				}
+
+				void finish(Operation* op)
+				{
+					delete op;
+					{
+						std::lock_guard<std::mutex> lock{_mutex};
+						--_in_flight;
+					}
+					_space.notify_all();
+				}
+
+				int _ring = -1;
+				unsigned _entries = 0;
+				void* _sq = nullptr;
+				void* _cq = nullptr;
+				io_uring_sqe* _sqes = nullptr;
+				std::size_t _sq_size = 0;
+				std::size_t _cq_size = 0;
+				std::size_t _sqes_size = 0;
+				unsigned* _sq_head = nullptr;
+				unsigned* _sq_tail = nullptr;
+				unsigned* _sq_array = nullptr;
+				unsigned _sq_mask = 0;
+				unsigned* _cq_head = nullptr;
+				unsigned* _cq_tail = nullptr;
+				io_uring_cqe* _cqes = nullptr;
+				unsigned _cq_mask = 0;
+
+				std::mutex _mutex;
+				std::condition_variable _space;
+				std::condition_variable _reap;
+				unsigned _in_flight = 0;
+				unsigned _unsubmitted = 0;
+				unsigned _submitted = 0; // Entries consumed by the kernel whose completions are not reaped yet
+				bool _stop = false;
+				std::vector<array_view<unsigned char>> _buffers;
+				std::thread _reaper;
+			};
+
+#endif // XTD_ASYNC_FILE_IO_URING
+
+			inline std::unique_ptr<Engine> make_engine(const xtd::async_file::options& opts)
+			{
+				using backend = xtd::async_file::backend;
+#if defined(XTD_ASYNC_FILE_IO_URING)
+				if(opts.engine != backend::thread_pool)
+				{
+					try
+					{
+						return std::make_unique<IoUring<>>(opts.queue_depth);
+					}
+					catch(const std::system_error&)
+					{
+						if(opts.engine == backend::io_uring)
+							throw;
+					}
+				}
+#else
+				if(opts.engine == backend::io_uring)
+					throw error(ENOSYS, "xtd::async_file: io_uring");
+#endif
+				return std::make_unique<ThreadPool>(opts.threads);
+			}
+
+			inline int open_flags(std::ios_base::openmode mode)
+			{
+				const auto in = (mode & std::ios_base::in) != 0;
+				const auto out = (mode & std::ios_base::out) != 0;
+				const auto trunc = (mode & std::ios_base::trunc) != 0;
+				if(in && out)
+					return O_RDWR | (trunc ? O_CREAT | O_TRUNC : 0);
+				if(out)
+					return O_WRONLY | O_CREAT | O_TRUNC;
+				return O_RDONLY;
+			}
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////
+// async_file
+//
+
+inline xtd::async_file::async_file(const std::string& path, std::ios_base::openmode mode, const options& opts)
+{
+	do
+		_fd = ::open(path.c_str(), detail::async_file::open_flags(mode) | O_CLOEXEC, 0666);
+	while(_fd < 0 && errno == EINTR);
+	if(_fd < 0)
+		throw detail::async_file::error(errno, "xtd::async_file: open");
+	try
+	{
+		_engine = detail::async_file::make_engine(opts);
+	}
+	catch(...)
+	{
+		::close(_fd);
+		throw;
+	}
+}
+
+inline xtd::async_file::async_file(int fd, const options& opts)
+: _fd(fd)
+{
+	try
+	{
+		_engine = detail::async_file::make_engine(opts);
+	}
+	catch(...)
+	{
+		::close(_fd);
+		throw;
+	}
+}
+
+inline xtd::async_file::async_file(async_file&& other) noexcept
+: _fd(other._fd)
+, _engine(std::move(other._engine))
+, _batch_depth(other._batch_depth)
+{
+	other._fd = -1;
+}
+
+inline auto xtd::async_file::operator=(async_file&& other) noexcept -> async_file&
+{
+	if(this != &other)
+	{
+		_engine.reset();
+		if(_fd >= 0)
+			::close(_fd);
+		_fd = other._fd;
+		_engine = std::move(other._engine);
+		_batch_depth = other._batch_depth;
+		other._fd = -1;
+	}
+	return *this;
+}
+
+inline xtd::async_file::~async_file()
+{
+	// Finish requests in flight before closing the file
+	_engine.reset();
+	if(_fd >= 0)
+		::close(_fd);
+}
+
+inline std::future<std::size_t> xtd::async_file::read_at(std::uint64_t offset, array_view<unsigned char> buffer)
+{
+	return start(false, offset, buffer.data(), buffer.size());
+}
+
+inline std::future<std::size_t> xtd::async_file::write_at(std::uint64_t offset, array_view<const unsigned char> buffer)
+{
+	return start(true, offset, const_cast<unsigned char*>(buffer.data()), buffer.size());
+}
+
+inline std::future<std::size_t> xtd::async_file::start(bool write, std::uint64_t offset, unsigned char* data, std::size_t size)
+{
+	auto op = std::make_unique<detail::async_file::Operation>();
+	op->fd = _fd;
+	op->write = write;
+	op->data = data;
+	op->size = size;
+	op->offset = offset;
+	auto future = op->promise.get_future();
+	if(size == 0)
+	{
+		op->promise.set_value(0);
+		return future;
+	}
+	_engine->start(std::move(op));
+	if(_batch_depth == 0)
+		_engine->submit();
+	return future;
+}
+
+inline void xtd::async_file::submit()
+{
+	_engine->submit();
+}
+
+inline void xtd::async_file::register_buffers(array_view<const array_view<unsigned char>> buffers)
+{
+	_engine->register_buffers(buffers);
+}
+
+inline void xtd::async_file::unregister_buffers()
+{
+	_engine->register_buffers({});
+}
+
+inline auto xtd::async_file::engine() const noexcept -> backend
+{
+	return _engine->type();
+}
+
+inline std::uint64_t xtd::async_file::size() const
+{
+	struct stat st;
+	if(::fstat(_fd, &st) < 0)
+		throw detail::async_file::error(errno, "xtd::async_file::size");
+	return static_cast<std::uint64_t>(st.st_size);
+}
@@ -0,0 +1,485 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+/**
+ \file
+ CRC-32C (Castagnoli) checksums and a stream buffer computing them for data passing through a stream.
+
+ On x86-64 the SSE4.2 `crc32` instruction is used when the CPU supports it, processing three independent streams at once to hide the instruction's latency. Otherwise a portable slice-by-8 table implementation is used.
+
+ \author Miro Knejp
+ */
+
+#pragma once
+
+#include <xtd/algorithm.hpp>
+#include <xtd/array_view.hpp>
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define XTD_CRC32C_X86 1
+#include <nmmintrin.h>
+#endif
+
+namespace xtd
+{
+	/**
+	 Compute the CRC-32C of `data`.
+
+	 Pass the result of a previous call as `crc` to continue the checksum over more data, i.e. `crc32c(b, crc32c(a))` equals the checksum of `a` followed by `b`.
+	 */
+	std::uint32_t crc32c(array_view<const unsigned char> data, std::uint32_t crc = 0) noexcept;
+
+	template<class CharT, class Traits = std::char_traits<CharT>>
+	class basic_crc32cbuf;
+
+	using crc32cbuf = basic_crc32cbuf<char>;
+
+	/**
+	 Write the checksum of all data written through the stream's basic_crc32cbuf since the last checksum as four unformatted little-endian bytes and start a new checksum.
+
+	 Sets `failbit` if the stream's buffer is not a basic_crc32cbuf.
+
+	 \code
+	 xtd::crc32cbuf buf{file.rdbuf()};
+	 std::ostream out{&buf};
+	 out << xtd::unformatted(header) << xtd::unformatted(values) << xtd::put_crc32c;
+	 \endcode
+	 */
+	template<class CharT, class Traits>
+	std::basic_ostream<CharT, Traits>& put_crc32c(std::basic_ostream<CharT, Traits>& out);
+
+	/**
+	 Read a checksum written by put_crc32c and compare it against the checksum of all data read through the stream's basic_crc32cbuf since the last checksum, then start a new checksum.
+
+	 Sets `failbit` if the checksums do not match or the stream's buffer is not a basic_crc32cbuf.
+
+	 \code
+	 xtd::crc32cbuf buf{file.rdbuf()};
+	 std::istream in{&buf};
+	 in >> xtd::unformatted(header) >> xtd::unformatted(values, header.count) >> xtd::check_crc32c;
+	 if(!in)
+	     throw corrupt_file{};
+	 \endcode
+	 */
+	template<class CharT, class Traits>
+	std::basic_istream<CharT, Traits>& check_crc32c(std::basic_istream<CharT, Traits>& in);
+}
+
+////////////////////////////////////////////////////////////////////////
+// Private parts, do not look.
+//
+
+namespace xtd
+{
+	namespace detail
+	{
+		namespace crc32c
+		{
+			// Reflected CRC-32C polynomial
+			constexpr std::uint32_t poly = 0x82F63B78;
+
+			// Entry n of table k is the CRC of byte n followed by k zero bytes
+			struct SliceEntry
+			{
+				std::size_t k;
+
+				static constexpr std::uint32_t byte(std::uint32_t crc) noexcept
+				{
+					for(int k = 0; k < 8; ++k)
+						crc = crc & 1 ? (crc >> 1) ^ poly : crc >> 1;
+					return crc;
+				}
+				constexpr std::uint32_t operator()(std::size_t n) const noexcept
+				{
+					auto crc = byte(static_cast<std::uint32_t>(n));
+					for(std::size_t i = 0; i < k; ++i)
+						crc = byte(crc & 0xFF) ^ (crc >> 8);
+					return crc;
+				}
+			};
+			struct SliceTable
+			{
+				constexpr std::array<std::uint32_t, 256> operator()(std::size_t k) const noexcept
+				{
+					return generate_array<256>(SliceEntry{k});
+				}
+			};
+
+			// Computed during compilation, the template allows defining the member in the header
+			template<class = void>
+			struct SliceTables
+			{
+				static constexpr std::array<std::array<std::uint32_t, 256>, 8> table = generate_array<8>(SliceTable{});
+			};
+			template<class D>
+			constexpr std::array<std::array<std::uint32_t, 256>, 8> SliceTables<D>::table;
+
+			inline std::uint32_t software(const unsigned char* p, std::size_t n, std::uint32_t crc) noexcept
+			{
+				auto& t = SliceTables<>::table;
+				crc = ~crc;
+				for(; n > 0 && reinterpret_cast<std::uintptr_t>(p) % 8 != 0; --n)
+					crc = t[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+				for(; n >= 8; n -= 8, p += 8)
+				{
+					auto lo = crc ^ (std::uint32_t(p[0]) | std::uint32_t(p[1]) << 8 | std::uint32_t(p[2]) << 16 | std::uint32_t(p[3]) << 24);
+					crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24]
+						^ t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+				}
+				for(; n > 0; --n)
+					crc = t[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+				return ~crc;
+			}
+
+#if defined(XTD_CRC32C_X86)
+			// Block sizes of the three interleaved streams
+			constexpr std::size_t long_block = 8192;
+			constexpr std::size_t short_block = 256;
+
+			// Tables applying the operator "append len zero bytes" to a CRC one byte at a time.
+			struct ShiftTable
+			{
+				explicit ShiftTable(std::size_t len) noexcept
+				{
+					std::uint32_t op[32];
+					zeros_operator(op, len);
+					for(std::uint32_t n = 0; n < 256; ++n)
+					{
+						table[0][n] = times(op, n);
+						table[1][n] = times(op, n << 8);
+						table[2][n] = times(op, n << 16);
+						table[3][n] = times(op, n << 24);
+					}
+				}
+
+				std::uint32_t operator()(std::uint32_t crc) const noexcept
+				{
+					return table[0][crc & 0xFF] ^ table[1][(crc >> 8) & 0xFF] ^ table[2][(crc >> 16) & 0xFF] ^ table[3][crc >> 24];
+				}
+
+				std::uint32_t table[4][256];
+
+			private:
+				// Multiply the GF(2) 32x32 matrix mat with vec
+				static std::uint32_t times(const std::uint32_t* mat, std::uint32_t vec) noexcept
+				{
+					std::uint32_t sum = 0;
+					for(; vec; vec >>= 1, ++mat)
+						if(vec & 1)
+							sum ^= *mat;
+					return sum;
+				}
+				static void square(std::uint32_t* result, const std::uint32_t* mat) noexcept
+				{
+					for(int n = 0; n < 32; ++n)
+						result[n] = times(mat, mat[n]);
+				}
+				static void zeros_operator(std::uint32_t* even, std::size_t len) noexcept
+				{
+					// Operator for a single zero bit, then square up to len zero bytes
+					std::uint32_t odd[32];
+					odd[0] = poly;
+					for(int n = 1; n < 32; ++n)
+						odd[n] = std::uint32_t(1) << (n - 1);
+					square(even, odd);
+					square(odd, even);
+					for(;;)
+					{
+						square(even, odd);
+						len >>= 1;
+						if(len == 0)
+							return;
+						square(odd, even);
+						len >>= 1;
+						if(len == 0)
+							break;
+					}
+					std::memcpy(even, odd, sizeof(odd));
+				}
+			};
+
+			inline bool has_sse42() noexcept
+			{
+				static const bool supported = __builtin_cpu_supports("sse4.2");
+				return supported;
+			}
+
+#if defined(__x86_64__)
+			using hw_crc_t = std::uint64_t;
+#else
+			using hw_crc_t = std::uint32_t;
+#endif
+
+			__attribute__((target("sse4.2")))
+			inline hw_crc_t hardware_step(hw_crc_t crc, const unsigned char* p) noexcept
+			{
+				std::uint64_t x;
+				std::memcpy(&x, p, sizeof(x));
+#if defined(__x86_64__)
+				return _mm_crc32_u64(crc, x);
+#else
+				return _mm_crc32_u32(_mm_crc32_u32(crc, std::uint32_t(x)), std::uint32_t(x >> 32));
+#endif
+			}
+
+			// Three independent streams keep the 3-cycle latency, 1-cycle throughput instruction busy
+			__attribute__((target("sse4.2")))
+			inline hw_crc_t hardware_interleaved(hw_crc_t crc0, const unsigned char*& p, std::size_t& n, std::size_t block, const ShiftTable& shift) noexcept
+			{
+				for(; n >= 3 * block; n -= 3 * block, p += 3 * block)
+				{
+					hw_crc_t crc1 = 0;
+					hw_crc_t crc2 = 0;
+					for(std::size_t i = 0; i < block; i += 8)
+					{
+						crc0 = hardware_step(crc0, p + i);
+						crc1 = hardware_step(crc1, p + block + i);
+						crc2 = hardware_step(crc2, p + 2 * block + i);
+					}
+					crc0 = shift(static_cast<std::uint32_t>(crc0)) ^ crc1;
+					crc0 = shift(static_cast<std::uint32_t>(crc0)) ^ crc2;
+				}
+				return crc0;
+			}
+
+			__attribute__((target("sse4.2")))
+			inline std::uint32_t hardware(const unsigned char* p, std::size_t n, std::uint32_t crc) noexcept
+			{
+				static const ShiftTable shift_long{long_block};
+				static const ShiftTable shift_short{short_block};
+
+				hw_crc_t crc0 = ~crc;
+				for(; n > 0 && reinterpret_cast<std::uintptr_t>(p) % 8 != 0; --n)
+					crc0 = _mm_crc32_u8(static_cast<std::uint32_t>(crc0), *p++);
+				crc0 = hardware_interleaved(crc0, p, n, long_block, shift_long);
+				crc0 = hardware_interleaved(crc0, p, n, short_block, shift_short);
+				for(; n >= 8; n -= 8, p += 8)
+					crc0 = hardware_step(crc0, p);
+				for(; n > 0; --n)
+					crc0 = _mm_crc32_u8(static_cast<std::uint32_t>(crc0), *p++);
+				return ~static_cast<std::uint32_t>(crc0);
+			}
+#endif
+		}
+	}
+}
+
+inline std::uint32_t xtd::crc32c(array_view<const unsigned char> data, std::uint32_t crc) noexcept
+{
+#if defined(XTD_CRC32C_X86)
+	if(detail::crc32c::has_sse42())
+		return detail::crc32c::hardware(data.data(), data.size(), crc);
+#endif
+	return detail::crc32c::software(data.data(), data.size(), crc);
+}
+
+////////////////////////////////////////////////////////////////////////
+// basic_crc32cbuf
+//
+
+/**
+ A stream buffer forwarding all data to another stream buffer while computing its CRC-32C.
+
+ Data is buffered in both directions and reading may consume more from the wrapped buffer than has been extracted from this one. The checksum only covers data actually inserted into or extracted from this buffer. It is not meant to be used for input and output at the same time, as both contribute to the same checksum.
+
+ \code
+ std::ofstream file{"data.bin", std::ios::binary};
+ xtd::crc32cbuf buf{file.rdbuf()};
+ std::ostream out{&buf};
+ out << xtd::unformatted(values);
+ auto crc = buf.checksum();
+ \endcode
+ */
+template<class CharT, class Traits>
+class xtd::basic_crc32cbuf : public std::basic_streambuf<CharT, Traits>
+{
+	static_assert(sizeof(CharT) == 1, "xtd::basic_crc32cbuf: Only streams with single-byte elements are supported.");
+
+public:
+	using char_type = CharT;
+	using traits_type = Traits;
+	using int_type = typename Traits::int_type;
+	using pos_type = typename Traits::pos_type;
+	using off_type = typename Traits::off_type;
+
+	/// Forward data to and from `wrapped`, which must outlive this object.
+	explicit basic_crc32cbuf(std::basic_streambuf<CharT, Traits>* wrapped, std::size_t buffer_size = 1 << 14)
+	: _wrapped(wrapped)
+	, _out(buffer_size > 0 ? buffer_size : 1)
+	, _in(buffer_size > 0 ? buffer_size : 1)
+	{
+		this->setp(_out.data(), _out.data() + _out.size());
+		_put_mark = this->pptr();
+	}
+	basic_crc32cbuf(const basic_crc32cbuf&) = delete;
+	basic_crc32cbuf& operator=(const basic_crc32cbuf&) = delete;
+
+	~basic_crc32cbuf()
+	{
+		flush();
+	}
+
+	/// The checksum of all data inserted or extracted since construction or the last call to `reset()`.
+	std::uint32_t checksum() noexcept
+	{
+		fold_put();
+		fold_get();
+		return _crc;
+	}
+
+	/// Start a new checksum.
+	void reset() noexcept
+	{
+		_crc = 0;
+		_put_mark = this->pptr();
+		_get_mark = this->gptr();
+	}
+
+protected:
+	int_type overflow(int_type ch) override
+	{
+		if(!flush())
+			return Traits::eof();
+		if(!Traits::eq_int_type(ch, Traits::eof()))
+		{
+			*this->pptr() = Traits::to_char_type(ch);
+			this->pbump(1);
+		}
+		return Traits::not_eof(ch);
+	}
+
+	std::streamsize xsputn(const CharT* s, std::streamsize n) override
+	{
+		if(n < static_cast<std::streamsize>(_out.size()))
+			return std::basic_streambuf<CharT, Traits>::xsputn(s, n);
+		// Large writes bypass the buffer
+		if(!flush())
+			return 0;
+		auto written = _wrapped->sputn(s, n);
+		if(written > 0)
+			update(s, static_cast<std::size_t>(written));
+		return written;
+	}
+
+	int sync() override
+	{
+		if(!flush())
+			return -1;
+		return _wrapped->pubsync();
+	}
+
+	int_type underflow() override
+	{
+		if(this->gptr() < this->egptr())
+			return Traits::to_int_type(*this->gptr());
+		fold_get();
+		auto n = _wrapped->sgetn(_in.data(), static_cast<std::streamsize>(_in.size()));
+		if(n <= 0)
+			return Traits::eof();
+		this->setg(_in.data(), _in.data(), _in.data() + n);
+		_get_mark = this->gptr();
+		return Traits::to_int_type(*this->gptr());
+	}
+
+	std::streamsize xsgetn(CharT* s, std::streamsize n) override
+	{
+		auto buffered = this->egptr() - this->gptr();
+		if(n - buffered < static_cast<std::streamsize>(_in.size()))
+			return std::basic_streambuf<CharT, Traits>::xsgetn(s, n);
+		// Large reads bypass the buffer
+		std::copy(this->gptr(), this->egptr(), s);
+		this->gbump(static_cast<int>(buffered));
+		fold_get();
+		this->setg(_in.data(), _in.data(), _in.data());
+		_get_mark = this->gptr();
+		auto read = _wrapped->sgetn(s + buffered, n - buffered);
+		if(read > 0)
+			update(s + buffered, static_cast<std::size_t>(read));
+		return buffered + (read > 0 ? read : 0);
+	}
+
+private:
+	void update(const CharT* p, std::size_t n) noexcept
+	{
+		_crc = crc32c(make_array_view(reinterpret_cast<const unsigned char*>(p), n), _crc);
+	}
+	void fold_put() noexcept
+	{
+		update(_put_mark, static_cast<std::size_t>(this->pptr() - _put_mark));
+		_put_mark = this->pptr();
+	}
+	void fold_get() noexcept
+	{
+		if(_get_mark)
+			update(_get_mark, static_cast<std::size_t>(this->gptr() - _get_mark));
+		_get_mark = this->gptr();
+	}
+
+	bool flush()
+	{
+		fold_put();
+		auto n = this->pptr() - this->pbase();
+		this->setp(_out.data(), _out.data() + _out.size());
+		_put_mark = this->pptr();
+		return n == 0 || _wrapped->sputn(_out.data(), n) == n;
+	}
+
+	std::basic_streambuf<CharT, Traits>* _wrapped;
+	std::vector<CharT> _out;
+	std::vector<CharT> _in;
+	CharT* _put_mark = nullptr;
+	CharT* _get_mark = nullptr;
+	std::uint32_t _crc = 0;
+};
+
+template<class CharT, class Traits>
+std::basic_ostream<CharT, Traits>& xtd::put_crc32c(std::basic_ostream<CharT, Traits>& out)
+{
+	auto buf = dynamic_cast<basic_crc32cbuf<CharT, Traits>*>(out.rdbuf());
+	if(!buf)
+	{
+		out.setstate(std::ios_base::failbit);
+		return out;
+	}
+	auto crc = buf->checksum();
+	CharT bytes[4];
+	for(int i = 0; i < 4; ++i)
+		bytes[i] = static_cast<CharT>(crc >> (8 * i));
+	out.write(bytes, 4);
+	buf->reset();
+	return out;
+}
+
+template<class CharT, class Traits>
+std::basic_istream<CharT, Traits>& xtd::check_crc32c(std::basic_istream<CharT, Traits>& in)
+{
+	auto buf = dynamic_cast<basic_crc32cbuf<CharT, Traits>*>(in.rdbuf());
+	if(!buf)
+	{
+		in.setstate(std::ios_base::failbit);
+		return in;
+	}
+	auto crc = buf->checksum();
+	CharT bytes[4];
+	if(in.read(bytes, 4))
+	{
+		std::uint32_t stored = 0;
+		for(int i = 0; i < 4; ++i)
+			stored |= std::uint32_t(static_cast<unsigned char>(bytes[i])) << (8 * i);
+		if(stored != crc)
+			in.setstate(std::ios_base::failbit);
+	}
+	buf->reset();
+	return in;
+}
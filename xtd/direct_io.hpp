@@ -0,0 +1,344 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+/**
+ \file
+ Sequential file reading and writing bypassing the page cache.
+
+ Files are opened with `O_DIRECT` (or `F_NOCACHE` where that is the platform's equivalent) so streaming large files does not evict other data from the page cache. Direct I/O requires buffers, sizes and offsets to be aligned, which `direct_writer` and `direct_reader` take care of by staging data in two aligned buffers: one is transferred by `async_file` while the other is being filled or consumed, overlapping computation with I/O.
+
+ If the file system does not support direct I/O the files are opened normally and everything else works the same.
+
+ ~~~cpp
+ xtd::direct_writer out{"snapshot.bin"};
+ for(auto& record : records)
+     out.write(encode(record));
+ out.close();
+
+ xtd::direct_reader in{"snapshot.bin"};
+ for(auto chunk = in.next(); !chunk.empty(); chunk = in.next())
+     decode(chunk);
+ ~~~
+
+ \author Miro Knejp
+ */
+
+#pragma once
+
+#include <xtd/array_view.hpp>
+#include <xtd/async_file.hpp>
+#include <xtd/finally.hpp>
+#include <xtd/memory.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <new>
+#include <string>
+#include <system_error>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace xtd
+{
+	class direct_writer;
+	class direct_reader;
+
+	/// Configuration of direct_writer and direct_reader.
+	struct direct_io_options
+	{
+		/// Size of each of the two staging buffers, rounded up to `alignment`.
+		std::size_t buffer_size = 1 << 20;
+		/// Alignment of buffers, transfer sizes and file offsets. Must be a power of two and a multiple of the device's logical block size.
+		std::size_t alignment = 4096;
+		/// How the transfers are carried out.
+		async_file_options io;
+	};
+}
+
+////////////////////////////////////////////////////////////////////////
+// Private parts, do not look.
+//
+
+namespace xtd
+{
+	namespace detail
+	{
+		namespace direct_io
+		{
+			struct Free
+			{
+				void operator()(unsigned char* p) const noexcept { std::free(p); }
+			};
+			using Buffer = std::unique_ptr<unsigned char, Free>;
+
+			inline Buffer allocate(std::size_t size, std::size_t alignment)
+			{
+				void* p = nullptr;
+				if(::posix_memalign(&p, std::max(alignment, sizeof(void*)), size) != 0)
+					throw std::bad_alloc{};
+				return Buffer{static_cast<unsigned char*>(p)};
+			}
+
+			// Open a file bypassing the page cache if the file system allows
+			inline int open(const std::string& path, int flags, bool& direct)
+			{
+				int fd = -1;
+				direct = false;
+#if defined(O_DIRECT)
+				do
+					fd = ::open(path.c_str(), flags | O_DIRECT | O_CLOEXEC, 0666);
+				while(fd < 0 && errno == EINTR);
+				direct = fd >= 0;
+				// Not supported by the file system
+				if(fd < 0 && errno != EINVAL)
+					throw std::system_error{errno, std::system_category(), "xtd::direct_io: open"};
+#endif
+				if(fd < 0)
+				{
+					do
+						fd = ::open(path.c_str(), flags | O_CLOEXEC, 0666);
+					while(fd < 0 && errno == EINTR);
+					if(fd < 0)
+						throw std::system_error{errno, std::system_category(), "xtd::direct_io: open"};
+#if defined(F_NOCACHE)
+					direct = ::fcntl(fd, F_NOCACHE, 1) != -1;
+#endif
+				}
+				return fd;
+			}
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////
+// direct_writer
+//
+
+/**
+ Writes a file sequentially with direct I/O.
+
+ Data is collected in an aligned buffer which is written asynchronously once full while writing continues into the second buffer. The unaligned tail is written padded to the alignment by `close`, which then truncates the file to its exact size.
+ */
+class xtd::direct_writer
+{
+public:
+	/**
+	 Create or truncate the file at `path`.
+
+	 \throws std::system_error if the file cannot be opened.
+	 */
+	explicit direct_writer(const std::string& path, const direct_io_options& opts = {})
+	: _alignment(opts.alignment)
+	, _buffer_size(align_up(std::max(opts.buffer_size, opts.alignment), opts.alignment))
+	{
+		for(auto& b : _buffers)
+			b = detail::direct_io::allocate(_buffer_size, _alignment);
+		_file = std::make_unique<async_file>(detail::direct_io::open(path, O_WRONLY | O_CREAT | O_TRUNC, _direct), opts.io);
+	}
+	direct_writer(const direct_writer&) = delete;
+	direct_writer& operator=(const direct_writer&) = delete;
+	/// Closes the file if not done yet, ignoring errors.
+	~direct_writer()
+	{
+		try
+		{
+			close();
+		}
+		catch(...)
+		{
+		}
+	}
+
+	/// Append `data` to the file.
+	void write(array_view<const unsigned char> data)
+	{
+		assert(_file && "xtd::direct_writer::write: The file is closed.");
+		while(!data.empty())
+		{
+			auto n = std::min(data.size(), _buffer_size - _fill);
+			std::memcpy(_buffers[_current].get() + _fill, data.data(), n);
+			_fill += n;
+			data = {data.data() + n, data.size() - n};
+			if(_fill == _buffer_size)
+				flush(_buffer_size);
+		}
+	}
+
+	/**
+	 Write the remaining data, wait for all transfers to complete and close the file.
+
+	 \throws std::system_error if any transfer failed.
+	 */
+	void close()
+	{
+		if(!_file)
+			return;
+		XTD_FINALLY { _file.reset(); };
+		auto size = this->size();
+		if(_fill > 0)
+		{
+			// Direct transfers must be aligned, the padding is truncated below
+			auto padded = align_up(_fill, _alignment);
+			std::memset(_buffers[_current].get() + _fill, 0, padded - _fill);
+			flush(padded);
+		}
+		wait(_current);
+		wait(_current ^ 1);
+		if(::ftruncate(_file->native_handle(), static_cast<off_t>(size)) < 0)
+			throw std::system_error{errno, std::system_category(), "xtd::direct_writer::close"};
+	}
+
+	/// Number of bytes written so far.
+	std::uint64_t size() const noexcept { return _written + _fill; }
+	/// Whether the page cache is bypassed.
+	bool direct() const noexcept { return _direct; }
+
+private:
+	// Start writing the current buffer and continue with the other one once its transfer is complete
+	void flush(std::size_t size)
+	{
+		_pending[_current] = _file->write_at(_written, {_buffers[_current].get(), size});
+		_written += _fill;
+		_fill = 0;
+		_current ^= 1;
+		wait(_current);
+	}
+
+	void wait(unsigned i)
+	{
+		if(_pending[i].valid())
+			_pending[i].get();
+	}
+
+	std::size_t _alignment;
+	std::size_t _buffer_size;
+	bool _direct = false;
+	detail::direct_io::Buffer _buffers[2];
+	// Destroyed before the buffers, waiting for transfers still in flight
+	std::unique_ptr<async_file> _file;
+	std::future<std::size_t> _pending[2];
+	unsigned _current = 0;
+	std::size_t _fill = 0;
+	std::uint64_t _written = 0;
+};
+
+////////////////////////////////////////////////////////////////////////
+// direct_reader
+//
+
+/**
+ Reads a file sequentially with direct I/O.
+
+ While the caller processes one buffer the next part of the file is read into the other one.
+ */
+class xtd::direct_reader
+{
+public:
+	/**
+	 Open the file at `path` and start reading.
+
+	 \throws std::system_error if the file cannot be opened.
+	 */
+	explicit direct_reader(const std::string& path, const direct_io_options& opts = {})
+	: _buffer_size(align_up(std::max(opts.buffer_size, opts.alignment), opts.alignment))
+	{
+		for(auto& b : _buffers)
+			b = detail::direct_io::allocate(_buffer_size, opts.alignment);
+		_file = std::make_unique<async_file>(detail::direct_io::open(path, O_RDONLY, _direct), opts.io);
+		_size = _file->size();
+		fetch(0);
+		fetch(1);
+	}
+	direct_reader(const direct_reader&) = delete;
+	direct_reader& operator=(const direct_reader&) = delete;
+
+	/**
+	 Get the next part of the file, which is empty at the end of the file.
+
+	 The view is valid until the next call to `next` or `read`. Mixing both is allowed.
+
+	 \throws std::system_error if reading fails.
+	 */
+	array_view<const unsigned char> next()
+	{
+		if(!_view.empty())
+		{
+			auto view = _view;
+			_view = {};
+			return view;
+		}
+		if(_started)
+		{
+			// The caller is done with the current buffer
+			fetch(_current);
+			_current ^= 1;
+		}
+		_started = true;
+		if(!_pending[_current].valid())
+			return {};
+		auto n = _pending[_current].get();
+		return {_buffers[_current].get(), n};
+	}
+
+	/**
+	 Copy the next `buffer.size()` bytes of the file to `buffer`.
+
+	 \returns The number of bytes read, which is less than requested only at the end of the file.
+	 \throws std::system_error if reading fails.
+	 */
+	std::size_t read(array_view<unsigned char> buffer)
+	{
+		std::size_t done = 0;
+		while(done < buffer.size())
+		{
+			if(_view.empty())
+			{
+				_view = next();
+				if(_view.empty())
+					break;
+			}
+			auto n = std::min(_view.size(), buffer.size() - done);
+			std::memcpy(buffer.data() + done, _view.data(), n);
+			_view = {_view.data() + n, _view.size() - n};
+			done += n;
+		}
+		return done;
+	}
+
+	/// The size of the file when it was opened.
+	std::uint64_t size() const noexcept { return _size; }
+	/// Whether the page cache is bypassed.
+	bool direct() const noexcept { return _direct; }
+
+private:
+	void fetch(unsigned i)
+	{
+		if(_offset >= _size)
+			return;
+		// The last read may extend past the end of the file to keep the size aligned
+		_pending[i] = _file->read_at(_offset, {_buffers[i].get(), _buffer_size});
+		_offset += _buffer_size;
+	}
+
+	std::size_t _buffer_size;
+	bool _direct = false;
+	detail::direct_io::Buffer _buffers[2];
+	// Destroyed before the buffers, waiting for transfers still in flight
+	std::unique_ptr<async_file> _file;
+	std::future<std::size_t> _pending[2];
+	std::uint64_t _size = 0;
+	std::uint64_t _offset = 0;
+	unsigned _current = 0;
+	bool _started = false;
+	array_view<const unsigned char> _view; // Not yet consumed by read()
+};
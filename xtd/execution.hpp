@@ -0,0 +1,115 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+/**
+ \file
+ Execution policies selecting the parallel overloads of algorithms, modeled after `<execution>` of C++17.
+
+ ~~~cpp
+ auto sum = xtd::reduce(xtd::execution::par, values);
+ auto sum4 = xtd::reduce(xtd::execution::parallel_policy{4}, values); // At most 4 threads
+ ~~~
+
+ \author Miro Knejp
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace xtd
+{
+	namespace execution
+	{
+		/// Run an algorithm on multiple threads.
+		struct parallel_policy
+		{
+			/// Maximum number of threads to use, including the calling thread. Zero uses `std::thread::hardware_concurrency()`.
+			unsigned threads = 0;
+
+			/// The number of threads to use.
+			unsigned concurrency() const noexcept
+			{
+				// Querying the hardware is a system call on some platforms
+				static const auto hardware = std::max(std::thread::hardware_concurrency(), 1u);
+				return threads ? threads : hardware;
+			}
+		};
+
+		/// Run an algorithm on as many threads as the hardware supports.
+		constexpr parallel_policy par{};
+	}
+}
+
+////////////////////////////////////////////////////////////////////////
+// Private parts, do not look.
+//
+
+namespace xtd
+{
+	namespace detail
+	{
+		namespace execution
+		{
+			/**
+			 Split `[0, n)` into contiguous chunks of at least `grain` elements, at most one per thread, and call `f(chunk, first, last)` for each concurrently.
+
+			 The calling thread processes the first chunk. Returns the number of chunks, which is zero only if `n` is zero. If any invocation throws, the first exception by chunk order is rethrown after all threads have finished.
+			 */
+			template<class F>
+			std::size_t parallel_for(const xtd::execution::parallel_policy& policy, std::size_t n, std::size_t grain, F&& f)
+			{
+				if(n == 0)
+					return 0;
+				auto chunks = std::min<std::size_t>(policy.concurrency(), std::max<std::size_t>(n / std::max<std::size_t>(grain, 1), 1));
+				if(chunks == 1)
+				{
+					f(std::size_t(0), std::size_t(0), n);
+					return 1;
+				}
+
+				auto bounds = [n, chunks] (std::size_t i) { return n / chunks * i + std::min(i, n % chunks); };
+				std::vector<std::exception_ptr> errors(chunks);
+				std::vector<std::thread> threads;
+				threads.reserve(chunks - 1);
+				auto run = [&] (std::size_t i)
+				{
+					try
+					{
+						f(i, bounds(i), bounds(i + 1));
+					}
+					catch(...)
+					{
+						errors[i] = std::current_exception();
+					}
+				};
+				try
+				{
+					for(std::size_t i = 1; i < chunks; ++i)
+						threads.emplace_back(run, i);
+				}
+				catch(...)
+				{
+					// Could not start a thread, do the remaining work here
+					for(auto i = threads.size() + 1; i < chunks; ++i)
+						run(i);
+				}
+				run(0);
+				for(auto& t : threads)
+					t.join();
+				for(auto& e : errors)
+					if(e)
+						std::rethrow_exception(e);
+				return chunks;
+			}
+		}
+	}
+}
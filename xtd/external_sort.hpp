@@ -0,0 +1,236 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+/**
+ \file
+ Sorting files of fixed size records which do not fit in memory.
+
+ The input is read in parts filling the memory budget, each part is sorted on multiple threads and written to a temporary run file. The runs are then merged into the output with `kway_merger`, in several passes if there are more runs than can be merged at once. All files are accessed with `direct_reader` and `direct_writer`, so reading the next buffer of every run and writing the previous buffer of the output overlap with merging and the sort does not flood the page cache.
+
+ ~~~cpp
+ struct record { std::uint64_t key; std::uint64_t value; };
+ xtd::external_sort_options opts;
+ opts.memory = std::size_t(16) << 30;
+ opts.temp_prefix = "/scratch/records";
+ xtd::external_sort<record>("records.bin", "sorted.bin", [] (const record& a, const record& b) { return a.key < b.key; }, opts);
+ ~~~
+
+ \author Miro Knejp
+ */
+
+#pragma once
+
+#include <xtd/algorithm.hpp>
+#include <xtd/array_view.hpp>
+#include <xtd/direct_io.hpp>
+#include <xtd/execution.hpp>
+#include <xtd/finally.hpp>
+#include <xtd/kway_merge.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace xtd
+{
+	/// Configuration of external_sort.
+	struct external_sort_options
+	{
+		/// Memory for records in bytes. Runs fill half of it, the other half being the temporary buffer of the in-memory sort. A merge divides it among the buffers of its runs and the output.
+		std::size_t memory = std::size_t(1) << 30;
+		/// Maximum number of runs merged at once. If there are more, groups of runs are merged into new runs first.
+		std::size_t fan_in = 256;
+		/// Path prefix of the temporary run files, which are named `prefix.0`, `prefix.1` and so on. Defaults to the output path followed by `.run`.
+		std::string temp_prefix;
+		/// Threads sorting the runs in memory.
+		execution::parallel_policy policy;
+		/// Configuration of file access. Merges use at most `io.buffer_size` per buffer and one I/O thread per file if the thread pool is used.
+		direct_io_options io;
+	};
+
+	/**
+	 Sort the file at `input` of trivially copyable records of type `T` with `comp` into the file at `output`, using bounded memory and temporary files.
+
+	 Returns the number of records. Numbers compared with `std::less` are sorted in memory with `radix_sort`, everything else with `parallel_sort`. The sort is not stable. Temporary files are removed when they are merged and on failure.
+
+	 \throws std::system_error if a file cannot be opened, read or written.
+	 \throws std::runtime_error if the size of `input` is not a multiple of `sizeof(T)`.
+	 */
+	template<class T, class Compare = std::less<>>
+	std::uint64_t external_sort(const std::string& input, const std::string& output, Compare comp = {}, const external_sort_options& opts = {});
+}
+
+////////////////////////////////////////////////////////////////////////
+// Private parts, do not look.
+//
+
+namespace xtd
+{
+	namespace detail
+	{
+		namespace external_sort
+		{
+			// Whether radix_sort produces the order of Compare
+			template<class T, class Compare>
+			struct UseRadix : std::false_type { };
+			template<class T>
+			struct UseRadix<T, std::less<>> : xtd::detail::algorithm::RadixKey<T> { };
+			template<class T>
+			struct UseRadix<T, std::less<T>> : xtd::detail::algorithm::RadixKey<T> { };
+
+			template<class T, class Compare>
+			void sort(const xtd::execution::parallel_policy& policy, array_view<T> records, Compare& comp, std::true_type /* radix */)
+			{
+				(void)comp;
+				xtd::radix_sort(policy, records);
+			}
+			template<class T, class Compare>
+			void sort(const xtd::execution::parallel_policy& policy, array_view<T> records, Compare& comp, std::false_type /* radix */)
+			{
+				xtd::parallel_sort(policy, records, comp);
+			}
+
+			template<class T>
+			array_view<unsigned char> bytes(T* records, std::size_t n) noexcept
+			{
+				return {reinterpret_cast<unsigned char*>(records), n * sizeof(T)};
+			}
+
+			template<class T>
+			void write(const std::string& path, const T* records, std::size_t n, const direct_io_options& io)
+			{
+				direct_writer out{path, io};
+				out.write({reinterpret_cast<const unsigned char*>(records), n * sizeof(T)});
+				out.close();
+			}
+
+			// A run file read in blocks of whole records while the next part is read ahead
+			template<class T>
+			class RunReader
+			{
+			public:
+				RunReader(const std::string& path, std::size_t block, const direct_io_options& io)
+				: _file(path, io)
+				, _buffer(std::max<std::size_t>(block / sizeof(T), 1))
+				{ }
+
+				array_view<const T> next()
+				{
+					auto n = _file.read(bytes(_buffer.data(), _buffer.size()));
+					if(n % sizeof(T) != 0)
+						throw std::runtime_error{"xtd::external_sort: truncated run file."};
+					return {_buffer.data(), n / sizeof(T)};
+				}
+
+			private:
+				direct_reader _file;
+				std::vector<T> _buffer;
+			};
+
+			// Neither direct_reader nor RunReader can be moved into the vector kway_merger takes
+			template<class T>
+			struct RunHandle
+			{
+				RunReader<T>* reader;
+				array_view<const T> next() { return reader->next(); }
+			};
+
+			template<class T, class Compare>
+			void merge(const std::vector<std::string>& runs, const std::string& output, const Compare& comp, const xtd::external_sort_options& opts)
+			{
+				// Every run and the output get an equal share, a third of it for each buffer
+				auto share = opts.memory / (runs.size() + 1) / 3;
+				auto io = opts.io;
+				io.buffer_size = std::min(opts.io.buffer_size, std::max(share, opts.io.alignment));
+				io.io.threads = 1;
+
+				std::vector<std::unique_ptr<RunReader<T>>> readers;
+				std::vector<RunHandle<T>> handles;
+				for(auto& run : runs)
+				{
+					readers.push_back(std::make_unique<RunReader<T>>(run, share, io));
+					handles.push_back({readers.back().get()});
+				}
+				kway_merger<T, Compare> merger{handles, comp};
+				direct_writer out{output, io};
+				std::vector<T> buffer(std::max<std::size_t>(share / sizeof(T), 1));
+				while(auto n = merger.read({buffer.data(), buffer.size()}))
+					out.write(bytes(buffer.data(), n));
+				out.close();
+			}
+		}
+	}
+}
+
+template<class T, class Compare>
+std::uint64_t xtd::external_sort(const std::string& input, const std::string& output, Compare comp, const external_sort_options& opts)
+{
+	static_assert(std::is_trivially_copyable<T>::value, "xtd::external_sort: Only trivially copyable records can be sorted in files.");
+	namespace ns = detail::external_sort;
+
+	auto prefix = opts.temp_prefix.empty() ? output + ".run" : opts.temp_prefix;
+	std::vector<std::string> temporaries;
+	XTD_FINALLY
+	{
+		for(auto& path : temporaries)
+			std::remove(path.c_str());
+	};
+	auto temporary = [&]
+	{
+		temporaries.push_back(prefix + "." + std::to_string(temporaries.size()));
+		return temporaries.back();
+	};
+
+	// Sorted runs of as many records as fit in half the memory
+	std::vector<std::string> runs;
+	std::uint64_t count;
+	{
+		direct_reader in{input, opts.io};
+		if(in.size() % sizeof(T) != 0)
+			throw std::runtime_error{"xtd::external_sort: The input size is not a multiple of the record size."};
+		count = in.size() / sizeof(T);
+		std::vector<T> records(static_cast<std::size_t>(std::min<std::uint64_t>(std::max<std::size_t>(opts.memory / (2 * sizeof(T)), 1), count)));
+		auto remaining = count;
+		do
+		{
+			auto n = static_cast<std::size_t>(std::min<std::uint64_t>(records.size(), remaining));
+			if(in.read(ns::bytes(records.data(), n)) != n * sizeof(T))
+				throw std::runtime_error{"xtd::external_sort: The input was truncated while sorting."};
+			ns::sort(opts.policy, array_view<T>{records.data(), n}, comp, ns::UseRadix<T, Compare>{});
+			remaining -= n;
+			if(remaining == 0 && runs.empty())
+			{
+				// Everything fit in memory
+				ns::write(output, records.data(), n, opts.io);
+				return count;
+			}
+			runs.push_back(temporary());
+			ns::write(runs.back(), records.data(), n, opts.io);
+		}
+		while(remaining > 0);
+	}
+
+	// Merge the first runs into one until the rest can be merged at once, removing them right away to bound the disk space
+	auto fan_in = std::max<std::size_t>(opts.fan_in, 2);
+	while(runs.size() > fan_in)
+	{
+		auto group = std::min(fan_in, runs.size() - fan_in + 1);
+		std::vector<std::string> merged(runs.begin(), runs.begin() + static_cast<std::ptrdiff_t>(group));
+		runs.erase(runs.begin(), runs.begin() + static_cast<std::ptrdiff_t>(group));
+		runs.push_back(temporary());
+		ns::merge<T>(merged, runs.back(), comp, opts);
+		for(auto& path : merged)
+			std::remove(path.c_str());
+	}
+	ns::merge<T>(runs, output, comp, opts);
+	return count;
+}
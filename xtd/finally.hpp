@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include <utility>
+
 namespace xtd
 {
 	namespace detail
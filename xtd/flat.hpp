@@ -0,0 +1,613 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+/**
+ \file
+ A zero-copy binary format whose messages are read in place without parsing or allocation.
+
+ Messages are plain standard-layout structs (called tables) made of trivially copyable members and the field types `flat::ref`, `flat::string` and `flat::vector`. These field types store a 32 bit offset relative to their own address, so a buffer remains valid wherever it is located in memory, for example after mapping a file with `mmap`. Reading a field is a direct member access, strings and vectors are exposed as `string_view` and `array_view` referring into the buffer.
+
+ Because their offsets are relative to their own address, field types cannot be copied or moved and neither can the tables containing them. They are only ever accessed by reference in the buffer, so write `auto& host = endpoint.host;` and `for(auto& s : config.names)`.
+
+ Tables expose their members through a `tie()` member function (the same as for `xtd::serialize`), which is used by `flat::verify` to check untrusted buffers before they are accessed.
+
+ ~~~cpp
+ struct Endpoint
+ {
+     std::uint16_t port;
+     xtd::flat::string host;
+
+     auto tie() { return std::tie(port, host); }
+ };
+ struct Config
+ {
+     std::uint32_t version;
+     xtd::flat::vector<Endpoint> endpoints;
+     xtd::flat::ref<Endpoint> fallback;
+
+     auto tie() { return std::tie(version, endpoints, fallback); }
+ };
+
+ // Writing
+ xtd::flat::builder b;
+ auto host = b.create_string("localhost");
+ auto config = b.create<Config>();
+ auto endpoints = b.create_vector<Endpoint>(2);
+ b.get(endpoints, 0).port = 80;
+ b.set(endpoints, 0, &Endpoint::host, host);
+ b.get(config).version = 3;
+ b.set(config, &Config::endpoints, endpoints);
+ b.finish(config);
+ write_file(b.data());
+
+ // Reading
+ auto buffer = map_file();
+ if(!xtd::flat::verify<Config>(buffer))
+     throw corrupt_config{};
+ const Config& c = xtd::flat::root<Config>(buffer);
+ for(auto& e : c.endpoints)
+     connect(e.host, e.port);
+ ~~~
+
+ Buffers use native byte order and must be aligned to `flat::buffer_alignment` when read.
+
+ \author Miro Knejp
+ */
+
+#pragma once
+
+#include <xtd/array_view.hpp>
+#include <xtd/memory.hpp>
+#include <xtd/string_view.hpp>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace xtd
+{
+	namespace flat
+	{
+		/// The alignment buffers must satisfy to be read.
+		constexpr std::size_t buffer_alignment = alignof(std::max_align_t);
+
+		template<class T>
+		class ref;
+		class string;
+		template<class T>
+		class vector;
+
+		template<class T>
+		class offset;
+
+		class builder;
+
+		/**
+		 Check whether `buffer` contains a well-formed message with a root of type `T`.
+
+		 All offsets are checked to point inside the buffer at properly aligned locations, strings to be null-terminated and vectors to fit the buffer. Tables are checked recursively through their `tie()` members. References nested deeper than `max_depth` fail verification, which protects against cycles.
+
+		 Objects referenced more than once are checked every time they are reached, so references shared across levels can multiply the work exponentially without exceeding `max_depth`. Verification therefore also fails after visiting more than `max_objects` tables, strings and vectors, or as many as the buffer has bytes if it is zero.
+		 */
+		template<class T>
+		bool verify(array_view<const unsigned char> buffer, std::size_t max_depth = 64, std::size_t max_objects = 0) noexcept;
+
+		/**
+		 Access the root table of a message.
+
+		 The buffer is not checked, use `verify` first for untrusted input.
+		 */
+		template<class T>
+		const T& root(array_view<const unsigned char> buffer) noexcept;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////
+// Private parts, do not look.
+//
+
+namespace xtd
+{
+	namespace detail
+	{
+		namespace flat
+		{
+			template<class T, class = void>
+			struct HasTie : std::false_type { };
+			template<class T>
+			struct HasTie<T, decltype(void(std::declval<T&>().tie()))> : std::true_type { };
+
+			// Resolve a self-relative offset stored at p
+			template<class T>
+			const T* resolve(const std::int32_t* p) noexcept
+			{
+				return *p == 0 ? nullptr : reinterpret_cast<const T*>(reinterpret_cast<const unsigned char*>(p) + *p);
+			}
+
+			// Byte distance from a vector's element count to its first element
+			template<class T>
+			constexpr std::size_t vector_header() noexcept
+			{
+				return alignof(T) > sizeof(std::uint32_t) ? alignof(T) : sizeof(std::uint32_t);
+			}
+
+			class Verifier;
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////
+// Field types
+//
+
+/// A field referring to a table of type `T` elsewhere in the buffer, or to nothing.
+template<class T>
+class xtd::flat::ref
+{
+public:
+	/// The type returned by `builder` for objects this field can refer to.
+	using target = offset<T>;
+
+	ref(const ref&) = delete;
+	ref& operator=(const ref&) = delete;
+
+	/// Get a pointer to the referenced table or `nullptr` if there is none.
+	const T* get() const noexcept { return detail::flat::resolve<T>(&_offset); }
+	const T& operator*() const noexcept { assert(get() && "xtd::flat::ref is null."); return *get(); }
+	const T* operator->() const noexcept { return &**this; }
+	/// Check whether the field refers to a table.
+	explicit operator bool() const noexcept { return _offset != 0; }
+
+private:
+	friend class builder;
+	friend class detail::flat::Verifier;
+
+	std::int32_t _offset;
+};
+
+/// A field referring to a null-terminated string elsewhere in the buffer, which is empty if not set.
+class xtd::flat::string
+{
+public:
+	/// The type returned by `builder` for objects this field can refer to.
+	using target = offset<string>;
+
+	string(const string&) = delete;
+	string& operator=(const string&) = delete;
+
+	/// Get a view of the string's characters, not including the null terminator.
+	xtd::string_view view() const noexcept
+	{
+		auto length = detail::flat::resolve<std::uint32_t>(&_offset);
+		if(!length)
+			return {"", 0};
+		return {reinterpret_cast<const char*>(length + 1), *length};
+	}
+	operator xtd::string_view() const noexcept { return view(); }
+	/// Get the null-terminated string.
+	const char* c_str() const noexcept { return view().data(); }
+	std::size_t size() const noexcept { return view().size(); }
+	bool empty() const noexcept { return size() == 0; }
+
+private:
+	friend class builder;
+	friend class detail::flat::Verifier;
+
+	std::int32_t _offset;
+};
+
+/// A field referring to an array of `T` elsewhere in the buffer, which is empty if not set.
+template<class T>
+class xtd::flat::vector
+{
+public:
+	/// The type returned by `builder` for objects this field can refer to.
+	using target = offset<vector<T>>;
+	using value_type = T;
+	using const_iterator = const T*;
+
+	vector(const vector&) = delete;
+	vector& operator=(const vector&) = delete;
+
+	/// Get a view of the elements.
+	array_view<const T> view() const noexcept
+	{
+		auto count = detail::flat::resolve<std::uint32_t>(&_offset);
+		if(!count)
+			return {};
+		return {reinterpret_cast<const T*>(reinterpret_cast<const unsigned char*>(count) + detail::flat::vector_header<T>()), *count};
+	}
+	operator array_view<const T>() const noexcept { return view(); }
+	std::size_t size() const noexcept { return view().size(); }
+	bool empty() const noexcept { return size() == 0; }
+	const T& operator[](std::size_t i) const noexcept { return view()[i]; }
+	const_iterator begin() const noexcept { return view().begin(); }
+	const_iterator end() const noexcept { return view().end(); }
+
+private:
+	friend class builder;
+	friend class detail::flat::Verifier;
+
+	std::int32_t _offset;
+};
+
+/// Identifies an object of type `T` created by `builder`. Stays valid when the builder's buffer grows.
+template<class T>
+class xtd::flat::offset
+{
+public:
+	/// Byte position of the object in the builder's buffer.
+	std::size_t position() const noexcept { return _position; }
+
+private:
+	friend class builder;
+
+	explicit offset(std::size_t position) noexcept : _position(position) { }
+
+	std::size_t _position;
+};
+
+////////////////////////////////////////////////////////////////////////
+// builder
+//
+
+/**
+ Builds a message in a contiguous, growing arena.
+
+ Objects are created zero-initialized, so unset references are null and unset strings and vectors empty. References returned by `get` are invalidated by subsequent `create*` calls, use the `offset` handles to refer to objects across them.
+ */
+class xtd::flat::builder
+{
+public:
+	/// Start a new message, reserving `capacity` bytes.
+	explicit builder(std::size_t capacity = 1024)
+	{
+		_buffer.reserve(capacity);
+		_buffer.resize(sizeof(std::uint32_t)); // Root position
+	}
+
+	/// Create a zero-initialized table or other standard-layout object.
+	template<class T>
+	offset<T> create()
+	{
+		static_assert(std::is_standard_layout<T>::value && std::is_trivially_destructible<T>::value, "xtd::flat::builder: Only trivially destructible standard-layout types can be stored.");
+		static_assert(alignof(T) <= buffer_alignment, "xtd::flat::builder: Over-aligned types are not supported.");
+		return offset<T>{allocate(sizeof(T), alignof(T))};
+	}
+
+	/// Create a string.
+	offset<string> create_string(xtd::string_view str)
+	{
+		auto pos = allocate(sizeof(std::uint32_t) + str.size() + 1, alignof(std::uint32_t));
+		auto length = check_size(str.size());
+		std::memcpy(&_buffer[pos], &length, sizeof(length));
+		std::memcpy(&_buffer[pos + sizeof(length)], str.data(), str.size());
+		return offset<string>{pos};
+	}
+
+	/// Create a vector of `count` zero-initialized elements, to be filled in using `get` and `set`.
+	template<class T>
+	offset<vector<T>> create_vector(std::size_t count)
+	{
+		static_assert(std::is_standard_layout<T>::value && std::is_trivially_destructible<T>::value, "xtd::flat::builder: Only trivially destructible standard-layout types can be stored.");
+		static_assert(alignof(T) <= buffer_alignment, "xtd::flat::builder: Over-aligned types are not supported.");
+		constexpr auto header = detail::flat::vector_header<T>();
+		auto size = check_size(count);
+		if(count > (std::numeric_limits<std::size_t>::max() - header) / (sizeof(T) ? sizeof(T) : 1))
+			throw std::length_error{"xtd::flat::builder: vector too large."};
+		auto pos = allocate(header + count * sizeof(T), header);
+		std::memcpy(&_buffer[pos], &size, sizeof(size));
+		return offset<vector<T>>{pos};
+	}
+
+	/// Create a vector copying the given elements, which must not be tables or field types.
+	template<class T>
+	offset<vector<std::remove_const_t<T>>> create_vector(array_view<T> items)
+	{
+		using U = std::remove_const_t<T>;
+		static_assert(!detail::flat::HasTie<U>::value, "xtd::flat::builder: Tables cannot be copied into a buffer, create a vector of refs instead.");
+		static_assert(std::is_trivially_copyable<U>::value, "xtd::flat::builder: Only trivially copyable elements can be copied into a buffer.");
+		auto v = create_vector<U>(items.size());
+		if(!items.empty())
+			std::memcpy(get(v).data(), items.data(), items.size() * sizeof(U));
+		return v;
+	}
+
+	/// Create a vector of references to the given tables.
+	template<class T>
+	offset<vector<ref<T>>> create_vector(array_view<const offset<T>> items)
+	{
+		auto v = create_vector<ref<T>>(items.size());
+		for(std::size_t i = 0; i < items.size(); ++i)
+			link(element_position(v, i), items[i].position());
+		return v;
+	}
+
+	/// Create a vector of the given strings.
+	offset<vector<string>> create_vector(array_view<const offset<string>> items)
+	{
+		auto v = create_vector<string>(items.size());
+		for(std::size_t i = 0; i < items.size(); ++i)
+			link(element_position(v, i), items[i].position());
+		return v;
+	}
+
+	/// Access an object for modification. The reference is invalidated by the next `create*` call.
+	template<class T>
+	T& get(offset<T> obj) noexcept
+	{
+		return *reinterpret_cast<T*>(&_buffer[obj.position()]);
+	}
+
+	/// Access the elements of a vector for modification. The view is invalidated by the next `create*` call.
+	template<class T>
+	array_view<T> get(offset<vector<T>> v) noexcept
+	{
+		std::uint32_t count;
+		std::memcpy(&count, &_buffer[v.position()], sizeof(count));
+		return {reinterpret_cast<T*>(&_buffer[v.position() + detail::flat::vector_header<T>()]), count};
+	}
+
+	/// Access an element of a vector for modification. The reference is invalidated by the next `create*` call.
+	template<class T>
+	T& get(offset<vector<T>> v, std::size_t index) noexcept
+	{
+		return *reinterpret_cast<T*>(&_buffer[element_position(v, index)]);
+	}
+
+	/// Point the reference, string or vector field `member` of the table `obj` to `target`.
+	template<class T, class Field>
+	void set(offset<T> obj, Field T::* member, typename Field::target target)
+	{
+		link(obj.position() + member_offset(member), target.position());
+	}
+
+	/// Point the reference, string or vector field `member` of the table at `index` in the vector `v` to `target`.
+	template<class T, class Field>
+	void set(offset<vector<T>> v, std::size_t index, Field T::* member, typename Field::target target)
+	{
+		link(element_position(v, index) + member_offset(member), target.position());
+	}
+
+	/// Point the reference, string or vector at `index` in the vector `v` to `target`.
+	template<class Field>
+	void set(offset<vector<Field>> v, std::size_t index, typename Field::target target)
+	{
+		link(element_position(v, index), target.position());
+	}
+
+	/// Complete the message with `root` as its root table.
+	template<class T>
+	void finish(offset<T> root)
+	{
+		auto pos = check_size(root.position());
+		std::memcpy(&_buffer[0], &pos, sizeof(pos));
+	}
+
+	/// The message built so far.
+	array_view<const unsigned char> data() const noexcept
+	{
+		return {_buffer.data(), _buffer.size()};
+	}
+	/// Take ownership of the message and start a new one.
+	std::vector<unsigned char> release()
+	{
+		auto result = std::move(_buffer);
+		_buffer.assign(sizeof(std::uint32_t), 0);
+		return result;
+	}
+
+private:
+	static std::uint32_t check_size(std::size_t n)
+	{
+		if(n > static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max()))
+			throw std::length_error{"xtd::flat::builder: message too large."};
+		return static_cast<std::uint32_t>(n);
+	}
+
+	std::size_t allocate(std::size_t size, std::size_t alignment)
+	{
+		auto pos = align_up(_buffer.size(), alignment);
+		check_size(pos + size);
+		_buffer.resize(pos + size);
+		return pos;
+	}
+
+	template<class T, class Field>
+	std::size_t member_offset(Field T::* member) const noexcept
+	{
+		// Equivalent to offsetof for the standard-layout tables used here
+		alignas(T) unsigned char storage[sizeof(T)];
+		auto obj = reinterpret_cast<const T*>(storage);
+		return static_cast<std::size_t>(reinterpret_cast<const unsigned char*>(&(obj->*member)) - storage);
+	}
+
+	template<class T>
+	std::size_t element_position(offset<vector<T>> v, std::size_t index) const noexcept
+	{
+		return v.position() + detail::flat::vector_header<T>() + index * sizeof(T);
+	}
+
+	void link(std::size_t field, std::size_t target) noexcept
+	{
+		auto offset = static_cast<std::int32_t>(static_cast<std::ptrdiff_t>(target) - static_cast<std::ptrdiff_t>(field));
+		std::memcpy(&_buffer[field], &offset, sizeof(offset));
+	}
+
+	std::vector<unsigned char> _buffer;
+};
+
+////////////////////////////////////////////////////////////////////////
+// Verification
+//
+
+class xtd::detail::flat::Verifier
+{
+public:
+	Verifier(array_view<const unsigned char> buffer, std::size_t max_depth, std::size_t max_objects) noexcept
+	: _begin(buffer.data())
+	, _end(buffer.data() + buffer.size())
+	, _depth(max_depth)
+	, _objects(max_objects)
+	{
+	}
+
+	// Check that an object of type T fits at p
+	template<class T>
+	bool contains(const void* p, std::size_t size = sizeof(T), std::size_t alignment = alignof(T)) const noexcept
+	{
+		auto q = static_cast<const unsigned char*>(p);
+		return q >= _begin && q <= _end && size <= static_cast<std::size_t>(_end - q) && is_aligned(q, alignment);
+	}
+
+	// Verify a table in place
+	template<class T>
+	bool table(const T& obj) noexcept
+	{
+		if(_depth == 0 || !visit())
+			return false;
+		--_depth;
+		auto t = const_cast<T&>(obj).tie();
+		auto ok = fields(t, std::make_index_sequence<std::tuple_size<decltype(t)>::value>{});
+		++_depth;
+		return ok;
+	}
+
+	template<class T>
+	bool field(const T& x) noexcept
+	{
+		return field(x, HasTie<T>{});
+	}
+	template<class T>
+	bool field(const xtd::flat::ref<T>& r) noexcept
+	{
+		if(!r)
+			return true;
+		if(!valid_offset(r._offset))
+			return false;
+		auto p = r.get();
+		return contains<T>(p) && field(*p);
+	}
+	bool field(const xtd::flat::string& s) noexcept
+	{
+		if(s._offset == 0)
+			return true;
+		if(!visit() || !valid_offset(s._offset))
+			return false;
+		auto length = resolve<std::uint32_t>(&s._offset);
+		if(!contains<std::uint32_t>(length))
+			return false;
+		auto chars = reinterpret_cast<const unsigned char*>(length + 1);
+		return *length < static_cast<std::size_t>(_end - chars) && chars[*length] == 0;
+	}
+	template<class T>
+	bool field(const xtd::flat::vector<T>& v) noexcept
+	{
+		if(v._offset == 0)
+			return true;
+		if(!visit() || !valid_offset(v._offset))
+			return false;
+		auto count = resolve<std::uint32_t>(&v._offset);
+		if(!contains<T>(count, vector_header<T>(), vector_header<T>()))
+			return false;
+		auto data = reinterpret_cast<const unsigned char*>(count) + vector_header<T>();
+		if(*count > static_cast<std::size_t>(_end - data) / (sizeof(T) ? sizeof(T) : 1))
+			return false;
+		return elements(reinterpret_cast<const T*>(data), *count, NeedsCheck<T>{});
+	}
+
+private:
+	// Whether values of T contain offsets which need checking
+	template<class T>
+	struct NeedsCheck : HasTie<T> { };
+	template<class T>
+	struct NeedsCheck<xtd::flat::ref<T>> : std::true_type { };
+	template<class T>
+	struct NeedsCheck<xtd::flat::vector<T>> : std::true_type { };
+
+	template<class Tuple, std::size_t... I>
+	bool fields(const Tuple& t, std::index_sequence<I...>) noexcept
+	{
+		bool results[] = { true, field(static_cast<const std::decay_t<std::tuple_element_t<I, Tuple>>&>(std::get<I>(t)))... };
+		for(auto ok : results)
+			if(!ok)
+				return false;
+		return true;
+	}
+
+	template<class T>
+	bool field(const T& x, std::true_type) noexcept { return table(x); }
+	template<class T>
+	bool field(const T&, std::false_type) noexcept { return true; }
+
+	template<class T>
+	bool elements(const T* p, std::size_t n, std::true_type) noexcept
+	{
+		for(std::size_t i = 0; i < n; ++i)
+			if(!field(p[i]))
+				return false;
+		return true;
+	}
+	bool elements(const xtd::flat::string* p, std::size_t n, std::false_type) noexcept
+	{
+		for(std::size_t i = 0; i < n; ++i)
+			if(!field(p[i]))
+				return false;
+		return true;
+	}
+	template<class T>
+	bool elements(const T*, std::size_t, std::false_type) noexcept { return true; }
+
+	// Charge one object against the budget
+	bool visit() noexcept
+	{
+		if(_objects == 0)
+			return false;
+		--_objects;
+		return true;
+	}
+
+	bool valid_offset(std::int32_t offset) const noexcept
+	{
+		// Rules out wrap-around before pointers are compared
+		return offset != std::numeric_limits<std::int32_t>::min() && static_cast<std::size_t>(offset < 0 ? -offset : offset) <= static_cast<std::size_t>(_end - _begin);
+	}
+
+	const unsigned char* _begin;
+	const unsigned char* _end;
+	std::size_t _depth;
+	std::size_t _objects; // Remaining visits
+};
+
+template<class T>
+bool xtd::flat::verify(array_view<const unsigned char> buffer, std::size_t max_depth, std::size_t max_objects) noexcept
+{
+	static_assert(detail::flat::HasTie<T>::value, "xtd::flat::verify: The root type must provide tie().");
+	detail::flat::Verifier verifier{buffer, max_depth, max_objects != 0 ? max_objects : buffer.size()};
+	if(!verifier.contains<std::uint32_t>(buffer.data()))
+		return false;
+	std::uint32_t pos;
+	std::memcpy(&pos, buffer.data(), sizeof(pos));
+	if(pos > buffer.size())
+		return false;
+	auto p = buffer.data() + pos;
+	return verifier.contains<T>(p) && verifier.table(*reinterpret_cast<const T*>(p));
+}
+
+template<class T>
+const T& xtd::flat::root(array_view<const unsigned char> buffer) noexcept
+{
+	assert(buffer.size() >= sizeof(std::uint32_t) && "xtd::flat::root: buffer too short.");
+	std::uint32_t pos;
+	std::memcpy(&pos, buffer.data(), sizeof(pos));
+	return *reinterpret_cast<const T*>(buffer.data() + pos);
+}
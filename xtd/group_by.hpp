@@ -0,0 +1,345 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+/**
+ \file
+ Grouping a column of values by a column of keys and aggregating each group.
+
+ Groups are looked up in an open addressing hash table storing a 7 bit tag of each key's hash in a control byte per slot. Slots are probed 16 at a time by comparing their control bytes with SSE2, so most lookups compare a single key and the aggregates live in one array without an allocation per group.
+
+ The parallel overload first partitions the rows by the top bits of their hash into several partitions per thread, the same way `radix_sort` moves elements: every thread counts its part of the rows per partition, then moves them to positions derived from all counts. Each partition then has its own keys, and its much smaller table is built by one thread while staying in cache.
+
+ ~~~cpp
+ std::vector<std::uint32_t> customer = ...;
+ std::vector<double> amount = ...;
+ auto totals = xtd::group_by(xtd::execution::par, customer, amount);
+ for(std::size_t i = 0; i < totals.size(); ++i)
+     std::cout << totals.keys[i] << ": " << totals.sums[i] << " in " << totals.counts[i] << " orders, " << totals.mean(i) << " on average\n";
+ ~~~
+
+ \author Miro Knejp
+ */
+
+#pragma once
+
+#include <xtd/algorithm.hpp>
+#include <xtd/execution.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace xtd
+{
+	/// The type in which values of type `T` are summed: `double` for floating point, 64 bit integers of the same signedness otherwise.
+	template<class T>
+	using group_sum_t = std::conditional_t<std::is_floating_point<T>::value, double, std::conditional_t<std::is_signed<T>::value, std::int64_t, std::uint64_t>>;
+
+	/**
+	 The aggregates of the groups found by `group_by`, in columns of equal size.
+
+	 Element `i` of every column belongs to the group of `keys[i]`. The order of the groups is unspecified.
+	 */
+	template<class Key, class Value>
+	struct group_aggregates
+	{
+		using sum_type = group_sum_t<Value>;
+
+		std::vector<Key> keys;
+		std::vector<std::uint64_t> counts;
+		std::vector<sum_type> sums;
+		std::vector<Value> mins;
+		std::vector<Value> maxs;
+
+		/// The number of groups.
+		std::size_t size() const noexcept { return keys.size(); }
+		/// The mean of the values of group `i`.
+		double mean(std::size_t i) const noexcept { return static_cast<double>(sums[i]) / static_cast<double>(counts[i]); }
+	};
+
+	/**
+	 Group the contiguous column `values` by the contiguous column `keys` of the same size and compute the count, sum, minimum and maximum of each group.
+
+	 Keys are compared with `operator==` and hashed with `std::hash`. Values must be arithmetic. A NaN value is counted and summed, but only becomes a minimum or maximum if it is the first value of its group.
+	 */
+	template<class KeyRange, class ValueRange>
+	group_aggregates<detail::algorithm::contiguous_value_t<KeyRange>, detail::algorithm::contiguous_value_t<ValueRange>> group_by(const KeyRange& keys, const ValueRange& values);
+	/// \copydoc group_by
+	template<class KeyRange, class ValueRange>
+	group_aggregates<detail::algorithm::contiguous_value_t<KeyRange>, detail::algorithm::contiguous_value_t<ValueRange>> group_by(const execution::parallel_policy& policy, const KeyRange& keys, const ValueRange& values);
+}
+
+////////////////////////////////////////////////////////////////////////
+// Private parts, do not look.
+//
+
+namespace xtd
+{
+	namespace detail
+	{
+		namespace group_by
+		{
+			// Rows per thread worth partitioning
+			constexpr std::size_t group_by_grain = 1 << 16;
+			// Partitions per thread, so threads finishing early take more
+			constexpr std::size_t partitions_per_thread = 4;
+
+			// std::hash of integers is often the identity, the tag and the position need well mixed bits
+			template<class Key>
+			std::uint64_t hash(const Key& key)
+			{
+				std::uint64_t h = std::hash<Key>{}(key);
+				h ^= h >> 33;
+				h *= 0xFF51AFD7ED558CCDull;
+				h ^= h >> 33;
+				h *= 0xC4CEB9FE1A85EC53ull;
+				h ^= h >> 33;
+				return h;
+			}
+
+			inline unsigned count_trailing_zeros(std::uint32_t x) noexcept
+			{
+#if defined(__GNUC__) || defined(__clang__)
+				return static_cast<unsigned>(__builtin_ctz(x));
+#else
+				unsigned n = 0;
+				for(; (x & 1) == 0; x >>= 1)
+					++n;
+				return n;
+#endif
+			}
+
+			constexpr std::size_t group_width = 16;
+			constexpr std::int8_t empty = -128;
+
+			// Bit i is set if control byte i of the group equals tag
+			inline std::uint32_t match(const std::int8_t* group, std::int8_t tag) noexcept
+			{
+#if defined(XTD_ALGORITHM_SSE2)
+				auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+				return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(tag))));
+#else
+				std::uint32_t mask = 0;
+				for(std::size_t i = 0; i < group_width; ++i)
+					mask |= std::uint32_t(group[i] == tag) << i;
+				return mask;
+#endif
+			}
+
+			template<class Key, class Value>
+			struct Group
+			{
+				Key key;
+				Value min;
+				Value max;
+				std::uint64_t count;
+				group_sum_t<Value> sum;
+			};
+
+			// Aggregates in the order groups were first seen, found through an open addressing table of their indices
+			template<class Key, class Value>
+			class Table
+			{
+			public:
+				Table()
+				{
+					rehash(1);
+				}
+
+				void add(const Key& key, const Value& value, std::uint64_t h)
+				{
+					auto tag = static_cast<std::int8_t>(h & 0x7F);
+					for(;;)
+					{
+						auto mask = _ctrl.size() / group_width - 1;
+						for(auto g = static_cast<std::size_t>(h >> 7) & mask;; g = (g + 1) & mask)
+						{
+							auto ctrl = _ctrl.data() + g * group_width;
+							for(auto m = match(ctrl, tag); m != 0; m &= m - 1)
+							{
+								auto& group = _groups[_slots[g * group_width + count_trailing_zeros(m)]];
+								if(group.key == key)
+								{
+									group.min = value < group.min ? value : group.min;
+									group.max = group.max < value ? value : group.max;
+									++group.count;
+									group.sum += value;
+									return;
+								}
+							}
+							auto m = match(ctrl, empty);
+							if(m == 0)
+								continue;
+							// Keep at most 7/8 of the slots occupied so probe sequences stay short
+							if((_groups.size() + 1) * 8 > _ctrl.size() * 7)
+								break;
+							auto slot = g * group_width + count_trailing_zeros(m);
+							if(_groups.size() >= std::numeric_limits<std::uint32_t>::max())
+								throw std::length_error{"xtd::group_by: too many groups."};
+							_ctrl[slot] = tag;
+							_slots[slot] = static_cast<std::uint32_t>(_groups.size());
+							_groups.push_back({key, value, value, 1, group_sum_t<Value>(value)});
+							return;
+						}
+						rehash(_ctrl.size() / group_width * 2);
+					}
+				}
+
+				std::vector<Group<Key, Value>>& groups() noexcept { return _groups; }
+
+			private:
+				void rehash(std::size_t groups)
+				{
+					_ctrl.assign(groups * group_width, empty);
+					_slots.resize(groups * group_width);
+					auto mask = groups - 1;
+					for(std::uint32_t i = 0; i < _groups.size(); ++i)
+					{
+						auto h = hash(_groups[i].key);
+						auto g = static_cast<std::size_t>(h >> 7) & mask;
+						std::uint32_t m;
+						while((m = match(_ctrl.data() + g * group_width, empty)) == 0)
+							g = (g + 1) & mask;
+						auto slot = g * group_width + count_trailing_zeros(m);
+						_ctrl[slot] = static_cast<std::int8_t>(h & 0x7F);
+						_slots[slot] = i;
+					}
+				}
+
+				std::vector<std::int8_t> _ctrl; // The tag of the occupying group or empty, for a power of two number of groups of 16 slots
+				std::vector<std::uint32_t> _slots; // Index into _groups of each occupied slot
+				std::vector<Group<Key, Value>> _groups;
+			};
+
+			template<class Key, class Value>
+			void append(xtd::group_aggregates<Key, Value>& result, const std::vector<Group<Key, Value>>& groups)
+			{
+				for(auto& group : groups)
+				{
+					result.keys.push_back(group.key);
+					result.counts.push_back(group.count);
+					result.sums.push_back(group.sum);
+					result.mins.push_back(group.min);
+					result.maxs.push_back(group.max);
+				}
+			}
+
+			template<class Key, class Value>
+			void reserve(xtd::group_aggregates<Key, Value>& result, std::size_t n)
+			{
+				result.keys.reserve(n);
+				result.counts.reserve(n);
+				result.sums.reserve(n);
+				result.mins.reserve(n);
+				result.maxs.reserve(n);
+			}
+
+			template<class Key, class Value>
+			xtd::group_aggregates<Key, Value> group_by(const Key* keys, const Value* values, std::size_t n)
+			{
+				Table<Key, Value> table;
+				for(std::size_t i = 0; i < n; ++i)
+					table.add(keys[i], values[i], hash(keys[i]));
+				xtd::group_aggregates<Key, Value> result;
+				reserve(result, table.groups().size());
+				append(result, table.groups());
+				return result;
+			}
+
+			template<class Key, class Value>
+			xtd::group_aggregates<Key, Value> group_by(const xtd::execution::parallel_policy& policy, const Key* keys, const Value* values, std::size_t n)
+			{
+				if(n < 2 * group_by_grain || policy.concurrency() == 1)
+					return group_by(keys, values, n);
+
+				unsigned bits = 0;
+				while((std::size_t(1) << bits) < policy.concurrency() * partitions_per_thread)
+					++bits;
+				const std::size_t partitions = std::size_t(1) << bits;
+				auto partition = [bits] (std::uint64_t h) { return static_cast<std::size_t>(h >> (64 - bits)); };
+
+				// Count the rows of every chunk per partition, then move them to their partition in chunk order
+				std::vector<std::size_t> counts(std::min<std::size_t>(policy.concurrency(), n / group_by_grain) * partitions);
+				auto chunks = detail::execution::parallel_for(policy, n, group_by_grain, [&] (std::size_t chunk, std::size_t first, std::size_t last)
+				{
+					auto c = counts.data() + chunk * partitions;
+					for(auto i = first; i < last; ++i)
+						++c[partition(hash(keys[i]))];
+				});
+				std::vector<std::size_t> bounds(partitions + 1);
+				std::size_t offset = 0;
+				for(std::size_t p = 0; p < partitions; ++p)
+				{
+					bounds[p] = offset;
+					for(std::size_t chunk = 0; chunk < chunks; ++chunk)
+					{
+						auto count = counts[chunk * partitions + p];
+						counts[chunk * partitions + p] = offset;
+						offset += count;
+					}
+				}
+				bounds[partitions] = n;
+				std::vector<Key> partitioned_keys(n);
+				std::vector<Value> partitioned_values(n);
+				detail::execution::parallel_for(policy, n, group_by_grain, [&] (std::size_t chunk, std::size_t first, std::size_t last)
+				{
+					auto c = counts.data() + chunk * partitions;
+					for(auto i = first; i < last; ++i)
+					{
+						auto j = c[partition(hash(keys[i]))]++;
+						partitioned_keys[j] = keys[i];
+						partitioned_values[j] = values[i];
+					}
+				});
+
+				// Partitions have disjoint keys, aggregate them one at a time on every thread
+				std::vector<std::vector<Group<Key, Value>>> groups(partitions);
+				std::atomic<std::size_t> next{0};
+				detail::execution::parallel_for(policy, policy.concurrency(), 1, [&] (std::size_t, std::size_t, std::size_t)
+				{
+					for(auto p = next++; p < partitions; p = next++)
+					{
+						Table<Key, Value> table;
+						for(auto i = bounds[p]; i < bounds[p + 1]; ++i)
+							table.add(partitioned_keys[i], partitioned_values[i], hash(partitioned_keys[i]));
+						groups[p] = std::move(table.groups());
+					}
+				});
+
+				xtd::group_aggregates<Key, Value> result;
+				std::size_t total = 0;
+				for(auto& g : groups)
+					total += g.size();
+				reserve(result, total);
+				for(auto& g : groups)
+					append(result, g);
+				return result;
+			}
+		}
+	}
+}
+
+template<class KeyRange, class ValueRange>
+auto xtd::group_by(const KeyRange& keys, const ValueRange& values) -> group_aggregates<detail::algorithm::contiguous_value_t<KeyRange>, detail::algorithm::contiguous_value_t<ValueRange>>
+{
+	static_assert(std::is_arithmetic<detail::algorithm::contiguous_value_t<ValueRange>>::value, "xtd::group_by: Values must be arithmetic.");
+	assert(keys.size() == values.size() && "xtd::group_by: The key and value columns must have the same size.");
+	return detail::group_by::group_by(keys.data(), values.data(), keys.size());
+}
+
+template<class KeyRange, class ValueRange>
+auto xtd::group_by(const execution::parallel_policy& policy, const KeyRange& keys, const ValueRange& values) -> group_aggregates<detail::algorithm::contiguous_value_t<KeyRange>, detail::algorithm::contiguous_value_t<ValueRange>>
+{
+	static_assert(std::is_arithmetic<detail::algorithm::contiguous_value_t<ValueRange>>::value, "xtd::group_by: Values must be arithmetic.");
+	assert(keys.size() == values.size() && "xtd::group_by: The key and value columns must have the same size.");
+	return detail::group_by::group_by(policy, keys.data(), values.data(), keys.size());
+}
@@ -0,0 +1,363 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+/**
+ \file
+ Merging many sorted runs into one sorted sequence with a loser tree.
+
+ A loser tree over `k` runs holds the current element of every run and, in each inner node, the loser of the comparison played there. Replacing the winner with the next element of its run replays only the path from that run's leaf to the root, a single comparison per level, where a binary heap needs two per level to sift down. The tree is a compact array of run indices next to a copy of each run's current element, so a replay touches no run except the one advancing, and it is played without branches because the outcomes of merging comparisons are unpredictable.
+
+ Runs are either sorted arrays in memory or readers returning consecutive blocks of a run, such as `binary_run_reader` for binary files of records.
+
+ ~~~cpp
+ std::vector<std::ifstream> files = ...; // Sorted runs of records in binary files
+ std::vector<xtd::binary_run_reader<record>> readers;
+ for(auto& f : files)
+     readers.emplace_back(f);
+ xtd::kway_merger<record, by_key> merger{readers};
+ std::vector<record> buffer(1 << 16);
+ while(auto n = merger.read(xtd::make_array_view(buffer.data(), buffer.size())))
+     out.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(n * sizeof(record)));
+ ~~~
+
+ \author Miro Knejp
+ */
+
+#pragma once
+
+#include <xtd/array_view.hpp>
+#include <xtd/execution.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace xtd
+{
+	template<class T>
+	class binary_run_reader;
+	template<class T, class Compare = std::less<>>
+	class kway_merger;
+
+	/**
+	 Merge the sorted `runs` into `out`, returning the number of elements written.
+
+	 `out` must have room for the elements of all runs. The merge is stable: equal elements are written in the order of their runs.
+	 */
+	template<class T, class OutRange, class Compare = std::less<>>
+	std::size_t kway_merge(const std::vector<array_view<const T>>& runs, OutRange&& out, Compare comp = {});
+	/**
+	 Merge the sorted `runs` into `out` on multiple threads, returning the number of elements written.
+
+	 The output is split into one range per thread, and the positions in every run where each range starts are found by multi-sequence selection, which costs `O(k^2 log^2 n)` comparisons per thread for `k` runs of `n` elements. Each thread then merges its parts of the runs independently. The result is the same as that of the sequential overload.
+	 */
+	template<class T, class OutRange, class Compare = std::less<>>
+	std::size_t kway_merge(const execution::parallel_policy& policy, const std::vector<array_view<const T>>& runs, OutRange&& out, Compare comp = {});
+}
+
+////////////////////////////////////////////////////////////////////////
+// Private parts, do not look.
+//
+
+namespace xtd
+{
+	namespace detail
+	{
+		namespace kway_merge
+		{
+			// Output elements per thread worth the cost of multi-sequence selection
+			constexpr std::size_t merge_grain = 1 << 16;
+
+			template<class T>
+			std::size_t total_size(const std::vector<array_view<const T>>& runs) noexcept
+			{
+				std::size_t n = 0;
+				for(auto& run : runs)
+					n += run.size();
+				return n;
+			}
+
+			// The number of elements of each run among the first r elements of the stable merge
+			template<class T, class Compare>
+			std::vector<std::size_t> select(const std::vector<array_view<const T>>& runs, std::size_t r, Compare& comp)
+			{
+				auto k = runs.size();
+				std::vector<std::size_t> lo(k), hi(k), counts(k);
+				for(std::size_t i = 0; i < k; ++i)
+					hi[i] = runs[i].size();
+				if(r == 0)
+					return lo;
+				if(r == total_size(runs))
+					return hi;
+				// Every step halves the widest interval by finding out whether its middle element is among the first r
+				for(;;)
+				{
+					std::size_t j = 0;
+					for(std::size_t i = 1; i < k; ++i)
+						if(hi[i] - lo[i] > hi[j] - lo[j])
+							j = i;
+					if(hi[j] == lo[j])
+						return lo;
+					auto p = lo[j] + (hi[j] - lo[j]) / 2;
+					const T& x = runs[j][p];
+					// Equal elements of earlier runs come first
+					std::size_t rank = 0;
+					for(std::size_t i = 0; i < k; ++i)
+					{
+						auto first = runs[i].begin();
+						auto last = runs[i].end();
+						if(i < j)
+							counts[i] = static_cast<std::size_t>(std::upper_bound(first, last, x, comp) - first);
+						else if(i > j)
+							counts[i] = static_cast<std::size_t>(std::lower_bound(first, last, x, comp) - first);
+						else
+							counts[i] = p;
+						rank += counts[i];
+					}
+					if(rank < r)
+					{
+						for(std::size_t i = 0; i < k; ++i)
+							lo[i] = std::max(lo[i], counts[i]);
+						lo[j] = p + 1;
+					}
+					else
+					{
+						for(std::size_t i = 0; i < k; ++i)
+							hi[i] = std::min(hi[i], counts[i]);
+					}
+				}
+			}
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////
+// binary_run_reader
+//
+
+/**
+ Reads a sorted run of `T` from a binary stream in blocks, as written with `std::ostream::write`.
+
+ `T` must be trivially copyable, but need not be POD. The stream must outlive the reader and should be opened in binary mode.
+ */
+template<class T>
+class xtd::binary_run_reader
+{
+	static_assert(std::is_trivially_copyable<T>::value, "xtd::binary_run_reader: Only trivially copyable types can be read as raw bytes.");
+
+public:
+	/// Read from `in` in blocks of `block` elements, 64 KiB by default.
+	explicit binary_run_reader(std::istream& in, std::size_t block = std::max<std::size_t>((64 << 10) / sizeof(T), 1))
+	: _in(&in)
+	, _buffer(std::max<std::size_t>(block, 1))
+	{ }
+
+	/**
+	 The next block of the run, which is empty at its end.
+
+	 The block stays valid until the next call. Throws `std::ios_base::failure` if reading fails and `std::runtime_error` if the stream ends within an element.
+	 */
+	array_view<const T> next()
+	{
+		if(!*_in)
+			return {};
+		_in->read(reinterpret_cast<char*>(_buffer.data()), static_cast<std::streamsize>(_buffer.size() * sizeof(T)));
+		if(_in->bad())
+			throw std::ios_base::failure{"xtd::binary_run_reader: read error."};
+		auto bytes = static_cast<std::size_t>(_in->gcount());
+		if(bytes % sizeof(T) != 0)
+			throw std::runtime_error{"xtd::binary_run_reader: truncated element."};
+		return {_buffer.data(), bytes / sizeof(T)};
+	}
+
+private:
+	std::istream* _in;
+	std::vector<T> _buffer;
+};
+
+////////////////////////////////////////////////////////////////////////
+// kway_merger
+//
+
+/**
+ Merges sorted runs in batches into a buffer of the caller.
+
+ The runs are compared with `Compare` and the merge is stable: equal elements are produced in the order of their runs. `T` must be default constructible and copy assignable.
+ */
+template<class T, class Compare>
+class xtd::kway_merger
+{
+public:
+	/// Merge the sorted arrays `runs`, which must outlive the merger.
+	explicit kway_merger(const std::vector<array_view<const T>>& runs, Compare comp = {})
+	: _comp(std::move(comp))
+	{
+		_runs.reserve(runs.size());
+		for(auto& run : runs)
+			_runs.push_back({run.data(), run.data() + run.size(), {}});
+		build();
+	}
+	/**
+	 Merge the runs returned block by block from `readers`, which must outlive the merger.
+
+	 A `Reader` has a member `next()` returning the next block of its run as `array_view<const T>`, which is empty at the end of the run and stays valid until the next call.
+	 */
+	template<class Reader, class = decltype(std::declval<Reader&>().next())>
+	explicit kway_merger(std::vector<Reader>& readers, Compare comp = {})
+	: _comp(std::move(comp))
+	{
+		_runs.reserve(readers.size());
+		for(auto& reader : readers)
+			_runs.push_back({nullptr, nullptr, [&reader] () -> array_view<const T> { return reader.next(); }});
+		build();
+	}
+
+	/// Write the next elements of the merge to `out` until it is full, returning the number of elements written, which is less than its size only at the end of the merge.
+	std::size_t read(array_view<T> out)
+	{
+		auto dest = out.data();
+		std::size_t n = 0;
+		for(; n < out.size() && !empty(); ++n)
+		{
+			dest[n] = _keys[_tree[0]];
+			replay();
+		}
+		return n;
+	}
+	/// Whether all runs are exhausted.
+	bool empty() const noexcept { return _exhausted[_tree[0]]; }
+
+private:
+	struct Run
+	{
+		const T* first;
+		const T* last;
+		std::function<array_view<const T>()> next; // Empty for runs in memory
+	};
+
+	// Load the next element of run i into its key, or mark the run exhausted
+	void fetch(std::size_t i)
+	{
+		auto& run = _runs[i];
+		if(run.first == run.last && run.next)
+		{
+			auto block = run.next();
+			run.first = block.data();
+			run.last = block.data() + block.size();
+		}
+		if(run.first == run.last)
+			_exhausted[i] = true;
+		else
+			_keys[i] = *run.first++;
+	}
+
+	// Evaluated with a single comparison and without branches, which the comparisons of a merge would mispredict half the time. Ties go to the earlier run, so the earlier run wins unless the later one is less: the operands are ordered by run index and the outcome flipped if a is the later run.
+	bool beats(std::uint32_t a, std::uint32_t b)
+	{
+		bool earlier = a < b;
+		auto swap = (a ^ b) & (std::uint32_t(0) - earlier);
+		bool later_less = _comp(_keys[a ^ swap], _keys[b ^ swap]);
+		bool live = !_exhausted[a];
+		return live & (_exhausted[b] | (later_less != earlier));
+	}
+
+	// Play the initial tournament, leaves k to 2k - 1 are the runs and node 1 is the root
+	void build()
+	{
+		if(_runs.size() > std::numeric_limits<std::uint32_t>::max())
+			throw std::length_error{"xtd::kway_merger: too many runs."};
+		auto k = static_cast<std::uint32_t>(_runs.size());
+		// Without runs the only node refers to an exhausted placeholder
+		_keys.resize(std::max(k, 1u));
+		_exhausted.assign(std::max(k, 1u), k == 0);
+		_tree.assign(std::max(k, 1u), 0);
+		if(k == 0)
+			return;
+		std::vector<std::uint32_t> winners(2 * k);
+		for(std::uint32_t i = 0; i < k; ++i)
+		{
+			fetch(i);
+			winners[k + i] = i;
+		}
+		for(auto i = k - 1; i > 0; --i)
+		{
+			auto a = winners[2 * i];
+			auto b = winners[2 * i + 1];
+			bool first = beats(a, b);
+			winners[i] = first ? a : b;
+			_tree[i] = first ? b : a;
+		}
+		_tree[0] = winners[1];
+	}
+
+	// Advance the winner's run and play its path to the root. The outcome is applied with masks because compilers turn a conditional swap into a branch.
+	void replay()
+	{
+		auto k = _runs.size();
+		auto winner = _tree[0];
+		fetch(winner);
+		for(auto i = (k + winner) / 2; i > 0; i /= 2)
+		{
+			auto loser = _tree[i];
+			auto mask = std::uint32_t(0) - beats(loser, winner);
+			auto diff = (loser ^ winner) & mask;
+			_tree[i] = loser ^ diff;
+			winner ^= diff;
+		}
+		_tree[0] = winner;
+	}
+
+	Compare _comp;
+	std::vector<Run> _runs;
+	std::vector<T> _keys; // The current element of each run
+	std::vector<char> _exhausted; // Exhausted runs lose against all others
+	std::vector<std::uint32_t> _tree; // _tree[0] is the winning run, the others the losers of inner nodes
+};
+
+////////////////////////////////////////////////////////////////////////
+// kway_merge
+//
+
+template<class T, class OutRange, class Compare>
+std::size_t xtd::kway_merge(const std::vector<array_view<const T>>& runs, OutRange&& out, Compare comp)
+{
+	auto n = detail::kway_merge::total_size(runs);
+	assert(out.size() >= n && "xtd::kway_merge: The output range is too small.");
+	kway_merger<T, Compare> merger{runs, std::move(comp)};
+	return merger.read({out.data(), n});
+}
+
+template<class T, class OutRange, class Compare>
+std::size_t xtd::kway_merge(const execution::parallel_policy& policy, const std::vector<array_view<const T>>& runs, OutRange&& out, Compare comp)
+{
+	auto n = detail::kway_merge::total_size(runs);
+	assert(out.size() >= n && "xtd::kway_merge: The output range is too small.");
+	if(n < 2 * detail::kway_merge::merge_grain || policy.concurrency() == 1 || runs.size() < 2)
+		return kway_merge(runs, out, std::move(comp));
+
+	auto dest = out.data();
+	detail::execution::parallel_for(policy, n, detail::kway_merge::merge_grain, [&] (std::size_t, std::size_t first, std::size_t last)
+	{
+		// Neighboring chunks select the same positions at their common boundary
+		auto local = comp;
+		auto begin = detail::kway_merge::select(runs, first, local);
+		auto end = detail::kway_merge::select(runs, last, local);
+		std::vector<array_view<const T>> parts(runs.size());
+		for(std::size_t i = 0; i < runs.size(); ++i)
+			parts[i] = {runs[i].data() + begin[i], end[i] - begin[i]};
+		kway_merger<T, Compare> merger{parts, std::move(local)};
+		merger.read({dest + first, last - first});
+	});
+	return n;
+}
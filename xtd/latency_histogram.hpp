@@ -0,0 +1,308 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+/**
+ \file
+ A histogram of latencies with bounded relative error which many threads can record into at once.
+
+ Values are counted in log-linear buckets as in HdrHistogram: values below `2^(p + 1)` have a bucket each, and every following power of two range is split into `2^p` buckets of equal width, so a value's bucket is found with one bit scan and shift and its width is at most `2^-p` of the value. With the default precision `p = 7` every percentile is within 0.8% of the true value, for all values up to `2^64`.
+
+ Recording increments a bucket in one of several shards with a relaxed atomic addition. Each thread is assigned a shard once, so threads rarely share cache lines and `record` never waits. Queries add up the shards, and can be made while other threads are recording.
+
+ ~~~cpp
+ xtd::latency_histogram latencies;
+ // On any thread
+ auto start = std::chrono::steady_clock::now();
+ handle(request);
+ latencies.record(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+ // Periodically
+ std::cout << "p50 " << latencies.percentile(50) << "ns, p99.9 " << latencies.percentile(99.9) << "ns\n";
+ std::ofstream file{"latencies.bin", std::ios_base::binary};
+ latencies.write(file);
+ ~~~
+
+ \author Miro Knejp
+ */
+
+#pragma once
+
+#include <xtd/iomanip.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace xtd
+{
+	class latency_histogram;
+}
+
+////////////////////////////////////////////////////////////////////////
+// Private parts, do not look.
+//
+
+namespace xtd
+{
+	namespace detail
+	{
+		namespace latency_histogram
+		{
+			// Counters per cache line
+			constexpr std::size_t line = 64 / sizeof(std::uint64_t);
+
+			// Threads are numbered in the order they first record into any histogram
+			inline std::size_t thread_index() noexcept
+			{
+				static std::atomic<std::size_t> next{0};
+				thread_local const std::size_t index = next++;
+				return index;
+			}
+
+			inline unsigned highest_bit(std::uint64_t x) noexcept
+			{
+#if defined(__GNUC__) || defined(__clang__)
+				return 63 - static_cast<unsigned>(__builtin_clzll(x | 1));
+#else
+				unsigned n = 0;
+				while(x >>= 1)
+					++n;
+				return n;
+#endif
+			}
+
+			// Native byte order, followed by the indices and counts of the non-empty buckets
+			struct Header
+			{
+				char magic[4];
+				std::uint32_t precision;
+				std::uint64_t sum;
+				std::uint64_t buckets;
+			};
+
+			constexpr char magic[4] = { 'X', 'L', 'H', '1' };
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////
+// latency_histogram
+//
+
+/**
+ Counts of non-negative integer values, usually nanoseconds, in buckets of a relative width of at most `2^-precision`.
+
+ `record` is wait-free and can be called from any number of threads. Queries and `merge` may run concurrently with `record`, but only see values whose recording happened before. The histogram takes `(65 - precision) * 2^precision` counters per shard.
+ */
+class xtd::latency_histogram
+{
+public:
+	/**
+	 Create an empty histogram with `2^precision` buckets per power of two, `precision` being in `[1, 12]`.
+
+	 Threads record into one of `shards` sets of counters, rounded up to a power of two. Zero uses one per hardware thread.
+	 */
+	explicit latency_histogram(unsigned precision = 7, std::size_t shards = 0)
+	: _precision(precision)
+	, _buckets(std::size_t(65 - precision) << precision)
+	, _stride((_buckets + 1 + detail::latency_histogram::line - 1) / detail::latency_histogram::line * detail::latency_histogram::line)
+	{
+		assert(precision >= 1 && precision <= 12 && "xtd::latency_histogram: The precision must be in [1, 12].");
+		if(shards == 0)
+			shards = std::max(std::thread::hardware_concurrency(), 1u);
+		std::size_t n = 1;
+		while(n < shards)
+			n *= 2;
+		_shard_mask = n - 1;
+		_counts.reset(new std::atomic<std::uint64_t>[n * _stride]());
+	}
+
+	/// Count `value` `count` times.
+	void record(std::uint64_t value, std::uint64_t count = 1) noexcept
+	{
+		auto shard = _counts.get() + (detail::latency_histogram::thread_index() & _shard_mask) * _stride;
+		shard[bucket(value)].fetch_add(count, std::memory_order_relaxed);
+		shard[_buckets].fetch_add(value * count, std::memory_order_relaxed);
+	}
+
+	/// Add the counts of `other`, which must have the same precision.
+	void merge(const latency_histogram& other)
+	{
+		assert(other._precision == _precision && "xtd::latency_histogram: Only histograms of the same precision can be merged.");
+		auto counts = other.buckets();
+		for(std::size_t i = 0; i < _buckets; ++i)
+			if(counts[i] != 0)
+				_counts[i].fetch_add(counts[i], std::memory_order_relaxed);
+		_counts[_buckets].fetch_add(other.sum(), std::memory_order_relaxed);
+	}
+	/// Forget all values. Values recorded concurrently may be partially kept.
+	void clear() noexcept
+	{
+		for(std::size_t i = 0; i < (_shard_mask + 1) * _stride; ++i)
+			_counts[i].store(0, std::memory_order_relaxed);
+	}
+
+	unsigned precision() const noexcept { return _precision; }
+	/// The number of values recorded.
+	std::uint64_t count() const
+	{
+		std::uint64_t n = 0;
+		for(auto c : buckets())
+			n += c;
+		return n;
+	}
+	/// The exact sum of the values recorded, modulo `2^64`.
+	std::uint64_t sum() const noexcept
+	{
+		std::uint64_t s = 0;
+		for(std::size_t shard = 0; shard <= _shard_mask; ++shard)
+			s += _counts[shard * _stride + _buckets].load(std::memory_order_relaxed);
+		return s;
+	}
+	/// The exact mean of the values, or zero if empty.
+	double mean() const
+	{
+		auto n = count();
+		return n == 0 ? 0 : static_cast<double>(sum()) / static_cast<double>(n);
+	}
+	/// The smallest value recorded, rounded down to its bucket. Zero if empty.
+	std::uint64_t min() const
+	{
+		auto counts = buckets();
+		auto it = std::find_if(counts.begin(), counts.end(), [] (std::uint64_t c) { return c != 0; });
+		return it == counts.end() ? 0 : lowest(static_cast<std::size_t>(it - counts.begin()));
+	}
+	/// The largest value recorded, rounded up to its bucket. Zero if empty.
+	std::uint64_t max() const
+	{
+		auto counts = buckets();
+		for(auto i = counts.size(); i-- > 0;)
+			if(counts[i] != 0)
+				return highest(i);
+		return 0;
+	}
+	/**
+	 The smallest value which at least `p` percent of the values are less than or equal to, `p` being in `[0, 100]`.
+
+	 The result is rounded up to its bucket, so it is never smaller than the true percentile and at most `2^-precision` larger. Zero if empty.
+	 */
+	std::uint64_t percentile(double p) const
+	{
+		assert(p >= 0 && p <= 100 && "xtd::latency_histogram: The percentile must be in [0, 100].");
+		auto counts = buckets();
+		std::uint64_t n = 0;
+		for(auto c : counts)
+			n += c;
+		if(n == 0)
+			return 0;
+		auto rank = std::max<std::uint64_t>(static_cast<std::uint64_t>(std::ceil(p / 100 * static_cast<double>(n))), 1);
+		std::uint64_t seen = 0;
+		for(std::size_t i = 0; i < counts.size(); ++i)
+		{
+			seen += counts[i];
+			if(seen >= rank)
+				return highest(i);
+		}
+		return max();
+	}
+
+	/// The counts of all buckets, summed over the shards.
+	std::vector<std::uint64_t> buckets() const
+	{
+		std::vector<std::uint64_t> counts(_buckets);
+		for(std::size_t shard = 0; shard <= _shard_mask; ++shard)
+		{
+			auto p = _counts.get() + shard * _stride;
+			for(std::size_t i = 0; i < _buckets; ++i)
+				counts[i] += p[i].load(std::memory_order_relaxed);
+		}
+		return counts;
+	}
+	/// The index of the bucket counting `value`.
+	std::size_t bucket(std::uint64_t value) const noexcept
+	{
+		auto bit = detail::latency_histogram::highest_bit(value);
+		auto shift = bit > _precision ? bit - _precision : 0;
+		return (std::size_t(shift) << _precision) + static_cast<std::size_t>(value >> shift);
+	}
+	/// The smallest value counted by bucket `i`.
+	std::uint64_t lowest(std::size_t i) const noexcept
+	{
+		auto shift = std::max<std::size_t>(i >> _precision, 1) - 1;
+		return std::uint64_t(i - (shift << _precision)) << shift;
+	}
+	/// The largest value counted by bucket `i`.
+	std::uint64_t highest(std::size_t i) const noexcept
+	{
+		auto shift = std::max<std::size_t>(i >> _precision, 1) - 1;
+		return lowest(i) + ((std::uint64_t(1) << shift) - 1);
+	}
+
+	/**
+	 Write the precision, sum and non-empty buckets to `out` with `xtd::unformatted`, in native byte order.
+
+	 The size is 24 bytes plus 12 per non-empty bucket.
+	 */
+	void write(std::ostream& out) const
+	{
+		auto counts = buckets();
+		std::vector<std::uint32_t> indices;
+		std::vector<std::uint64_t> nonempty;
+		for(std::size_t i = 0; i < counts.size(); ++i)
+		{
+			if(counts[i] != 0)
+			{
+				indices.push_back(static_cast<std::uint32_t>(i));
+				nonempty.push_back(counts[i]);
+			}
+		}
+		detail::latency_histogram::Header header{{}, _precision, sum(), indices.size()};
+		std::copy(std::begin(detail::latency_histogram::magic), std::end(detail::latency_histogram::magic), header.magic);
+		out << unformatted(header) << unformatted(indices) << unformatted(nonempty);
+	}
+	/**
+	 Read a histogram written by `write` from `in`, with `shards` as in the constructor.
+
+	 \throws std::runtime_error if the data is truncated or malformed.
+	 */
+	static latency_histogram read(std::istream& in, std::size_t shards = 0)
+	{
+		detail::latency_histogram::Header header;
+		if(!(in >> unformatted(header))
+		   || !std::equal(std::begin(header.magic), std::end(header.magic), detail::latency_histogram::magic)
+		   || header.precision < 1 || header.precision > 12)
+			throw std::runtime_error{"xtd::latency_histogram: Not a serialized histogram."};
+		latency_histogram result{header.precision, shards};
+		if(header.buckets > result._buckets)
+			throw std::runtime_error{"xtd::latency_histogram: Malformed serialized histogram."};
+		std::vector<std::uint32_t> indices;
+		std::vector<std::uint64_t> counts;
+		if(!(in >> unformatted(indices, header.buckets) >> unformatted(counts, header.buckets)))
+			throw std::runtime_error{"xtd::latency_histogram: Truncated serialized histogram."};
+		for(std::size_t i = 0; i < indices.size(); ++i)
+		{
+			if(indices[i] >= result._buckets)
+				throw std::runtime_error{"xtd::latency_histogram: Malformed serialized histogram."};
+			result._counts[indices[i]].store(counts[i], std::memory_order_relaxed);
+		}
+		result._counts[result._buckets].store(header.sum, std::memory_order_relaxed);
+		return result;
+	}
+
+private:
+	unsigned _precision;
+	std::size_t _buckets;
+	std::size_t _stride; // Counters per shard, the buckets and the sum rounded up to whole cache lines
+	std::size_t _shard_mask;
+	std::unique_ptr<std::atomic<std::uint64_t>[]> _counts;
+};
@@ -0,0 +1,642 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+/**
+ \file
+ A self-contained LZ77 codec producing output compatible with the [LZ4 block format](https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md ), plus stream buffers compressing and decompressing data passing through a `std::basic_streambuf`.
+
+ Blocks produced by `xtd::lz::compress` can be decoded by any LZ4 block decoder and vice versa.
+
+ \author Miro Knejp
+ */
+
+#pragma once
+
+#include <xtd/array_view.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <streambuf>
+#include <vector>
+
+namespace xtd
+{
+	namespace lz
+	{
+		/// Selects the trade-off between compression speed and ratio.
+		enum class level
+		{
+			/// Single-probe hash table without match chains, optimized for speed.
+			fast,
+			/// Hash chains with lazy matching, optimized for ratio.
+			high,
+		};
+
+		/// Thrown when decompressing malformed input.
+		class format_error : public std::runtime_error
+		{
+		public:
+			using runtime_error::runtime_error;
+		};
+
+		/// The largest number of bytes accepted as input to a single call of `compress`.
+		constexpr std::size_t max_input_size = 0x7E000000;
+
+		/// The worst-case number of bytes `compress` may produce for `size` input bytes.
+		constexpr std::size_t compress_bound(std::size_t size) noexcept
+		{
+			return size + size / 255 + 16;
+		}
+
+		/**
+		 Compress `src` into `dst` as a single LZ4 block.
+
+		 \returns The number of bytes written to `dst`.
+		 \throws std::length_error if `src` is larger than `max_input_size` or `dst` is too small to hold the result. A buffer of `compress_bound(src.size())` bytes is always sufficient.
+		 */
+		std::size_t compress(array_view<const unsigned char> src, array_view<unsigned char> dst, level lvl = level::fast);
+
+		/**
+		 Decompress the LZ4 block in `src` into `dst`.
+
+		 The block format does not store the decompressed size, the caller must provide a large enough `dst`.
+
+		 \returns The number of bytes written to `dst`.
+		 \throws format_error if `src` is not a valid block.
+		 \throws std::length_error if `dst` is too small to hold the result.
+		 */
+		std::size_t decompress(array_view<const unsigned char> src, array_view<unsigned char> dst);
+
+		/// Default number of uncompressed bytes per block used by basic_compressbuf.
+		constexpr std::size_t default_block_size = 1 << 16;
+
+		template<class CharT, class Traits = std::char_traits<CharT>>
+		class basic_compressbuf;
+		template<class CharT, class Traits = std::char_traits<CharT>>
+		class basic_decompressbuf;
+
+		using compressbuf = basic_compressbuf<char>;
+		using decompressbuf = basic_decompressbuf<char>;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////
+// Private parts, do not look.
+//
+
+namespace xtd
+{
+	namespace detail
+	{
+		namespace lz
+		{
+			constexpr std::size_t min_match = 4;
+			// The last match must start at least this many bytes before the end of input.
+			constexpr std::size_t match_find_limit = 12;
+			// The last bytes of input are always encoded as literals.
+			constexpr std::size_t last_literals = 5;
+			constexpr std::size_t max_distance = 65535;
+
+			constexpr unsigned fast_hash_bits = 12;
+			constexpr unsigned high_hash_bits = 15;
+			constexpr unsigned high_max_attempts = 64;
+
+			inline std::uint32_t read32(const unsigned char* p) noexcept
+			{
+				std::uint32_t x;
+				std::memcpy(&x, p, sizeof(x));
+				return x;
+			}
+
+			inline std::uint32_t hash4(std::uint32_t x, unsigned bits) noexcept
+			{
+				return (x * 2654435761u) >> (32 - bits);
+			}
+
+			// Number of equal bytes at a and b without reading at or past limit (which bounds a).
+			inline std::size_t count_equal(const unsigned char* a, const unsigned char* b, const unsigned char* limit) noexcept
+			{
+				auto start = a;
+				while(a + sizeof(std::uint64_t) <= limit)
+				{
+					std::uint64_t x, y;
+					std::memcpy(&x, a, sizeof(x));
+					std::memcpy(&y, b, sizeof(y));
+					if(x != y)
+						break;
+					a += sizeof(x);
+					b += sizeof(y);
+				}
+				while(a < limit && *a == *b)
+				{
+					++a;
+					++b;
+				}
+				return static_cast<std::size_t>(a - start);
+			}
+
+			class SequenceWriter
+			{
+			public:
+				SequenceWriter(unsigned char* first, unsigned char* last) noexcept : _first(first), _op(first), _end(last) { }
+
+				// Emit a literal run followed by a match (or no match if match_len is zero).
+				void emit(const unsigned char* literals, std::size_t lit_len, std::size_t offset, std::size_t match_len)
+				{
+					auto required = 1 + lit_len / 255 + 1 + lit_len + (match_len ? 2 + (match_len - min_match) / 255 + 1 : 0);
+					if(required > static_cast<std::size_t>(_end - _op))
+						throw std::length_error{"xtd::lz::compress: destination buffer too small."};
+
+					auto token = _op++;
+					*token = static_cast<unsigned char>((lit_len < 15 ? lit_len : 15) << 4);
+					if(lit_len >= 15)
+						put_length(lit_len - 15);
+					// literals is null for empty input
+					if(lit_len > 0)
+						std::memcpy(_op, literals, lit_len);
+					_op += lit_len;
+					if(match_len == 0)
+						return;
+
+					*_op++ = static_cast<unsigned char>(offset & 0xFF);
+					*_op++ = static_cast<unsigned char>(offset >> 8);
+					auto len = match_len - min_match;
+					*token |= static_cast<unsigned char>(len < 15 ? len : 15);
+					if(len >= 15)
+						put_length(len - 15);
+				}
+
+				std::size_t size() const noexcept { return static_cast<std::size_t>(_op - _first); }
+
+			private:
+				void put_length(std::size_t len) noexcept
+				{
+					for(; len >= 255; len -= 255)
+						*_op++ = 255;
+					*_op++ = static_cast<unsigned char>(len);
+				}
+
+				unsigned char* _first;
+				unsigned char* _op;
+				unsigned char* _end;
+			};
+
+			inline std::size_t compress_fast(const unsigned char* src, std::size_t n, SequenceWriter& out)
+			{
+				std::uint32_t table[1 << fast_hash_bits] = { };
+				auto match_limit = src + n - last_literals;
+				auto search_end = n - match_find_limit;
+
+				std::size_t ip = 0;
+				std::size_t anchor = 0;
+				unsigned misses = 0;
+				while(ip <= search_end)
+				{
+					auto seq = read32(src + ip);
+					auto& slot = table[hash4(seq, fast_hash_bits)];
+					std::size_t ref = slot;
+					slot = static_cast<std::uint32_t>(ip);
+					if(ref >= ip || ip - ref > max_distance || read32(src + ref) != seq)
+					{
+						// Skip faster through incompressible data
+						ip += 1 + (misses++ >> 6);
+						continue;
+					}
+					misses = 0;
+					while(ip > anchor && ref > 0 && src[ip - 1] == src[ref - 1])
+					{
+						--ip;
+						--ref;
+					}
+					auto len = min_match + count_equal(src + ip + min_match, src + ref + min_match, match_limit);
+					out.emit(src + anchor, ip - anchor, ip - ref, len);
+					ip += len;
+					anchor = ip;
+					if(ip <= search_end)
+						table[hash4(read32(src + ip - 2), fast_hash_bits)] = static_cast<std::uint32_t>(ip - 2);
+				}
+				out.emit(src + anchor, n - anchor, 0, 0);
+				return out.size();
+			}
+
+			class HashChain
+			{
+			public:
+				HashChain(const unsigned char* src) : _src(src), _head(1 << high_hash_bits, 0), _chain(max_distance + 1, 0) { }
+
+				// Find the longest match for position ip, returns its length or zero if there is none.
+				std::size_t find(std::size_t ip, const unsigned char* limit, std::size_t& ref)
+				{
+					for(; _next < ip; ++_next)
+						insert(_next);
+
+					std::size_t best = 0;
+					auto seq = read32(_src + ip);
+					std::size_t candidate = _head[hash4(seq, high_hash_bits)];
+					for(unsigned attempts = high_max_attempts; candidate-- > 0 && attempts > 0; --attempts)
+					{
+						if(ip - candidate > max_distance)
+							break;
+						if(_src[candidate + best] == _src[ip + best] && read32(_src + candidate) == seq)
+						{
+							auto len = min_match + count_equal(_src + ip + min_match, _src + candidate + min_match, limit);
+							if(len > best)
+							{
+								best = len;
+								ref = candidate;
+							}
+						}
+						auto delta = _chain[candidate & max_distance];
+						if(delta == 0 || delta > candidate)
+							break;
+						// Stored positions are biased by one so zero marks an empty head slot
+						candidate = candidate - delta + 1;
+					}
+					return best;
+				}
+
+			private:
+				void insert(std::size_t pos)
+				{
+					auto& head = _head[hash4(read32(_src + pos), high_hash_bits)];
+					auto delta = head ? pos - (head - 1) : 0;
+					_chain[pos & max_distance] = static_cast<std::uint16_t>(delta > max_distance ? 0 : delta);
+					head = static_cast<std::uint32_t>(pos + 1);
+				}
+
+				const unsigned char* _src;
+				std::size_t _next = 0;
+				std::vector<std::uint32_t> _head;
+				std::vector<std::uint16_t> _chain;
+			};
+
+			inline std::size_t compress_high(const unsigned char* src, std::size_t n, SequenceWriter& out)
+			{
+				HashChain chain{src};
+				auto match_limit = src + n - last_literals;
+				auto search_end = n - match_find_limit;
+
+				std::size_t ip = 0;
+				std::size_t anchor = 0;
+				while(ip <= search_end)
+				{
+					std::size_t ref = 0;
+					auto len = chain.find(ip, match_limit, ref);
+					if(len == 0)
+					{
+						++ip;
+						continue;
+					}
+					// Lazy evaluation: defer the match while the next position yields a longer one
+					while(ip + 1 <= search_end)
+					{
+						std::size_t next_ref = 0;
+						auto next_len = chain.find(ip + 1, match_limit, next_ref);
+						if(next_len <= len)
+							break;
+						++ip;
+						len = next_len;
+						ref = next_ref;
+					}
+					out.emit(src + anchor, ip - anchor, ip - ref, len);
+					ip += len;
+					anchor = ip;
+				}
+				out.emit(src + anchor, n - anchor, 0, 0);
+				return out.size();
+			}
+
+			inline void store32(unsigned char* p, std::uint32_t x) noexcept
+			{
+				for(int i = 0; i < 4; ++i)
+					p[i] = static_cast<unsigned char>(x >> (8 * i));
+			}
+			inline std::uint32_t load32(const unsigned char* p) noexcept
+			{
+				return std::uint32_t(p[0]) | std::uint32_t(p[1]) << 8 | std::uint32_t(p[2]) << 16 | std::uint32_t(p[3]) << 24;
+			}
+
+			// Marks a stored (uncompressed) block in the packed size field of a block header
+			constexpr std::uint32_t stored_flag = 0x80000000u;
+		}
+	}
+}
+
+inline std::size_t xtd::lz::compress(array_view<const unsigned char> src, array_view<unsigned char> dst, level lvl)
+{
+	using namespace detail::lz;
+	if(src.size() > max_input_size)
+		throw std::length_error{"xtd::lz::compress: input too large."};
+
+	SequenceWriter out{dst.data(), dst.data() + dst.size()};
+	if(src.size() <= match_find_limit)
+	{
+		out.emit(src.data(), src.size(), 0, 0);
+		return out.size();
+	}
+	if(lvl == level::high)
+		return compress_high(src.data(), src.size(), out);
+	return compress_fast(src.data(), src.size(), out);
+}
+
+inline std::size_t xtd::lz::decompress(array_view<const unsigned char> src, array_view<unsigned char> dst)
+{
+	using namespace detail::lz;
+	auto ip = src.data();
+	auto iend = ip + src.size();
+	auto op = dst.data();
+	auto ostart = op;
+	auto oend = op + dst.size();
+
+	auto read_length = [&] (std::size_t len)
+	{
+		unsigned char x;
+		do
+		{
+			if(ip == iend)
+				throw format_error{"xtd::lz::decompress: truncated length."};
+			x = *ip++;
+			len += x;
+		} while(x == 255);
+		return len;
+	};
+
+	for(;;)
+	{
+		if(ip == iend)
+			throw format_error{"xtd::lz::decompress: truncated block."};
+		auto token = *ip++;
+
+		std::size_t lit_len = token >> 4;
+		if(lit_len == 15)
+			lit_len = read_length(lit_len);
+		if(lit_len > static_cast<std::size_t>(iend - ip))
+			throw format_error{"xtd::lz::decompress: truncated literals."};
+		if(lit_len > static_cast<std::size_t>(oend - op))
+			throw std::length_error{"xtd::lz::decompress: destination buffer too small."};
+		if(lit_len <= 16 && oend - op >= 16 && iend - ip >= 16)
+			std::memcpy(op, ip, 16); // Fixed-size copies compile to a few moves, the excess is overwritten later
+		else if(lit_len > 0) // dst is null when empty
+			std::memcpy(op, ip, lit_len);
+		op += lit_len;
+		ip += lit_len;
+		if(ip == iend)
+			break; // The last sequence consists of literals only
+
+		if(iend - ip < 2)
+			throw format_error{"xtd::lz::decompress: truncated match offset."};
+		std::size_t offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		if(offset == 0 || offset > static_cast<std::size_t>(op - ostart))
+			throw format_error{"xtd::lz::decompress: match offset out of range."};
+
+		std::size_t match_len = token & 15;
+		if(match_len == 15)
+			match_len = read_length(match_len);
+		match_len += min_match;
+		if(match_len > static_cast<std::size_t>(oend - op))
+			throw std::length_error{"xtd::lz::decompress: destination buffer too small."};
+
+		auto match = op - offset;
+		auto match_end = op + match_len;
+		if(offset >= sizeof(std::uint64_t))
+		{
+			// Every 8-byte chunk only reads bytes already written, overshoot past match_end if there is room
+			auto chunk_end = oend - match_end >= 8 ? match_end : oend - 8;
+			for(; op < chunk_end; op += sizeof(std::uint64_t), match += sizeof(std::uint64_t))
+				std::memcpy(op, match, sizeof(std::uint64_t));
+		}
+		while(op < match_end)
+			*op++ = *match++;
+		op = match_end;
+	}
+	return static_cast<std::size_t>(op - ostart);
+}
+
+////////////////////////////////////////////////////////////////////////
+// basic_compressbuf
+//
+
+/**
+ An output stream buffer compressing all data written to it and forwarding the result to another stream buffer.
+
+ Data is split into blocks of at most `block_size` bytes each of which is compressed independently. Every block is preceded by a header of two little-endian 32 bit integers: the uncompressed size and the compressed size. If compression does not reduce the size of a block it is stored verbatim and the highest bit of the compressed size is set. An uncompressed size of zero marks the end of the stream.
+
+ The end marker is written by `finish()` or on destruction. `pubsync()` compresses all pending data into a (possibly short) block and flushes the underlying stream buffer.
+
+ \code
+ std::ofstream file{"data.lz", std::ios::binary};
+ xtd::lz::compressbuf buf{file.rdbuf()};
+ std::ostream out{&buf};
+ out << xtd::unformatted(values);
+ \endcode
+ */
+template<class CharT, class Traits>
+class xtd::lz::basic_compressbuf : public std::basic_streambuf<CharT, Traits>
+{
+	static_assert(sizeof(CharT) == 1, "xtd::lz::basic_compressbuf: Only streams with single-byte elements are supported.");
+
+public:
+	using char_type = CharT;
+	using traits_type = Traits;
+	using int_type = typename Traits::int_type;
+	using pos_type = typename Traits::pos_type;
+	using off_type = typename Traits::off_type;
+
+	/// Write compressed data to `sink`, which must outlive this object.
+	explicit basic_compressbuf(std::basic_streambuf<CharT, Traits>* sink, level lvl = level::fast, std::size_t block_size = default_block_size)
+	: _sink(sink)
+	, _level(lvl)
+	, _raw(block_size > 0 && block_size <= max_input_size ? block_size : default_block_size)
+	{
+		this->setp(buffer_begin(), buffer_begin() + _raw.size());
+	}
+	basic_compressbuf(const basic_compressbuf&) = delete;
+	basic_compressbuf& operator=(const basic_compressbuf&) = delete;
+
+	~basic_compressbuf()
+	{
+		try
+		{
+			finish();
+		}
+		catch(...)
+		{
+		}
+	}
+
+	/**
+	 Compress all pending data and write the end of stream marker.
+
+	 No more data can be written afterwards.
+
+	 \returns `false` if writing to the underlying stream buffer failed.
+	 */
+	bool finish()
+	{
+		if(_finished)
+			return true;
+		_finished = true;
+		unsigned char end[4] = { };
+		auto ok = flush_block() && write(end, sizeof(end));
+		this->setp(nullptr, nullptr);
+		return ok;
+	}
+
+protected:
+	int_type overflow(int_type ch) override
+	{
+		if(_finished || !flush_block())
+			return Traits::eof();
+		if(!Traits::eq_int_type(ch, Traits::eof()))
+		{
+			*this->pptr() = Traits::to_char_type(ch);
+			this->pbump(1);
+		}
+		return Traits::not_eof(ch);
+	}
+
+	int sync() override
+	{
+		if(!flush_block())
+			return -1;
+		return _sink->pubsync();
+	}
+
+private:
+	CharT* buffer_begin() noexcept { return reinterpret_cast<CharT*>(_raw.data()); }
+
+	bool write(const unsigned char* p, std::size_t n)
+	{
+		return _sink->sputn(reinterpret_cast<const CharT*>(p), static_cast<std::streamsize>(n)) == static_cast<std::streamsize>(n);
+	}
+
+	bool flush_block()
+	{
+		auto n = static_cast<std::size_t>(this->pptr() - this->pbase());
+		if(n == 0)
+			return true;
+		this->setp(buffer_begin(), buffer_begin() + _raw.size());
+
+		_packed.resize(compress_bound(n) + 8);
+		auto packed_size = compress(make_array_view(_raw.data(), n), make_array_view(_packed.data() + 8, _packed.size() - 8), _level);
+		if(packed_size >= n)
+		{
+			std::memcpy(_packed.data() + 8, _raw.data(), n);
+			packed_size = n;
+			detail::lz::store32(_packed.data() + 4, static_cast<std::uint32_t>(n) | detail::lz::stored_flag);
+		}
+		else
+			detail::lz::store32(_packed.data() + 4, static_cast<std::uint32_t>(packed_size));
+		detail::lz::store32(_packed.data(), static_cast<std::uint32_t>(n));
+		return write(_packed.data(), packed_size + 8);
+	}
+
+	std::basic_streambuf<CharT, Traits>* _sink;
+	level _level;
+	std::vector<unsigned char> _raw;
+	std::vector<unsigned char> _packed;
+	bool _finished = false;
+};
+
+////////////////////////////////////////////////////////////////////////
+// basic_decompressbuf
+//
+
+/**
+ An input stream buffer decompressing data produced by basic_compressbuf which is read from another stream buffer.
+
+ Reading malformed data throws format_error out of `underflow()`, which `std::basic_istream` reports by setting `badbit`.
+
+ \code
+ std::ifstream file{"data.lz", std::ios::binary};
+ xtd::lz::decompressbuf buf{file.rdbuf()};
+ std::istream in{&buf};
+ in >> xtd::unformatted(values, count);
+ \endcode
+ */
+template<class CharT, class Traits>
+class xtd::lz::basic_decompressbuf : public std::basic_streambuf<CharT, Traits>
+{
+	static_assert(sizeof(CharT) == 1, "xtd::lz::basic_decompressbuf: Only streams with single-byte elements are supported.");
+
+public:
+	using char_type = CharT;
+	using traits_type = Traits;
+	using int_type = typename Traits::int_type;
+	using pos_type = typename Traits::pos_type;
+	using off_type = typename Traits::off_type;
+
+	/**
+	 Read compressed data from `source`, which must outlive this object.
+
+	 `block_size` must be at least the block size the stream was written with. Larger blocks are rejected as malformed, so a corrupt header cannot make the buffer allocate more memory than that.
+	 */
+	explicit basic_decompressbuf(std::basic_streambuf<CharT, Traits>* source, std::size_t block_size = default_block_size)
+	: _source(source)
+	, _block_size(block_size > 0 && block_size <= max_input_size ? block_size : default_block_size)
+	{
+	}
+	basic_decompressbuf(const basic_decompressbuf&) = delete;
+	basic_decompressbuf& operator=(const basic_decompressbuf&) = delete;
+
+protected:
+	int_type underflow() override
+	{
+		if(this->gptr() < this->egptr())
+			return Traits::to_int_type(*this->gptr());
+		if(_finished)
+			return Traits::eof();
+
+		unsigned char header[8];
+		if(!read(header, 4))
+			throw format_error{"xtd::lz::basic_decompressbuf: truncated block header."};
+		auto raw_size = detail::lz::load32(header);
+		if(raw_size == 0)
+		{
+			_finished = true;
+			return Traits::eof();
+		}
+		if(!read(header + 4, 4))
+			throw format_error{"xtd::lz::basic_decompressbuf: truncated block header."};
+		auto packed_size = detail::lz::load32(header + 4);
+		auto stored = (packed_size & detail::lz::stored_flag) != 0;
+		packed_size &= ~detail::lz::stored_flag;
+		if(raw_size > _block_size || packed_size > compress_bound(raw_size) || (stored && packed_size != raw_size))
+			throw format_error{"xtd::lz::basic_decompressbuf: invalid block header."};
+
+		_raw.resize(raw_size);
+		if(stored)
+		{
+			if(!read(_raw.data(), raw_size))
+				throw format_error{"xtd::lz::basic_decompressbuf: truncated block."};
+		}
+		else
+		{
+			_packed.resize(packed_size);
+			if(!read(_packed.data(), packed_size))
+				throw format_error{"xtd::lz::basic_decompressbuf: truncated block."};
+			if(decompress(make_array_view(_packed.data(), packed_size), make_array_view(_raw.data(), raw_size)) != raw_size)
+				throw format_error{"xtd::lz::basic_decompressbuf: block size mismatch."};
+		}
+		auto p = reinterpret_cast<CharT*>(_raw.data());
+		this->setg(p, p, p + raw_size);
+		return Traits::to_int_type(*p);
+	}
+
+private:
+	bool read(unsigned char* p, std::size_t n)
+	{
+		return _source->sgetn(reinterpret_cast<CharT*>(p), static_cast<std::streamsize>(n)) == static_cast<std::streamsize>(n);
+	}
+
+	std::basic_streambuf<CharT, Traits>* _source;
+	std::size_t _block_size;
+	std::vector<unsigned char> _raw;
+	std::vector<unsigned char> _packed;
+	bool _finished = false;
+};
@@ -12,6 +12,7 @@
  */
 
 #pragma once
+#include <cstdint>
 #include <memory>
 #include <type_traits>
 
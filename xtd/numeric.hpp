@@ -6,13 +6,27 @@
 
 /**
  \file
- Provides `constexpr`, container and convenience overloads of `<numeric>'.
+ Provides `constexpr`, container and convenience overloads of `<numeric>', `reduce` for fast unordered reductions and `inclusive_scan`/`exclusive_scan` for prefix sums.
  
  \author Miro Knejp
  */
 
 #pragma once
+#include <xtd/execution.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <functional>
+#include <memory>
 #include <numeric>
+#include <type_traits>
+#include <vector>
+
+#if defined(__SSE2__) && (defined(__GNUC__) || defined(__clang__))
+#define XTD_NUMERIC_SSE2 1
+#include <emmintrin.h>
+#endif
 
 namespace xtd
 {
@@ -20,7 +34,7 @@ namespace xtd
 	template<class InputIt, class T>
 	constexpr auto accumulate(InputIt first, InputIt last, T init)
 	{
-		for(; first != last; ++last)
+		for(; first != last; ++first)
 			init = init + *first;
 		return init;
 	}
@@ -29,7 +43,7 @@ namespace xtd
 	template<class InputIt, class T, class BinaryOperation>
 	constexpr auto accumulate(InputIt first, InputIt last, T init, BinaryOperation op)
 	{
-		for(; first != last; ++last)
+		for(; first != last; ++first)
 			init = op(init, *first);
 		return init;
 	}
@@ -69,4 +83,734 @@ namespace xtd
 			init = op(init, x);
 		return init;
 	}
-}
\ No newline at end of file
+
+	namespace detail
+	{
+		namespace numeric
+		{
+			template<class Range>
+			using contiguous_value_t = std::remove_cv_t<std::remove_pointer_t<decltype(std::declval<const Range&>().data() + std::declval<const Range&>().size())>>;
+		}
+	}
+
+	/**
+	 Combine all elements of the contiguous `range` and `init` using `op`.
+
+	 Unlike `accumulate` the elements are combined in unspecified order, so `op` must be associative and commutative. This allows using several independent accumulators to hide the latency of `op`, and SIMD instructions for arithmetic types with `std::plus` or `std::multiplies`. Partial results have the type of `init`. For floating point types the result may differ slightly from `accumulate`.
+
+	 ~~~cpp
+	 std::vector<float> v = ...;
+	 auto sum = xtd::reduce(v);
+	 auto product = xtd::reduce(v, 1.f, std::multiplies<>{});
+	 ~~~
+	 */
+	template<class Range, class T = detail::numeric::contiguous_value_t<Range>, class BinaryOperation = std::plus<>>
+	T reduce(const Range& range, T init = T{}, BinaryOperation op = {});
+
+	/// Parallel version of `reduce`, splitting the range into one part per thread.
+	template<class Range, class T = detail::numeric::contiguous_value_t<Range>, class BinaryOperation = std::plus<>>
+	T reduce(const execution::parallel_policy& policy, const Range& range, T init = T{}, BinaryOperation op = {});
+
+	/// \name Accurate floating point summation
+	/**
+	 Sum a contiguous range of `float` or `double` with a bounded rounding error.
+
+	 - `pairwise_sum` adds elements in a balanced tree, so the error grows with `log(n)` instead of `n` as for `accumulate`, at nearly the same speed as `reduce`.
+	 - `kahan_sum` carries the rounding error of each addition in a separate compensation term, making the error independent of `n` as long as the partial sums exceed the elements' magnitude.
+	 - `neumaier_sum` captures the rounding error of every addition exactly, also if an element exceeds the partial sum (e.g. `{1, 1e100, 1, -1e100}` sums to `2`), at slightly higher cost.
+
+	 All three use SIMD lanes with independent accumulators. The range is split into blocks of fixed size whose results are combined in a fixed order, so the parallel overloads return bit-identical results to the sequential ones regardless of the number of threads.
+
+	 Compensated summation relies on strict IEEE semantics and does not work when compiling with `-ffast-math` or similar options.
+	 */
+	//@{
+	template<class Range>
+	detail::numeric::contiguous_value_t<Range> pairwise_sum(const Range& range) noexcept;
+	template<class Range>
+	detail::numeric::contiguous_value_t<Range> pairwise_sum(const execution::parallel_policy& policy, const Range& range);
+	template<class Range>
+	detail::numeric::contiguous_value_t<Range> kahan_sum(const Range& range) noexcept;
+	template<class Range>
+	detail::numeric::contiguous_value_t<Range> kahan_sum(const execution::parallel_policy& policy, const Range& range);
+	template<class Range>
+	detail::numeric::contiguous_value_t<Range> neumaier_sum(const Range& range) noexcept;
+	template<class Range>
+	detail::numeric::contiguous_value_t<Range> neumaier_sum(const execution::parallel_policy& policy, const Range& range);
+	//@}
+
+	/// \name Prefix sums
+	/**
+	 Write the prefix sums of the contiguous range `in` to the contiguous range `out`, which must have at least as many elements and may be the same range as `in`.
+
+	 `inclusive_scan` writes `init op in[0] op ... op in[i]` to `out[i]`, `exclusive_scan` writes `init op in[0] op ... op in[i - 1]`. Both return `init` combined with all elements, which for an `exclusive_scan` of record lengths is the total size. Partial results have the value type of `out`, to which `init` is converted. Note that unlike in `<numeric>` `init` always comes before `op`, as for `reduce`.
+
+	 For 32 and 64 bit integers, `float` and `double` with `std::plus` each SIMD register is scanned in place by shifting and adding, and the running total is added to whole registers. For floating point types this regroups the additions, so results may differ slightly from `partial_sum`.
+
+	 The parallel overloads make two passes: the first computes the total of each thread's part with `reduce`, the second scans each part starting with the sum of the totals before it. As for `reduce`, `op` must be associative and commutative.
+
+	 ~~~cpp
+	 std::vector<std::uint32_t> lengths = ...;
+	 std::vector<std::uint64_t> offsets(lengths.size());
+	 auto total = xtd::exclusive_scan(xtd::execution::par, lengths, offsets);
+	 ~~~
+	 */
+	//@{
+	// The last parameter prevents the sequential overloads from matching an execution policy
+	template<class InRange, class OutRange, class T = detail::numeric::contiguous_value_t<std::remove_reference_t<OutRange>>, class BinaryOperation = std::plus<>, class = detail::numeric::contiguous_value_t<InRange>>
+	T inclusive_scan(const InRange& in, OutRange&& out, T init = T{}, BinaryOperation op = {});
+	template<class InRange, class OutRange, class T = detail::numeric::contiguous_value_t<std::remove_reference_t<OutRange>>, class BinaryOperation = std::plus<>>
+	T inclusive_scan(const execution::parallel_policy& policy, const InRange& in, OutRange&& out, T init = T{}, BinaryOperation op = {});
+	template<class InRange, class OutRange, class T = detail::numeric::contiguous_value_t<std::remove_reference_t<OutRange>>, class BinaryOperation = std::plus<>, class = detail::numeric::contiguous_value_t<InRange>>
+	T exclusive_scan(const InRange& in, OutRange&& out, T init = T{}, BinaryOperation op = {});
+	template<class InRange, class OutRange, class T = detail::numeric::contiguous_value_t<std::remove_reference_t<OutRange>>, class BinaryOperation = std::plus<>>
+	T exclusive_scan(const execution::parallel_policy& policy, const InRange& in, OutRange&& out, T init = T{}, BinaryOperation op = {});
+	//@}
+}
+
+////////////////////////////////////////////////////////////////////////
+// Private parts, do not look.
+//
+
+#if defined(__GNUC__) || defined(__clang__)
+#define XTD_NUMERIC_VECTOR_EXTENSIONS 1
+#endif
+
+namespace xtd
+{
+	namespace detail
+	{
+		namespace numeric
+		{
+			// Minimum number of elements per thread for parallel reductions
+			constexpr std::size_t parallel_grain = 1 << 16;
+
+			// Reduce a non-empty range with four independent accumulators of type U
+			template<class U, class T, class Op>
+			U reduce_scalar(const T* p, std::size_t n, Op& op)
+			{
+				if(n < 8)
+				{
+					U acc = p[0];
+					for(std::size_t i = 1; i < n; ++i)
+						acc = op(acc, p[i]);
+					return acc;
+				}
+				U a0 = p[0], a1 = p[1], a2 = p[2], a3 = p[3];
+				std::size_t i = 4;
+				for(const auto end = n - n % 4; i < end; i += 4)
+				{
+					a0 = op(a0, p[i]);
+					a1 = op(a1, p[i + 1]);
+					a2 = op(a2, p[i + 2]);
+					a3 = op(a3, p[i + 3]);
+				}
+				for(; i < n; ++i)
+					a0 = op(a0, p[i]);
+				return op(op(a0, a1), op(a2, a3));
+			}
+
+#if defined(XTD_NUMERIC_VECTOR_EXTENSIONS)
+
+			// Operations with an elementwise equivalent on vectors
+			template<class Op, class T>
+			struct VectorOp : std::false_type { };
+			template<class T>
+			struct VectorOp<std::plus<T>, T> : std::true_type { template<class V> static void apply(V& acc, const V& x) noexcept { acc += x; } };
+			template<class T>
+			struct VectorOp<std::plus<>, T> : VectorOp<std::plus<T>, T> { };
+			template<class T>
+			struct VectorOp<std::multiplies<T>, T> : std::true_type { template<class V> static void apply(V& acc, const V& x) noexcept { acc *= x; } };
+			template<class T>
+			struct VectorOp<std::multiplies<>, T> : VectorOp<std::multiplies<T>, T> { };
+
+			template<class T>
+			struct IsVectorizable : std::integral_constant<bool, std::is_arithmetic<T>::value && !std::is_same<T, bool>::value && !std::is_same<T, long double>::value> { };
+
+#if defined(__AVX__)
+			constexpr std::size_t vector_size = 32;
+#else
+			constexpr std::size_t vector_size = 16; // SSE2 and NEON
+#endif
+
+			// Reduce a non-empty range with eight independent vector accumulators
+			template<class T, class Op>
+			T reduce_vector(const T* p, std::size_t n, Op& op)
+			{
+				typedef T V __attribute__((vector_size(vector_size)));
+				constexpr std::size_t lanes = sizeof(V) / sizeof(T);
+				constexpr std::size_t block = 8 * lanes;
+				if(n < 2 * block)
+					return reduce_scalar<T>(p, n, op);
+
+				using VOp = VectorOp<Op, T>;
+				// Separate variables instead of an array keep all accumulators in registers
+				V a0, a1, a2, a3, a4, a5, a6, a7, x;
+				auto load = [p] (V& v, std::size_t i) { std::memcpy(&v, p + i, sizeof(V)); };
+				load(a0, 0);
+				load(a1, lanes);
+				load(a2, 2 * lanes);
+				load(a3, 3 * lanes);
+				load(a4, 4 * lanes);
+				load(a5, 5 * lanes);
+				load(a6, 6 * lanes);
+				load(a7, 7 * lanes);
+				std::size_t i = block;
+				for(const auto end = n - n % block; i < end; i += block)
+				{
+					load(x, i);
+					VOp::apply(a0, x);
+					load(x, i + lanes);
+					VOp::apply(a1, x);
+					load(x, i + 2 * lanes);
+					VOp::apply(a2, x);
+					load(x, i + 3 * lanes);
+					VOp::apply(a3, x);
+					load(x, i + 4 * lanes);
+					VOp::apply(a4, x);
+					load(x, i + 5 * lanes);
+					VOp::apply(a5, x);
+					load(x, i + 6 * lanes);
+					VOp::apply(a6, x);
+					load(x, i + 7 * lanes);
+					VOp::apply(a7, x);
+				}
+				VOp::apply(a0, a1);
+				VOp::apply(a2, a3);
+				VOp::apply(a4, a5);
+				VOp::apply(a6, a7);
+				VOp::apply(a0, a2);
+				VOp::apply(a4, a6);
+				VOp::apply(a0, a4);
+				T acc = a0[0];
+				for(std::size_t k = 1; k < lanes; ++k)
+					acc = op(acc, a0[k]);
+				for(; i < n; ++i)
+					acc = op(acc, p[i]);
+				return acc;
+			}
+
+			template<class U, class T, class Op>
+			U reduce_nonempty(const T* p, std::size_t n, Op& op, std::true_type /* vectorizable */)
+			{
+				return reduce_vector(p, n, op);
+			}
+
+#endif // XTD_NUMERIC_VECTOR_EXTENSIONS
+
+			template<class U, class T, class Op>
+			U reduce_nonempty(const T* p, std::size_t n, Op& op, std::false_type /* vectorizable */)
+			{
+				return reduce_scalar<U>(p, n, op);
+			}
+
+			// Reduce a non-empty range in type U
+			template<class U, class T, class Op>
+			U reduce_nonempty(const T* p, std::size_t n, Op& op)
+			{
+#if defined(XTD_NUMERIC_VECTOR_EXTENSIONS)
+				// Vectors only accumulate in the element type
+				using vectorizable = std::integral_constant<bool, std::is_same<T, U>::value && IsVectorizable<T>::value && VectorOp<Op, T>::value>;
+#else
+				using vectorizable = std::false_type;
+#endif
+				return reduce_nonempty<U>(p, n, op, vectorizable{});
+			}
+
+			template<class T, class U, class Op>
+			U reduce(const T* p, std::size_t n, U init, Op& op)
+			{
+				return n == 0 ? init : op(init, reduce_nonempty<U>(p, n, op));
+			}
+
+			template<class T, class U, class Op>
+			U reduce(const xtd::execution::parallel_policy& policy, const T* p, std::size_t n, U init, Op& op)
+			{
+				if(n < 2 * parallel_grain || policy.concurrency() == 1)
+					return reduce(p, n, std::move(init), op);
+				std::unique_ptr<U[]> partial{new U[std::min<std::size_t>(policy.concurrency(), n / parallel_grain + 1)]};
+				auto chunks = detail::execution::parallel_for(policy, n, parallel_grain, [&] (std::size_t chunk, std::size_t first, std::size_t last)
+				{
+					auto chunk_op = op;
+					partial[chunk] = reduce_nonempty<U>(p + first, last - first, chunk_op);
+				});
+				for(std::size_t i = 0; i < chunks; ++i)
+					init = op(init, partial[i]);
+				return init;
+			}
+
+			////////////////////////////////////////////////////////////////////////
+			// Accurate summation
+
+			// Blocks whose results are combined in a fixed order, independent of threads
+			constexpr std::size_t sum_block = 1 << 14;
+
+			// A sum and its accumulated rounding error
+			template<class T>
+			struct Compensated
+			{
+				T sum = 0;
+				T error = 0;
+
+				// Knuth's TwoSum finds the exact rounding error without comparing magnitudes
+				void add(T x) noexcept
+				{
+					auto t = sum + x;
+					auto z = t - sum;
+					error += (sum - (t - z)) + (x - z);
+					sum = t;
+				}
+				void add(const Compensated& other) noexcept
+				{
+					add(other.sum);
+					error += other.error;
+				}
+				T value() const noexcept { return sum + error; }
+			};
+
+			template<class T>
+			T pairwise_block(const T* p, std::size_t n) noexcept
+			{
+				if(n <= 512)
+				{
+					std::plus<> op;
+					return n == 0 ? T(0) : reduce_nonempty<T>(p, n, op);
+				}
+				auto half = n / 2;
+				return pairwise_block(p, half) + pairwise_block(p + half, n - half);
+			}
+
+			// Combines block sums pairwise in the shape of a binary counter
+			template<class T>
+			class PairwiseCombiner
+			{
+			public:
+				void add(T x) noexcept
+				{
+					unsigned level = 0;
+					for(; _size > 0 && _levels[_size - 1] == level; ++level)
+						x = _sums[--_size] + x;
+					_sums[_size] = x;
+					_levels[_size++] = level;
+				}
+				T value() const noexcept
+				{
+					T x = 0;
+					for(auto i = _size; i > 0; --i)
+						x = _sums[i - 1] + x;
+					return x;
+				}
+
+			private:
+				// Levels are strictly decreasing, so this suffices for any size_t
+				T _sums[sizeof(std::size_t) * 8];
+				unsigned _levels[sizeof(std::size_t) * 8];
+				unsigned _size = 0;
+			};
+
+			struct KahanStep
+			{
+				// c holds the negated rounding error
+				template<class V>
+				static void apply(V& s, V& c, const V& x) noexcept
+				{
+					V y = x - c;
+					V t = s + y;
+					c = (t - s) - y;
+					s = t;
+				}
+				template<class T>
+				static void finish(Compensated<T>& acc, T s, T c) noexcept
+				{
+					acc.add(s);
+					acc.error -= c;
+				}
+			};
+
+			struct NeumaierStep
+			{
+				// c holds the rounding error, computed with TwoSum
+				template<class V>
+				static void apply(V& s, V& c, const V& x) noexcept
+				{
+					V t = s + x;
+					V z = t - s;
+					c += (s - (t - z)) + (x - z);
+					s = t;
+				}
+				template<class T>
+				static void finish(Compensated<T>& acc, T s, T c) noexcept
+				{
+					acc.add(s);
+					acc.error += c;
+				}
+			};
+
+			template<class Step, class T>
+			Compensated<T> compensated_block_scalar(const T* p, std::size_t n) noexcept
+			{
+				T s = 0, c = 0;
+				for(std::size_t i = 0; i < n; ++i)
+					Step::apply(s, c, p[i]);
+				Compensated<T> acc;
+				Step::finish(acc, s, c);
+				return acc;
+			}
+
+#if defined(XTD_NUMERIC_VECTOR_EXTENSIONS)
+
+			// Eight independent pairs of sum and compensation vectors
+			template<class Step, class T>
+			Compensated<T> compensated_block(const T* p, std::size_t n) noexcept
+			{
+				typedef T V __attribute__((vector_size(vector_size)));
+				constexpr std::size_t lanes = sizeof(V) / sizeof(T);
+				constexpr std::size_t block = 8 * lanes;
+
+				V s0 = {}, s1 = {}, s2 = {}, s3 = {}, s4 = {}, s5 = {}, s6 = {}, s7 = {};
+				V c0 = {}, c1 = {}, c2 = {}, c3 = {}, c4 = {}, c5 = {}, c6 = {}, c7 = {}, x;
+				auto load = [p] (V& v, std::size_t i) { std::memcpy(&v, p + i, sizeof(V)); };
+				std::size_t i = 0;
+				for(const auto end = n - n % block; i < end; i += block)
+				{
+					load(x, i);
+					Step::apply(s0, c0, x);
+					load(x, i + lanes);
+					Step::apply(s1, c1, x);
+					load(x, i + 2 * lanes);
+					Step::apply(s2, c2, x);
+					load(x, i + 3 * lanes);
+					Step::apply(s3, c3, x);
+					load(x, i + 4 * lanes);
+					Step::apply(s4, c4, x);
+					load(x, i + 5 * lanes);
+					Step::apply(s5, c5, x);
+					load(x, i + 6 * lanes);
+					Step::apply(s6, c6, x);
+					load(x, i + 7 * lanes);
+					Step::apply(s7, c7, x);
+				}
+				auto acc = compensated_block_scalar<Step>(p + i, n - i);
+				for(std::size_t k = 0; k < lanes; ++k)
+				{
+					Step::finish(acc, s0[k], c0[k]);
+					Step::finish(acc, s1[k], c1[k]);
+					Step::finish(acc, s2[k], c2[k]);
+					Step::finish(acc, s3[k], c3[k]);
+					Step::finish(acc, s4[k], c4[k]);
+					Step::finish(acc, s5[k], c5[k]);
+					Step::finish(acc, s6[k], c6[k]);
+					Step::finish(acc, s7[k], c7[k]);
+				}
+				return acc;
+			}
+
+#else
+
+			template<class Step, class T>
+			Compensated<T> compensated_block(const T* p, std::size_t n) noexcept
+			{
+				return compensated_block_scalar<Step>(p, n);
+			}
+
+#endif // XTD_NUMERIC_VECTOR_EXTENSIONS
+
+			template<class T>
+			T pairwise_sum(const T* p, std::size_t n) noexcept
+			{
+				PairwiseCombiner<T> acc;
+				for(std::size_t i = 0; i < n; i += sum_block)
+					acc.add(pairwise_block(p + i, std::min(sum_block, n - i)));
+				return acc.value();
+			}
+
+			template<class Step, class T>
+			T compensated_sum(const T* p, std::size_t n) noexcept
+			{
+				Compensated<T> acc;
+				for(std::size_t i = 0; i < n; i += sum_block)
+					acc.add(compensated_block<Step>(p + i, std::min(sum_block, n - i)));
+				return acc.value();
+			}
+
+			// Compute the results of all blocks in parallel, then combine them in order
+			template<class R, class T, class Block>
+			std::vector<R> parallel_blocks(const xtd::execution::parallel_policy& policy, const T* p, std::size_t n, Block block)
+			{
+				std::vector<R> results((n + sum_block - 1) / sum_block);
+				detail::execution::parallel_for(policy, results.size(), parallel_grain / sum_block, [&] (std::size_t, std::size_t first, std::size_t last)
+				{
+					for(auto i = first; i < last; ++i)
+						results[i] = block(p + i * sum_block, std::min(sum_block, n - i * sum_block));
+				});
+				return results;
+			}
+
+			template<class T>
+			T pairwise_sum(const xtd::execution::parallel_policy& policy, const T* p, std::size_t n)
+			{
+				PairwiseCombiner<T> acc;
+				for(auto x : parallel_blocks<T>(policy, p, n, [] (const T* p, std::size_t n) { return pairwise_block(p, n); }))
+					acc.add(x);
+				return acc.value();
+			}
+
+			template<class Step, class T>
+			T compensated_sum(const xtd::execution::parallel_policy& policy, const T* p, std::size_t n)
+			{
+				Compensated<T> acc;
+				for(auto& x : parallel_blocks<Compensated<T>>(policy, p, n, [] (const T* p, std::size_t n) { return compensated_block<Step>(p, n); }))
+					acc.add(x);
+				return acc.value();
+			}
+
+			template<class T>
+			struct IsSummable : std::integral_constant<bool, std::is_same<T, float>::value || std::is_same<T, double>::value> { };
+
+			////////////////////////////////////////////////////////////////////////
+			// Prefix sums
+
+			template<bool Exclusive, class T, class U, class Op>
+			U scan_scalar(const T* in, U* out, std::size_t n, U acc, Op& op)
+			{
+				for(std::size_t i = 0; i < n; ++i)
+				{
+					// Read before writing, in and out may be the same
+					U x = op(acc, in[i]);
+					if(Exclusive)
+						out[i] = std::move(acc);
+					else
+						out[i] = x;
+					acc = std::move(x);
+				}
+				return acc;
+			}
+
+#if defined(XTD_NUMERIC_SSE2)
+
+			// Lanewise addition of 128 bit registers holding T
+			template<class T, class = void>
+			struct SseAdd : std::false_type { };
+			template<class T>
+			struct SseAdd<T, std::enable_if_t<std::is_integral<T>::value && sizeof(T) == 4>> : std::true_type
+			{
+				static __m128i apply(__m128i a, __m128i b) noexcept { return _mm_add_epi32(a, b); }
+			};
+			template<class T>
+			struct SseAdd<T, std::enable_if_t<std::is_integral<T>::value && sizeof(T) == 8>> : std::true_type
+			{
+				static __m128i apply(__m128i a, __m128i b) noexcept { return _mm_add_epi64(a, b); }
+			};
+			template<>
+			struct SseAdd<float> : std::true_type
+			{
+				static __m128i apply(__m128i a, __m128i b) noexcept { return _mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b))); }
+			};
+			template<>
+			struct SseAdd<double> : std::true_type
+			{
+				static __m128i apply(__m128i a, __m128i b) noexcept { return _mm_castpd_si128(_mm_add_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b))); }
+			};
+
+			template<class Op, class T>
+			struct IsPlus : std::integral_constant<bool, std::is_same<Op, std::plus<>>::value || std::is_same<Op, std::plus<T>>::value> { };
+
+			// Inclusive scan within a register of 4 or 8 byte lanes: x + (x << 1 lane) + ((x + (x << 1 lane)) << 2 lanes)
+			template<class Add, int Lane>
+			__m128i scan_register(__m128i x) noexcept
+			{
+				x = Add::apply(x, _mm_slli_si128(x, Lane));
+				// Adding a zero register would turn -0.0 into +0.0
+				if(Lane == 4)
+					x = Add::apply(x, _mm_slli_si128(x, 8));
+				return x;
+			}
+
+			// Broadcast the last lane
+			template<int Lane>
+			__m128i last_lane(__m128i x) noexcept
+			{
+				return _mm_shuffle_epi32(x, Lane == 4 ? 0xFF : 0xEE);
+			}
+
+			// Shift one lane up, filling the first lane with the last lane of prev
+			template<int Lane>
+			__m128i shift_in(__m128i x, __m128i prev) noexcept
+			{
+				return _mm_or_si128(_mm_slli_si128(x, Lane), _mm_srli_si128(prev, 16 - Lane));
+			}
+
+			// Two registers per iteration, so only one addition and one shuffle depend on the previous iteration
+			template<bool Exclusive, class T, class Op>
+			T scan_sse(const T* in, T* out, std::size_t n, T acc, Op& op) noexcept
+			{
+				using Add = SseAdd<T>;
+				constexpr int lane = sizeof(T);
+				constexpr std::size_t lanes = 16 / sizeof(T);
+				T buffer[lanes];
+				std::fill_n(buffer, lanes, acc);
+				auto carry = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer));
+				auto load = [in] (std::size_t i) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)); };
+				auto store = [out] (std::size_t i, __m128i x) { _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), x); };
+				std::size_t i = 0;
+				for(const auto end = n - n % (2 * lanes); i < end; i += 2 * lanes)
+				{
+					auto x0 = scan_register<Add, lane>(load(i));
+					auto x1 = scan_register<Add, lane>(load(i + lanes));
+					x1 = Add::apply(x1, last_lane<lane>(x0));
+					x0 = Add::apply(x0, carry);
+					x1 = Add::apply(x1, carry);
+					if(Exclusive)
+					{
+						store(i, shift_in<lane>(x0, carry));
+						store(i + lanes, shift_in<lane>(x1, x0));
+					}
+					else
+					{
+						store(i, x0);
+						store(i + lanes, x1);
+					}
+					carry = last_lane<lane>(x1);
+				}
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(buffer), carry);
+				return scan_scalar<Exclusive>(in + i, out + i, n - i, buffer[0], op);
+			}
+
+			template<bool Exclusive, class T, class Op>
+			T scan(const T* in, T* out, std::size_t n, T acc, Op& op, std::true_type /* vectorizable */)
+			{
+				return scan_sse<Exclusive>(in, out, n, acc, op);
+			}
+
+#endif // XTD_NUMERIC_SSE2
+
+			template<bool Exclusive, class T, class U, class Op>
+			U scan(const T* in, U* out, std::size_t n, U acc, Op& op, std::false_type /* vectorizable */)
+			{
+				return scan_scalar<Exclusive>(in, out, n, std::move(acc), op);
+			}
+
+			template<bool Exclusive, class T, class U, class Op>
+			U scan(const T* in, U* out, std::size_t n, U acc, Op& op)
+			{
+#if defined(XTD_NUMERIC_SSE2)
+				using vectorizable = std::integral_constant<bool, std::is_same<T, U>::value && SseAdd<T>::value && IsPlus<Op, T>::value>;
+#else
+				using vectorizable = std::false_type;
+#endif
+				return scan<Exclusive>(in, out, n, std::move(acc), op, vectorizable{});
+			}
+
+			template<bool Exclusive, class T, class U, class Op>
+			U scan(const xtd::execution::parallel_policy& policy, const T* in, U* out, std::size_t n, U init, Op& op)
+			{
+				if(n < 2 * parallel_grain || policy.concurrency() == 1)
+					return scan<Exclusive>(in, out, n, std::move(init), op);
+				std::unique_ptr<U[]> partial{new U[std::min<std::size_t>(policy.concurrency(), n / parallel_grain + 1)]};
+				// Both passes split the range into the same chunks
+				auto chunks = detail::execution::parallel_for(policy, n, parallel_grain, [&] (std::size_t chunk, std::size_t first, std::size_t last)
+				{
+					auto chunk_op = op;
+					partial[chunk] = reduce_nonempty<U>(in + first, last - first, chunk_op);
+				});
+				for(std::size_t i = 0; i < chunks; ++i)
+				{
+					auto next = op(init, partial[i]);
+					partial[i] = std::move(init);
+					init = std::move(next);
+				}
+				detail::execution::parallel_for(policy, n, parallel_grain, [&] (std::size_t chunk, std::size_t first, std::size_t last)
+				{
+					auto chunk_op = op;
+					scan<Exclusive>(in + first, out + first, last - first, std::move(partial[chunk]), chunk_op);
+				});
+				return init;
+			}
+		}
+	}
+}
+
+template<class Range, class T, class BinaryOperation>
+T xtd::reduce(const Range& range, T init, BinaryOperation op)
+{
+	return detail::numeric::reduce(range.data(), range.size(), std::move(init), op);
+}
+
+template<class Range, class T, class BinaryOperation>
+T xtd::reduce(const execution::parallel_policy& policy, const Range& range, T init, BinaryOperation op)
+{
+	return detail::numeric::reduce(policy, range.data(), range.size(), std::move(init), op);
+}
+
+template<class Range>
+auto xtd::pairwise_sum(const Range& range) noexcept -> detail::numeric::contiguous_value_t<Range>
+{
+	static_assert(detail::numeric::IsSummable<detail::numeric::contiguous_value_t<Range>>::value, "xtd::pairwise_sum: Only float and double are supported.");
+	return detail::numeric::pairwise_sum(range.data(), range.size());
+}
+
+template<class Range>
+auto xtd::pairwise_sum(const execution::parallel_policy& policy, const Range& range) -> detail::numeric::contiguous_value_t<Range>
+{
+	static_assert(detail::numeric::IsSummable<detail::numeric::contiguous_value_t<Range>>::value, "xtd::pairwise_sum: Only float and double are supported.");
+	return detail::numeric::pairwise_sum(policy, range.data(), range.size());
+}
+
+template<class Range>
+auto xtd::kahan_sum(const Range& range) noexcept -> detail::numeric::contiguous_value_t<Range>
+{
+	static_assert(detail::numeric::IsSummable<detail::numeric::contiguous_value_t<Range>>::value, "xtd::kahan_sum: Only float and double are supported.");
+	return detail::numeric::compensated_sum<detail::numeric::KahanStep>(range.data(), range.size());
+}
+
+template<class Range>
+auto xtd::kahan_sum(const execution::parallel_policy& policy, const Range& range) -> detail::numeric::contiguous_value_t<Range>
+{
+	static_assert(detail::numeric::IsSummable<detail::numeric::contiguous_value_t<Range>>::value, "xtd::kahan_sum: Only float and double are supported.");
+	return detail::numeric::compensated_sum<detail::numeric::KahanStep>(policy, range.data(), range.size());
+}
+
+template<class Range>
+auto xtd::neumaier_sum(const Range& range) noexcept -> detail::numeric::contiguous_value_t<Range>
+{
+	static_assert(detail::numeric::IsSummable<detail::numeric::contiguous_value_t<Range>>::value, "xtd::neumaier_sum: Only float and double are supported.");
+	return detail::numeric::compensated_sum<detail::numeric::NeumaierStep>(range.data(), range.size());
+}
+
+template<class Range>
+auto xtd::neumaier_sum(const execution::parallel_policy& policy, const Range& range) -> detail::numeric::contiguous_value_t<Range>
+{
+	static_assert(detail::numeric::IsSummable<detail::numeric::contiguous_value_t<Range>>::value, "xtd::neumaier_sum: Only float and double are supported.");
+	return detail::numeric::compensated_sum<detail::numeric::NeumaierStep>(policy, range.data(), range.size());
+}
+
+template<class InRange, class OutRange, class T, class BinaryOperation, class>
+T xtd::inclusive_scan(const InRange& in, OutRange&& out, T init, BinaryOperation op)
+{
+	assert(out.size() >= in.size() && "xtd::inclusive_scan: The output range is too small.");
+	using U = detail::numeric::contiguous_value_t<std::remove_reference_t<OutRange>>;
+	return detail::numeric::scan<false>(in.data(), out.data(), in.size(), static_cast<U>(std::move(init)), op);
+}
+
+template<class InRange, class OutRange, class T, class BinaryOperation>
+T xtd::inclusive_scan(const execution::parallel_policy& policy, const InRange& in, OutRange&& out, T init, BinaryOperation op)
+{
+	assert(out.size() >= in.size() && "xtd::inclusive_scan: The output range is too small.");
+	using U = detail::numeric::contiguous_value_t<std::remove_reference_t<OutRange>>;
+	return detail::numeric::scan<false>(policy, in.data(), out.data(), in.size(), static_cast<U>(std::move(init)), op);
+}
+
+template<class InRange, class OutRange, class T, class BinaryOperation, class>
+T xtd::exclusive_scan(const InRange& in, OutRange&& out, T init, BinaryOperation op)
+{
+	assert(out.size() >= in.size() && "xtd::exclusive_scan: The output range is too small.");
+	using U = detail::numeric::contiguous_value_t<std::remove_reference_t<OutRange>>;
+	return detail::numeric::scan<true>(in.data(), out.data(), in.size(), static_cast<U>(std::move(init)), op);
+}
+
+template<class InRange, class OutRange, class T, class BinaryOperation>
+T xtd::exclusive_scan(const execution::parallel_policy& policy, const InRange& in, OutRange&& out, T init, BinaryOperation op)
+{
+	assert(out.size() >= in.size() && "xtd::exclusive_scan: The output range is too small.");
+	using U = detail::numeric::contiguous_value_t<std::remove_reference_t<OutRange>>;
+	return detail::numeric::scan<true>(policy, in.data(), out.data(), in.size(), static_cast<U>(std::move(init)), op);
+}
@@ -0,0 +1,336 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+/**
+ \file
+ Hardware performance counters of the current thread, read around a region of code.
+
+ `perf_counters` opens a group of Linux `perf_event_open` counters for the calling thread: the CPU time of the thread (`task_clock`), and if the processor exposes them, cycles, retired instructions, last level cache misses and branch mispredictions. All are read together with a single `read` system call, so they describe exactly the same interval. Counters the processor or the kernel does not provide, for example in virtual machines without a PMU or with `perf_event_paranoid` too high, are reported as unavailable and read as zero.
+
+ `XTD_PERF_SCOPE` works like `XTD_FINALLY`, but passes the counter deltas over the enclosing scope to the block it runs at scope exit.
+
+ ~~~cpp
+ xtd::perf_counters counters;
+ for(auto& batch : batches)
+ {
+     XTD_PERF_SCOPE(counters, delta)
+     {
+         std::cout << delta.instructions << " instructions at " << delta.ipc() << " IPC, " << delta.cache_misses << " cache misses\n";
+     };
+     process(batch);
+ }
+ ~~~
+
+ \author Miro Knejp
+ */
+
+#pragma once
+
+#include <xtd/finally.hpp>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace xtd
+{
+	/// The counters of perf_counters.
+	enum class perf_event : unsigned
+	{
+		task_clock, ///< Nanoseconds the thread was running on a CPU
+		cycles,
+		instructions,
+		cache_misses, ///< Last level cache misses
+		branch_misses,
+	};
+
+	/// Values of the counters of perf_counters, or differences between them.
+	struct perf_counts
+	{
+		std::uint64_t task_clock = 0;
+		std::uint64_t cycles = 0;
+		std::uint64_t instructions = 0;
+		std::uint64_t cache_misses = 0;
+		std::uint64_t branch_misses = 0;
+
+		/// Instructions per cycle, or zero without cycles.
+		double ipc() const noexcept { return cycles == 0 ? 0 : static_cast<double>(instructions) / static_cast<double>(cycles); }
+
+		perf_counts& operator-=(const perf_counts& other) noexcept
+		{
+			task_clock -= other.task_clock;
+			cycles -= other.cycles;
+			instructions -= other.instructions;
+			cache_misses -= other.cache_misses;
+			branch_misses -= other.branch_misses;
+			return *this;
+		}
+		perf_counts& operator+=(const perf_counts& other) noexcept
+		{
+			task_clock += other.task_clock;
+			cycles += other.cycles;
+			instructions += other.instructions;
+			cache_misses += other.cache_misses;
+			branch_misses += other.branch_misses;
+			return *this;
+		}
+		friend perf_counts operator-(perf_counts a, const perf_counts& b) noexcept { return a -= b; }
+		friend perf_counts operator+(perf_counts a, const perf_counts& b) noexcept { return a += b; }
+	};
+
+	class perf_counters;
+
+	template<class F>
+	class perf_sampler;
+
+	/// Create a `perf_sampler` calling `f` with the deltas of `counters` when it is destroyed.
+	template<class F>
+	perf_sampler<std::decay_t<F>> make_perf_sampler(perf_counters& counters, F&& f);
+}
+
+#define XTD_PERF_SCOPE_ID_(line) XTD_FINALLY_CAT_(XTD_PERF_SCOPE_, line)
+
+/**
+ Run the block following the macro at scope exit, with `delta` being the `perf_counts` accumulated by `counters` since the macro.
+
+ As with `XTD_FINALLY` the block must be followed by a semicolon.
+
+ ~~~cpp
+ XTD_PERF_SCOPE(counters, delta) { stats.push(delta.ipc()); };
+ ~~~
+ */
+#define XTD_PERF_SCOPE(counters, delta) auto XTD_PERF_SCOPE_ID_(__LINE__) = ::xtd::detail::perf_counters::SamplerHelper{counters} + [&](const ::xtd::perf_counts& delta)
+
+////////////////////////////////////////////////////////////////////////
+// Private parts, do not look.
+//
+
+namespace xtd
+{
+	namespace detail
+	{
+		namespace perf_counters
+		{
+			constexpr unsigned events = 5;
+
+			struct SamplerHelper
+			{
+				xtd::perf_counters& counters;
+			};
+
+			template<class F>
+			auto operator+(SamplerHelper helper, F&& f)
+			{
+				return xtd::make_perf_sampler(helper.counters, std::forward<F>(f));
+			}
+
+#if defined(__linux__)
+			inline perf_event_attr attributes(xtd::perf_event e, bool exclude_kernel) noexcept
+			{
+				perf_event_attr attr;
+				std::memset(&attr, 0, sizeof(attr));
+				attr.size = sizeof(attr);
+				switch(e)
+				{
+				case xtd::perf_event::task_clock:
+					attr.type = PERF_TYPE_SOFTWARE;
+					attr.config = PERF_COUNT_SW_TASK_CLOCK;
+					break;
+				case xtd::perf_event::cycles:
+					attr.type = PERF_TYPE_HARDWARE;
+					attr.config = PERF_COUNT_HW_CPU_CYCLES;
+					break;
+				case xtd::perf_event::instructions:
+					attr.type = PERF_TYPE_HARDWARE;
+					attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+					break;
+				case xtd::perf_event::cache_misses:
+					attr.type = PERF_TYPE_HARDWARE;
+					attr.config = PERF_COUNT_HW_CACHE_MISSES;
+					break;
+				case xtd::perf_event::branch_misses:
+					attr.type = PERF_TYPE_HARDWARE;
+					attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+					break;
+				}
+				attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+				attr.exclude_kernel = exclude_kernel;
+				attr.exclude_hv = 1;
+				return attr;
+			}
+#endif
+
+			// The member of perf_counts for an event
+			inline std::uint64_t& member(xtd::perf_counts& counts, unsigned e) noexcept
+			{
+				std::uint64_t* members[] = { &counts.task_clock, &counts.cycles, &counts.instructions, &counts.cache_misses, &counts.branch_misses };
+				return *members[e];
+			}
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////
+// perf_counters
+//
+
+/**
+ A group of performance counters of the thread creating it.
+
+ The counters only count while the creating thread runs, but can be read from any thread. If the counters were multiplexed with other events because the processor has too few, values are scaled up to the whole time they were enabled.
+ */
+class xtd::perf_counters
+{
+public:
+	/**
+	 Open the counters for the calling thread, counting user space only if `exclude_kernel` is true.
+
+	 Counting the kernel usually requires privileges.
+
+	 \throws std::system_error if no counter can be opened, or on systems other than Linux.
+	 */
+	explicit perf_counters(bool exclude_kernel = true)
+	{
+#if defined(__linux__)
+		int error = 0;
+		for(unsigned e = 0; e < detail::perf_counters::events; ++e)
+		{
+			auto attr = detail::perf_counters::attributes(static_cast<perf_event>(e), exclude_kernel);
+			attr.disabled = _leader < 0;
+			auto fd = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, _leader, 0));
+			if(fd < 0)
+			{
+				error = errno;
+				continue;
+			}
+			if(_leader < 0)
+				_leader = fd;
+			_fds[e] = fd;
+			_slots[e] = _count++;
+		}
+		if(_leader < 0)
+			throw std::system_error{error, std::system_category(), "xtd::perf_counters: perf_event_open"};
+		::ioctl(_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+		::ioctl(_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#else
+		(void)exclude_kernel;
+		throw std::system_error{ENOSYS, std::system_category(), "xtd::perf_counters: perf_event_open"};
+#endif
+	}
+	perf_counters(const perf_counters&) = delete;
+	perf_counters& operator=(const perf_counters&) = delete;
+	~perf_counters()
+	{
+#if defined(__linux__)
+		for(auto fd : _fds)
+			if(fd >= 0)
+				::close(fd);
+#endif
+	}
+
+	/// Whether the counter of `e` could be opened.
+	bool available(perf_event e) const noexcept { return _fds[static_cast<unsigned>(e)] >= 0; }
+
+	/**
+	 The values of all counters since they were opened, zero for unavailable ones.
+
+	 \throws std::system_error if the counters cannot be read.
+	 */
+	perf_counts read() const
+	{
+		perf_counts counts;
+		if(!read(counts))
+			throw std::system_error{errno, std::system_category(), "xtd::perf_counters: read"};
+		return counts;
+	}
+	/// Read the values of all counters into `counts`, returning false on failure.
+	bool read(perf_counts& counts) const noexcept
+	{
+#if defined(__linux__)
+		// Number of counters, time enabled, time running and the values in the order they were opened
+		std::uint64_t data[3 + detail::perf_counters::events];
+		auto size = static_cast<std::size_t>(3 + _count) * sizeof(std::uint64_t);
+		if(::read(_leader, data, size) != static_cast<ssize_t>(size))
+			return false;
+		auto enabled = data[1];
+		auto running = data[2];
+		for(unsigned e = 0; e < detail::perf_counters::events; ++e)
+		{
+			auto& value = detail::perf_counters::member(counts, e);
+			if(_fds[e] < 0)
+				value = 0;
+			else if(running != 0 && running < enabled)
+				value = static_cast<std::uint64_t>(static_cast<double>(data[3 + _slots[e]]) * (static_cast<double>(enabled) / static_cast<double>(running)));
+			else
+				value = data[3 + _slots[e]];
+		}
+		return true;
+#else
+		(void)counts;
+		return false;
+#endif
+	}
+
+private:
+	int _leader = -1;
+	unsigned _count = 0;
+	int _fds[detail::perf_counters::events] = { -1, -1, -1, -1, -1 };
+	unsigned _slots[detail::perf_counters::events] = { }; // Position of each counter in the group
+};
+
+////////////////////////////////////////////////////////////////////////
+// perf_sampler
+//
+
+/// Calls a function with the deltas of a `perf_counters` between its construction and destruction. Nothing is called if the counters cannot be read.
+template<class F>
+class xtd::perf_sampler
+{
+public:
+	perf_sampler(perf_counters& counters, F f)
+	: _counters(counters)
+	, _f(std::move(f))
+	{
+		_valid = _counters.read(_start);
+	}
+	perf_sampler(perf_sampler&& other)
+	: _counters(other._counters)
+	, _f(std::move(other._f))
+	, _start(other._start)
+	, _valid(other._valid)
+	{
+		other._valid = false;
+	}
+	perf_sampler& operator=(perf_sampler&&) = delete;
+	~perf_sampler()
+	{
+		perf_counts end;
+		if(_valid && _counters.read(end))
+			_f(end - _start);
+	}
+
+private:
+	perf_counters& _counters;
+	F _f;
+	perf_counts _start;
+	bool _valid;
+};
+
+template<class F>
+auto xtd::make_perf_sampler(perf_counters& counters, F&& f) -> perf_sampler<std::decay_t<F>>
+{
+	return {counters, std::forward<F>(f)};
+}
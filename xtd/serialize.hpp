@@ -0,0 +1,640 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+/**
+ \file
+ Compact binary serialization of aggregates exposing their members through a `tie()` member function.
+
+ A type takes part in serialization by providing a member function `tie()` returning a `std::tuple` of references to its members, usually by means of `std::tie`. Only a non-const `tie()` is required.
+
+ ~~~cpp
+ struct Record
+ {
+     std::uint32_t id;
+     double weight;
+     std::string name;
+     std::vector<float> samples;
+     xtd::optional<Record2> extra;
+
+     auto tie() { return std::tie(id, weight, name, samples, extra); }
+ };
+
+ out << xtd::serialized(record);
+ in >> xtd::serialized(record);
+ ~~~
+
+ The encoding of a value is determined by its type:
+ - Trivially copyable types without `tie()` are stored as their object representation in native byte order, the same way `xtd::unformatted` does. Consecutive members of such types are combined and transferred with a single write or read.
+ - Types with `tie()` and `std::tuple` store their elements in order.
+ - `std::basic_string`, `xtd::basic_string_view` and `std::vector` store their number of elements as a LEB128 variable length integer followed by the elements. Vectors of trivially copyable types are transferred in bulk.
+ - `xtd::optional` stores one byte indicating whether it is engaged followed by the value if it is.
+
+ Pointers cannot be serialized. `basic_string_view` members can only be deserialized from a memory buffer and refer into that buffer afterwards.
+
+ \author Miro Knejp
+ */
+
+#pragma once
+
+#include <xtd/array_view.hpp>
+#include <xtd/optional.hpp>
+#include <xtd/string_view.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace xtd
+{
+	/// Thrown when deserializing from a memory buffer which is too short or malformed.
+	class serialization_error : public std::runtime_error
+	{
+	public:
+		using runtime_error::runtime_error;
+	};
+
+	/// Append the serialized representation of `value` to `buffer`.
+	template<class T>
+	void serialize(std::vector<unsigned char>& buffer, const T& value);
+
+	/// Return the serialized representation of `value`.
+	template<class T>
+	std::vector<unsigned char> serialize(const T& value);
+
+	/// Write the serialized representation of `value` to `out`.
+	template<class T, class CharT, class Traits>
+	std::basic_ostream<CharT, Traits>& serialize(std::basic_ostream<CharT, Traits>& out, const T& value);
+
+	/**
+	 Deserialize `value` from the beginning of `buffer`.
+
+	 `basic_string_view` members of `value` refer into `buffer` afterwards.
+
+	 \returns The number of bytes consumed.
+	 \throws serialization_error if `buffer` is too short or malformed.
+	 */
+	template<class T>
+	std::size_t deserialize(array_view<const unsigned char> buffer, T& value);
+
+	/**
+	 Deserialize `value` from `in`.
+
+	 If reading fails or the data is malformed the stream's `failbit` is set and `value` is left in a valid but unspecified state.
+	 */
+	template<class T, class CharT, class Traits>
+	std::basic_istream<CharT, Traits>& deserialize(std::basic_istream<CharT, Traits>& in, T& value);
+
+	namespace detail
+	{
+		namespace serialize
+		{
+			template<class T>
+			struct Manipulator
+			{
+				T* target;
+			};
+		}
+	}
+
+	/**
+	 A manipulator for std::basic_*stream to serialize or deserialize an object.
+
+	 \code
+	 out << xtd::serialized(header) << xtd::serialized(records);
+	 in >> xtd::serialized(header) >> xtd::serialized(records);
+	 \endcode
+	 */
+	template<class T>
+	detail::serialize::Manipulator<T> serialized(T& value)
+	{
+		return {&value};
+	}
+}
+
+////////////////////////////////////////////////////////////////////////
+// Private parts, do not look.
+//
+
+namespace xtd
+{
+	namespace detail
+	{
+		namespace serialize
+		{
+			template<class T, class = void>
+			struct HasTie : std::false_type { };
+			template<class T>
+			struct HasTie<T, decltype(void(std::declval<T&>().tie()))> : std::true_type { };
+
+			// Types with a dedicated encoding even if they are trivially copyable
+			template<class T>
+			struct IsSpecial : std::false_type { };
+			template<class CharT, class Traits, class Allocator>
+			struct IsSpecial<std::basic_string<CharT, Traits, Allocator>> : std::true_type { };
+			template<class CharT, class Traits>
+			struct IsSpecial<basic_string_view<CharT, Traits>> : std::true_type { };
+			template<class T, class Allocator>
+			struct IsSpecial<std::vector<T, Allocator>> : std::true_type { };
+			template<class T>
+			struct IsSpecial<xtd::optional<T>> : std::true_type { };
+			template<class... Ts>
+			struct IsSpecial<std::tuple<Ts...>> : std::true_type { };
+			template<class T>
+			struct IsSpecial<array_view<T>> : std::true_type { };
+
+			// Types stored as their object representation
+			template<class T>
+			struct IsBlittable : std::integral_constant<bool,
+				std::is_trivially_copyable<T>::value && !std::is_pointer<T>::value && !std::is_member_pointer<T>::value
+				&& !HasTie<T>::value && !IsSpecial<T>::value> { };
+
+			////////////////////////////////////////////////////////////////
+			// Sinks and sources
+
+			class BufferSink
+			{
+			public:
+				explicit BufferSink(std::vector<unsigned char>& buffer) noexcept : _buffer(buffer) { }
+
+				void write(const void* p, std::size_t n)
+				{
+					auto bytes = static_cast<const unsigned char*>(p);
+					_buffer.insert(_buffer.end(), bytes, bytes + n);
+				}
+
+			private:
+				std::vector<unsigned char>& _buffer;
+			};
+
+			template<class CharT, class Traits>
+			class StreamSink
+			{
+			public:
+				explicit StreamSink(std::basic_ostream<CharT, Traits>& out) noexcept : _out(out) { }
+
+				void write(const void* p, std::size_t n)
+				{
+					_out.write(static_cast<const CharT*>(p), static_cast<std::streamsize>(n));
+				}
+
+			private:
+				std::basic_ostream<CharT, Traits>& _out;
+			};
+
+			class BufferSource
+			{
+			public:
+				static constexpr bool zero_copy = true;
+
+				explicit BufferSource(array_view<const unsigned char> buffer) noexcept : _p(buffer.data()), _end(buffer.data() + buffer.size()) { }
+
+				bool good() const noexcept { return true; }
+				std::size_t remaining() const noexcept { return static_cast<std::size_t>(_end - _p); }
+				const unsigned char* position() const noexcept { return _p; }
+
+				void read(void* p, std::size_t n)
+				{
+					std::memcpy(p, view(n), n);
+				}
+				[[noreturn]] void fail(const char* what)
+				{
+					throw serialization_error{what};
+				}
+				// Skip over n bytes and return a pointer to them
+				const unsigned char* view(std::size_t n)
+				{
+					if(n > remaining())
+						throw serialization_error{"xtd::deserialize: buffer too short."};
+					auto p = _p;
+					_p += n;
+					return p;
+				}
+
+			private:
+				const unsigned char* _p;
+				const unsigned char* _end;
+			};
+
+			template<class CharT, class Traits>
+			class StreamSource
+			{
+			public:
+				static constexpr bool zero_copy = false;
+
+				explicit StreamSource(std::basic_istream<CharT, Traits>& in) noexcept : _in(in) { }
+
+				bool good() const noexcept { return !_in.fail(); }
+				std::size_t remaining() const noexcept { return good() ? std::numeric_limits<std::size_t>::max() : 0; }
+
+				// After a failure reads yield zeroes so the remaining structure decodes as empty
+				void read(void* p, std::size_t n)
+				{
+					if(!good() || !_in.read(static_cast<CharT*>(p), static_cast<std::streamsize>(n)))
+						std::memset(p, 0, n);
+				}
+				void fail(const char*)
+				{
+					_in.setstate(std::ios_base::failbit);
+				}
+
+			private:
+				std::basic_istream<CharT, Traits>& _in;
+			};
+
+			////////////////////////////////////////////////////////////////
+			// Variable length sizes
+
+			template<class Sink>
+			void write_size(Sink& sink, std::uint64_t size)
+			{
+				unsigned char bytes[10];
+				std::size_t n = 0;
+				for(; size >= 0x80; size >>= 7)
+					bytes[n++] = static_cast<unsigned char>(size | 0x80);
+				bytes[n++] = static_cast<unsigned char>(size);
+				sink.write(bytes, n);
+			}
+
+			template<class Source>
+			std::size_t read_size(Source& source)
+			{
+				std::uint64_t size = 0;
+				for(unsigned shift = 0; shift < 64; shift += 7)
+				{
+					unsigned char byte;
+					source.read(&byte, 1);
+					size |= std::uint64_t(byte & 0x7F) << shift;
+					if((byte & 0x80) == 0)
+					{
+						if(size > std::numeric_limits<std::size_t>::max())
+							break;
+						return static_cast<std::size_t>(size);
+					}
+				}
+				source.fail("xtd::deserialize: malformed size.");
+				return 0;
+			}
+
+			// Number of elements which can be read at most from source when each takes at least min_bytes
+			template<class Source>
+			std::size_t checked_count(Source& source, std::size_t count, std::size_t min_bytes)
+			{
+				if(Source::zero_copy && count > source.remaining() / min_bytes)
+					throw serialization_error{"xtd::deserialize: buffer too short."};
+				return count;
+			}
+
+			////////////////////////////////////////////////////////////////
+			// Codecs
+
+			template<class T, class = void>
+			struct Codec
+			{
+				static_assert(!std::is_pointer<T>::value, "xtd::serialize: Pointers cannot be serialized.");
+				static_assert(std::is_pointer<T>::value, "xtd::serialize: Type is neither trivially copyable nor does it provide tie().");
+			};
+
+			template<class Sink, class T>
+			void write(Sink& sink, const T& value)
+			{
+				Codec<T>::write(sink, value);
+			}
+			template<class Source, class T>
+			void read(Source& source, T& value)
+			{
+				Codec<T>::read(source, value);
+			}
+
+			template<class T>
+			struct Codec<T, std::enable_if_t<IsBlittable<T>::value>>
+			{
+				template<class Sink>
+				static void write(Sink& sink, const T& value)
+				{
+					sink.write(&value, sizeof(T));
+				}
+				template<class Source>
+				static void read(Source& source, T& value)
+				{
+					source.read(&value, sizeof(T));
+				}
+			};
+
+			// Length of the run of blittable elements in Tuple starting at index I
+			template<class Tuple, std::size_t I, bool = (I < std::tuple_size<Tuple>::value)>
+			struct RunLength : std::integral_constant<std::size_t, 0> { };
+			template<class Tuple, std::size_t I>
+			struct RunLength<Tuple, I, true>
+			: std::integral_constant<std::size_t, IsBlittable<std::decay_t<std::tuple_element_t<I, Tuple>>>::value ? 1 + RunLength<Tuple, I + 1>::value : 0> { };
+
+			template<class Tuple, std::size_t I, std::size_t... J>
+			constexpr std::size_t run_bytes(std::index_sequence<J...>)
+			{
+				std::size_t sizes[] = { 0, sizeof(std::decay_t<std::tuple_element_t<I + J, Tuple>>)... };
+				std::size_t sum = 0;
+				for(auto s : sizes)
+					sum += s;
+				return sum;
+			}
+
+			template<class Tuple, std::size_t I = 0, std::size_t Run = RunLength<Tuple, I>::value, bool = (I < std::tuple_size<Tuple>::value)>
+			struct TupleCodec
+			{
+				// Past the end
+				template<class Sink>
+				static void write(Sink&, const Tuple&) { }
+				template<class Source>
+				static void read(Source&, const Tuple&) { }
+			};
+
+			// Element I is not blittable
+			template<class Tuple, std::size_t I>
+			struct TupleCodec<Tuple, I, 0, true>
+			{
+				template<class Sink>
+				static void write(Sink& sink, const Tuple& t)
+				{
+					serialize::write(sink, static_cast<const std::decay_t<std::tuple_element_t<I, Tuple>>&>(std::get<I>(t)));
+					TupleCodec<Tuple, I + 1>::write(sink, t);
+				}
+				template<class Source>
+				static void read(Source& source, const Tuple& t)
+				{
+					serialize::read(source, const_cast<std::decay_t<std::tuple_element_t<I, Tuple>>&>(std::get<I>(t)));
+					TupleCodec<Tuple, I + 1>::read(source, t);
+				}
+			};
+
+			// Elements [I, I + Run) are blittable and transferred in one go
+			template<class Tuple, std::size_t I, std::size_t Run>
+			struct TupleCodec<Tuple, I, Run, true>
+			{
+				static constexpr std::size_t bytes = run_bytes<Tuple, I>(std::make_index_sequence<Run>{});
+
+				template<class Sink>
+				static void write(Sink& sink, const Tuple& t)
+				{
+					unsigned char buffer[bytes];
+					pack(buffer, t, std::make_index_sequence<Run>{});
+					sink.write(buffer, bytes);
+					TupleCodec<Tuple, I + Run>::write(sink, t);
+				}
+				template<class Source>
+				static void read(Source& source, const Tuple& t)
+				{
+					unsigned char buffer[bytes];
+					source.read(buffer, bytes);
+					unpack(buffer, t, std::make_index_sequence<Run>{});
+					TupleCodec<Tuple, I + Run>::read(source, t);
+				}
+
+			private:
+				template<std::size_t... J>
+				static void pack(unsigned char* p, const Tuple& t, std::index_sequence<J...>)
+				{
+					int expand[] = { 0, (std::memcpy(p, &std::get<I + J>(t), sizeof(std::get<I + J>(t))), p += sizeof(std::get<I + J>(t)), 0)... };
+					(void)expand;
+				}
+				template<std::size_t... J>
+				static void unpack(const unsigned char* p, const Tuple& t, std::index_sequence<J...>)
+				{
+					int expand[] = { 0, (std::memcpy(const_cast<std::decay_t<std::tuple_element_t<I + J, Tuple>>*>(&std::get<I + J>(t)), p, sizeof(std::get<I + J>(t))), p += sizeof(std::get<I + J>(t)), 0)... };
+					(void)expand;
+				}
+			};
+
+			template<class T>
+			struct Codec<T, std::enable_if_t<HasTie<T>::value>>
+			{
+				template<class Sink>
+				static void write(Sink& sink, const T& value)
+				{
+					// tie() is not required to be const, but nothing is modified
+					auto t = const_cast<T&>(value).tie();
+					TupleCodec<decltype(t)>::write(sink, t);
+				}
+				template<class Source>
+				static void read(Source& source, T& value)
+				{
+					auto t = value.tie();
+					TupleCodec<decltype(t)>::read(source, t);
+				}
+			};
+
+			template<class... Ts>
+			struct Codec<std::tuple<Ts...>>
+			{
+				template<class Sink>
+				static void write(Sink& sink, const std::tuple<Ts...>& value)
+				{
+					TupleCodec<std::tuple<Ts...>>::write(sink, value);
+				}
+				template<class Source>
+				static void read(Source& source, std::tuple<Ts...>& value)
+				{
+					TupleCodec<std::tuple<Ts...>>::read(source, value);
+				}
+			};
+
+			template<class CharT, class Traits, class Allocator>
+			struct Codec<std::basic_string<CharT, Traits, Allocator>>
+			{
+				static_assert(IsBlittable<CharT>::value, "xtd::serialize: String character type must be trivially copyable.");
+
+				template<class Sink>
+				static void write(Sink& sink, const std::basic_string<CharT, Traits, Allocator>& value)
+				{
+					write_size(sink, value.size());
+					sink.write(value.data(), value.size() * sizeof(CharT));
+				}
+				template<class Source>
+				static void read(Source& source, std::basic_string<CharT, Traits, Allocator>& value)
+				{
+					auto size = checked_count(source, read_size(source), sizeof(CharT));
+					value.clear();
+					// Grow in steps so a corrupt size from a stream cannot exhaust memory before reading fails
+					constexpr std::size_t step = (1 << 16) / sizeof(CharT);
+					for(std::size_t done = 0; done < size && source.good(); )
+					{
+						auto n = Source::zero_copy ? size : std::min(step, size - done);
+						value.resize(done + n);
+						source.read(&value[done], n * sizeof(CharT));
+						done += n;
+					}
+				}
+			};
+
+			template<class CharT, class Traits>
+			struct Codec<basic_string_view<CharT, Traits>>
+			{
+				template<class Sink>
+				static void write(Sink& sink, basic_string_view<CharT, Traits> value)
+				{
+					write_size(sink, value.size());
+					sink.write(value.data(), value.size() * sizeof(CharT));
+				}
+				static void read(BufferSource& source, basic_string_view<CharT, Traits>& value)
+				{
+					static_assert(alignof(CharT) == 1, "xtd::deserialize: Only string views of single-byte characters can refer into a buffer.");
+					auto size = checked_count(source, read_size(source), sizeof(CharT));
+					value = {reinterpret_cast<const CharT*>(source.view(size * sizeof(CharT))), size};
+				}
+				template<class Source>
+				static void read(Source&, basic_string_view<CharT, Traits>&)
+				{
+					static_assert(Source::zero_copy, "xtd::deserialize: String views can only be deserialized from a memory buffer.");
+				}
+			};
+
+			template<class T, class Allocator>
+			struct Codec<std::vector<T, Allocator>>
+			{
+				template<class Sink>
+				static void write(Sink& sink, const std::vector<T, Allocator>& value)
+				{
+					write_size(sink, value.size());
+					write_elements(sink, value, IsBlittable<T>{});
+				}
+				template<class Source>
+				static void read(Source& source, std::vector<T, Allocator>& value)
+				{
+					read_elements(source, value, read_size(source), IsBlittable<T>{});
+				}
+
+			private:
+				template<class Sink>
+				static void write_elements(Sink& sink, const std::vector<T, Allocator>& value, std::true_type)
+				{
+					sink.write(value.data(), value.size() * sizeof(T));
+				}
+				template<class Sink>
+				static void write_elements(Sink& sink, const std::vector<T, Allocator>& value, std::false_type)
+				{
+					for(auto& x : value)
+						serialize::write(sink, x);
+				}
+				template<class Source>
+				static void read_elements(Source& source, std::vector<T, Allocator>& value, std::size_t size, std::true_type)
+				{
+					size = checked_count(source, size, sizeof(T));
+					value.clear();
+					// Grow in steps so a corrupt size from a stream cannot exhaust memory before reading fails
+					constexpr std::size_t step = (1 << 16) / sizeof(T) + 1;
+					for(std::size_t done = 0; done < size && source.good(); )
+					{
+						auto n = Source::zero_copy ? size : std::min(step, size - done);
+						value.resize(done + n);
+						source.read(value.data() + done, n * sizeof(T));
+						done += n;
+					}
+				}
+				template<class Source>
+				static void read_elements(Source& source, std::vector<T, Allocator>& value, std::size_t size, std::false_type)
+				{
+					value.clear();
+					// Stream sources do not know how much is left, so only reserve a bounded step and let the vector grow from there
+					constexpr std::size_t step = (1 << 16) / sizeof(T) + 1;
+					value.reserve(std::min({size, source.remaining(), step}));
+					for(std::size_t i = 0; i < size && source.good(); ++i)
+					{
+						value.emplace_back();
+						serialize::read(source, value.back());
+					}
+				}
+			};
+
+			template<class T>
+			struct Codec<xtd::optional<T>>
+			{
+				template<class Sink>
+				static void write(Sink& sink, const xtd::optional<T>& value)
+				{
+					unsigned char engaged = value ? 1 : 0;
+					sink.write(&engaged, 1);
+					if(value)
+						serialize::write(sink, *value);
+				}
+				template<class Source>
+				static void read(Source& source, xtd::optional<T>& value)
+				{
+					unsigned char engaged;
+					source.read(&engaged, 1);
+					if(engaged > 1)
+						source.fail("xtd::deserialize: malformed optional.");
+					else if(engaged)
+					{
+						if(!value)
+							value.emplace();
+						serialize::read(source, *value);
+					}
+					else
+						value = nullopt;
+				}
+			};
+
+			template<class T, class CharT, class Traits>
+			std::basic_ostream<CharT, Traits>& operator<< (std::basic_ostream<CharT, Traits>& out, Manipulator<T> m)
+			{
+				return xtd::serialize(out, *m.target);
+			}
+			template<class T, class CharT, class Traits>
+			std::basic_istream<CharT, Traits>& operator>> (std::basic_istream<CharT, Traits>& in, Manipulator<T> m)
+			{
+				return xtd::deserialize(in, *m.target);
+			}
+		}
+	}
+}
+
+template<class T>
+void xtd::serialize(std::vector<unsigned char>& buffer, const T& value)
+{
+	detail::serialize::BufferSink sink{buffer};
+	detail::serialize::write(sink, value);
+}
+
+template<class T>
+std::vector<unsigned char> xtd::serialize(const T& value)
+{
+	std::vector<unsigned char> buffer;
+	serialize(buffer, value);
+	return buffer;
+}
+
+template<class T, class CharT, class Traits>
+std::basic_ostream<CharT, Traits>& xtd::serialize(std::basic_ostream<CharT, Traits>& out, const T& value)
+{
+	static_assert(sizeof(CharT) == 1, "xtd::serialize: Only streams with single-byte elements are supported.");
+	detail::serialize::StreamSink<CharT, Traits> sink{out};
+	detail::serialize::write(sink, value);
+	return out;
+}
+
+template<class T>
+std::size_t xtd::deserialize(array_view<const unsigned char> buffer, T& value)
+{
+	detail::serialize::BufferSource source{buffer};
+	detail::serialize::read(source, value);
+	return static_cast<std::size_t>(source.position() - buffer.data());
+}
+
+template<class T, class CharT, class Traits>
+std::basic_istream<CharT, Traits>& xtd::deserialize(std::basic_istream<CharT, Traits>& in, T& value)
+{
+	static_assert(sizeof(CharT) == 1, "xtd::deserialize: Only streams with single-byte elements are supported.");
+	detail::serialize::StreamSource<CharT, Traits> source{in};
+	detail::serialize::read(source, value);
+	return in;
+}
@@ -0,0 +1,280 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+/**
+ \file
+ Stream buffers and streams operating directly on caller-provided memory.
+
+ Unlike `std::stringstream` these never copy or allocate: input streams read from an `array_view` or `string_view` in place and output streams write into a preallocated `array_view`, failing once it is full.
+
+ ~~~cpp
+ void on_packet(xtd::array_view<const char> packet)
+ {
+     xtd::ispanstream in{packet};
+     header h;
+     in >> xtd::unformatted(h);
+ }
+
+ char buffer[512];
+ xtd::ospanstream out{buffer};
+ out << xtd::unformatted(h) << payload;
+ send(out.span());
+ ~~~
+
+ \author Miro Knejp
+ */
+
+#pragma once
+
+#include <xtd/array_view.hpp>
+#include <xtd/string_view.hpp>
+
+#include <cstddef>
+#include <ios>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+namespace xtd
+{
+	template<class CharT, class Traits = std::char_traits<CharT>>
+	class basic_viewbuf;
+	template<class CharT, class Traits = std::char_traits<CharT>>
+	class basic_ispanstream;
+	template<class CharT, class Traits = std::char_traits<CharT>>
+	class basic_ospanstream;
+	template<class CharT, class Traits = std::char_traits<CharT>>
+	class basic_spanstream;
+
+	/// \name Span stream specializations
+	//@{
+
+	using viewbuf = basic_viewbuf<char>;
+	using wviewbuf = basic_viewbuf<wchar_t>;
+	using ispanstream = basic_ispanstream<char>;
+	using wispanstream = basic_ispanstream<wchar_t>;
+	using ospanstream = basic_ospanstream<char>;
+	using wospanstream = basic_ospanstream<wchar_t>;
+	using spanstream = basic_spanstream<char>;
+	using wspanstream = basic_spanstream<wchar_t>;
+
+	//@}
+}
+
+////////////////////////////////////////////////////////////////////////
+// basic_viewbuf
+//
+
+/**
+ A stream buffer reading from and/or writing to a fixed range of characters it does not own.
+
+ Reading stops at the end of the range, writing fails once the range is full. Both positions can be moved freely within the range with `pubseekoff` and `pubseekpos`.
+ */
+template<class CharT, class Traits>
+class xtd::basic_viewbuf : public std::basic_streambuf<CharT, Traits>
+{
+public:
+	using char_type = CharT;
+	using traits_type = Traits;
+	using int_type = typename Traits::int_type;
+	using pos_type = typename Traits::pos_type;
+	using off_type = typename Traits::off_type;
+
+	/// Create a buffer without a range.
+	basic_viewbuf() noexcept : basic_viewbuf(std::ios_base::in | std::ios_base::out) { }
+	explicit basic_viewbuf(std::ios_base::openmode mode) noexcept : _mode(mode) { }
+	/// Read from and/or write to `chars`.
+	explicit basic_viewbuf(array_view<CharT> chars, std::ios_base::openmode mode = std::ios_base::in | std::ios_base::out) noexcept
+	: _mode(mode)
+	{
+		span(chars);
+	}
+	/// Read from `chars`.
+	explicit basic_viewbuf(array_view<const CharT> chars) noexcept
+	: _mode(std::ios_base::in)
+	{
+		span(chars);
+	}
+	/// Read from `str`.
+	explicit basic_viewbuf(basic_string_view<CharT, Traits> str) noexcept
+	: basic_viewbuf(array_view<const CharT>{str.data(), str.size()})
+	{
+	}
+
+	/**
+	 The range of characters in use.
+
+	 If the buffer is only used for output this is the part written so far, otherwise the whole range.
+	 */
+	array_view<CharT> span() const noexcept
+	{
+		if((_mode & (std::ios_base::in | std::ios_base::out)) == std::ios_base::out)
+			return {this->pbase(), static_cast<std::size_t>(this->pptr() - this->pbase())};
+		return {_begin, static_cast<std::size_t>(_end - _begin)};
+	}
+	/// Replace the range and reset both positions to its beginning.
+	void span(array_view<CharT> chars) noexcept
+	{
+		assign(chars.data(), chars.size(), false);
+	}
+	/// Replace the range with a read-only one. Writing fails until the next writable range is set, the open mode is unchanged.
+	void span(array_view<const CharT> chars) noexcept
+	{
+		// Writing is never enabled for const ranges, and putback does not store characters
+		assign(const_cast<CharT*>(chars.data()), chars.size(), true);
+	}
+
+protected:
+	std::basic_streambuf<CharT, Traits>* setbuf(CharT* s, std::streamsize n) override
+	{
+		span(array_view<CharT>{s, static_cast<std::size_t>(n)});
+		return this;
+	}
+
+	pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which = std::ios_base::in | std::ios_base::out) override
+	{
+		which &= active_mode();
+		const bool in = (which & std::ios_base::in) != 0;
+		const bool out = (which & std::ios_base::out) != 0;
+		if((!in && !out) || (in && out && dir == std::ios_base::cur))
+			return pos_type(off_type(-1));
+
+		off_type base = 0;
+		if(dir == std::ios_base::cur)
+			base = in ? this->gptr() - this->eback() : this->pptr() - this->pbase();
+		else if(dir == std::ios_base::end)
+			base = (out && !(_mode & std::ios_base::in)) ? this->pptr() - this->pbase() : _end - _begin;
+
+		if((off < 0 && -off > base) || (off > 0 && off > (_end - _begin) - base))
+			return pos_type(off_type(-1));
+		auto pos = base + off;
+		if(in)
+			this->setg(_begin, _begin + pos, _end);
+		if(out)
+			set_pptr(pos);
+		return pos_type(pos);
+	}
+
+	pos_type seekpos(pos_type pos, std::ios_base::openmode which = std::ios_base::in | std::ios_base::out) override
+	{
+		return seekoff(off_type(pos), std::ios_base::beg, which);
+	}
+
+	std::streamsize showmanyc() override
+	{
+		return this->gptr() < this->egptr() ? this->egptr() - this->gptr() : -1;
+	}
+
+private:
+	void assign(CharT* first, std::size_t size, bool read_only) noexcept
+	{
+		_begin = first;
+		_end = first + size;
+		_read_only = read_only;
+		this->setg(nullptr, nullptr, nullptr);
+		this->setp(nullptr, nullptr);
+		if(active_mode() & std::ios_base::in)
+			this->setg(_begin, _begin, _end);
+		if(active_mode() & std::ios_base::out)
+			this->setp(_begin, _end);
+	}
+
+	// The open mode without output for a read-only range
+	std::ios_base::openmode active_mode() const noexcept
+	{
+		return _read_only ? _mode & ~std::ios_base::out : _mode;
+	}
+
+	void set_pptr(off_type pos)
+	{
+		// pbump only takes int
+		this->setp(_begin, _end);
+		for(; pos > std::numeric_limits<int>::max(); pos -= std::numeric_limits<int>::max())
+			this->pbump(std::numeric_limits<int>::max());
+		this->pbump(static_cast<int>(pos));
+	}
+
+	std::ios_base::openmode _mode;
+	CharT* _begin = nullptr;
+	CharT* _end = nullptr;
+	bool _read_only = false;
+};
+
+////////////////////////////////////////////////////////////////////////
+// Streams
+//
+
+/// An input stream reading from a range of characters in place.
+template<class CharT, class Traits>
+class xtd::basic_ispanstream : public std::basic_istream<CharT, Traits>
+{
+public:
+	explicit basic_ispanstream(array_view<const CharT> chars)
+	: std::basic_istream<CharT, Traits>(nullptr)
+	, _buf(chars)
+	{
+		this->init(&_buf);
+	}
+	explicit basic_ispanstream(basic_string_view<CharT, Traits> str)
+	: basic_ispanstream(array_view<const CharT>{str.data(), str.size()})
+	{
+	}
+
+	basic_viewbuf<CharT, Traits>* rdbuf() const noexcept { return const_cast<basic_viewbuf<CharT, Traits>*>(&_buf); }
+	/// The range being read.
+	array_view<const CharT> span() const noexcept { return _buf.span(); }
+	/// Start reading from a new range. Does not clear the stream state.
+	void span(array_view<const CharT> chars) noexcept { _buf.span(chars); }
+
+private:
+	basic_viewbuf<CharT, Traits> _buf;
+};
+
+/// An output stream writing into a preallocated range of characters, failing once it is full.
+template<class CharT, class Traits>
+class xtd::basic_ospanstream : public std::basic_ostream<CharT, Traits>
+{
+public:
+	explicit basic_ospanstream(array_view<CharT> chars)
+	: std::basic_ostream<CharT, Traits>(nullptr)
+	, _buf(chars, std::ios_base::out)
+	{
+		this->init(&_buf);
+	}
+
+	basic_viewbuf<CharT, Traits>* rdbuf() const noexcept { return const_cast<basic_viewbuf<CharT, Traits>*>(&_buf); }
+	/// The characters written so far.
+	array_view<CharT> span() const noexcept { return _buf.span(); }
+	/// Start writing into a new range. Does not clear the stream state.
+	void span(array_view<CharT> chars) noexcept { _buf.span(chars); }
+
+private:
+	basic_viewbuf<CharT, Traits> _buf;
+};
+
+/// A stream reading from and writing to a range of characters in place.
+template<class CharT, class Traits>
+class xtd::basic_spanstream : public std::basic_iostream<CharT, Traits>
+{
+public:
+	explicit basic_spanstream(array_view<CharT> chars)
+	: std::basic_iostream<CharT, Traits>(nullptr)
+	, _buf(chars)
+	{
+		this->init(&_buf);
+	}
+
+	basic_viewbuf<CharT, Traits>* rdbuf() const noexcept { return const_cast<basic_viewbuf<CharT, Traits>*>(&_buf); }
+	/// The whole range.
+	array_view<CharT> span() const noexcept { return _buf.span(); }
+	/// Start reading and writing at the beginning of a new range. Does not clear the stream state.
+	void span(array_view<CharT> chars) noexcept { _buf.span(chars); }
+
+private:
+	basic_viewbuf<CharT, Traits> _buf;
+};
@@ -0,0 +1,328 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+/**
+ \file
+ Search structures for sorted arrays which never change, storing the elements in an order that needs fewer cache misses per lookup than binary search.
+
+ A binary search over a large array touches a new cache line for almost every comparison and the first few levels are shared by all searches, but the rest are not. `eytzinger_index` stores the elements in breadth first order of the implicit search tree so the descendants several levels down are in one cache line and can be prefetched. `static_btree` stores them in nodes of `B` keys filling a cache line, so each cache line read narrows the search down by a factor of `B + 1`.
+
+ Both are built once from a sorted array and report positions in that array.
+
+ ~~~cpp
+ std::vector<std::uint32_t> ids = ...; // Sorted
+ xtd::static_btree<std::uint32_t> index{xtd::make_array_view(ids.data(), ids.size())};
+ auto i = index.lower_bound(42); // Same as std::lower_bound(ids.begin(), ids.end(), 42) - ids.begin()
+ ~~~
+
+ \author Miro Knejp
+ */
+
+#pragma once
+
+#include <xtd/algorithm.hpp>
+#include <xtd/array_view.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace xtd
+{
+	template<class T>
+	class eytzinger_index;
+	template<class T, std::size_t B = (64 % sizeof(T) == 0 ? 64 / sizeof(T) : 1)>
+	class static_btree;
+}
+
+////////////////////////////////////////////////////////////////////////
+// Private parts, do not look.
+//
+
+namespace xtd
+{
+	namespace detail
+	{
+		namespace static_search
+		{
+			constexpr std::size_t cache_line = 64;
+
+			// Elements per cache line if they tile it exactly, otherwise one
+			template<class T>
+			constexpr std::size_t per_cache_line() noexcept
+			{
+				return cache_line % sizeof(T) == 0 ? cache_line / sizeof(T) : 1;
+			}
+
+			inline void prefetch(const void* p) noexcept
+			{
+#if defined(__GNUC__) || defined(__clang__)
+				__builtin_prefetch(p);
+#else
+				(void)p;
+#endif
+			}
+
+			inline unsigned log2(std::size_t x) noexcept
+			{
+#if defined(__GNUC__) || defined(__clang__)
+				return static_cast<unsigned>(sizeof(unsigned long long) * 8 - 1) - static_cast<unsigned>(__builtin_clzll(x));
+#else
+				unsigned n = 0;
+				while(x >>= 1)
+					++n;
+				return n;
+#endif
+			}
+
+			inline unsigned trailing_ones(std::size_t x) noexcept
+			{
+#if defined(__GNUC__) || defined(__clang__)
+				return static_cast<unsigned>(__builtin_ctzll(~static_cast<unsigned long long>(x)));
+#else
+				unsigned n = 0;
+				for(; x & 1; x >>= 1)
+					++n;
+				return n;
+#endif
+			}
+
+			// Allocate n elements in a vector and return the offset of the first one aligned to a cache line
+			template<class T>
+			std::size_t allocate_aligned(std::vector<T>& storage, std::size_t n)
+			{
+				constexpr auto slack = per_cache_line<T>();
+				storage.resize(n + slack);
+				auto address = reinterpret_cast<std::uintptr_t>(storage.data());
+				auto misalignment = (cache_line - address % cache_line) % cache_line;
+				return slack > 1 && misalignment % sizeof(T) == 0 ? misalignment / sizeof(T) : 0;
+			}
+
+			// Number of keys in node less than value
+			template<std::size_t B, class T>
+			std::size_t count_less(const T* node, const T& value, std::false_type /* vectorizable */) noexcept
+			{
+				std::size_t n = 0;
+				for(std::size_t i = 0; i < B; ++i)
+					n += node[i] < value;
+				return n;
+			}
+
+#if defined(XTD_ALGORITHM_VECTOR_EXTENSIONS)
+
+			template<std::size_t B, class T>
+			std::size_t count_less(const T* node, const T& value, std::true_type /* vectorizable */) noexcept
+			{
+				constexpr auto size = B * sizeof(T) % detail::algorithm::vector_size == 0 ? detail::algorithm::vector_size : 16;
+				typedef T V __attribute__((vector_size(size)));
+				using M = decltype(V{} < V{});
+				constexpr std::size_t lanes = sizeof(V) / sizeof(T);
+				V x;
+				for(std::size_t k = 0; k < lanes; ++k)
+					x[k] = value;
+				// Comparisons yield -1 for each true lane
+				M acc = {};
+				for(std::size_t i = 0; i < B; i += lanes)
+				{
+					V keys;
+					std::memcpy(&keys, node + i, sizeof(V));
+					acc += keys < x;
+				}
+				std::size_t n = 0;
+				for(std::size_t k = 0; k < lanes; ++k)
+					n -= static_cast<std::size_t>(static_cast<std::ptrdiff_t>(acc[k]));
+				return n;
+			}
+
+			template<std::size_t B, class T>
+			using vectorizable_node = std::integral_constant<bool, detail::algorithm::IsVectorizable<T>::value && B * sizeof(T) % 16 == 0>;
+#else
+			template<std::size_t B, class T>
+			using vectorizable_node = std::false_type;
+#endif
+
+			template<std::size_t B, class T>
+			std::size_t count_less(const T* node, const T& value) noexcept
+			{
+				return count_less<B>(node, value, vectorizable_node<B, T>{});
+			}
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////
+// eytzinger_index
+//
+
+/**
+ A sorted array in Eytzinger (breadth first) order.
+
+ Element `k` of the layout has its children at `2k` and `2k + 1`, with the root at `1`. A search descends from the root with one branchless comparison per level and prefetches the cache line holding the descendants as many levels down as the cache line fits, four for 4 byte elements and three for 8 byte ones, so the memory latency of deep levels overlaps with the comparisons above them. It needs as much memory as the sorted array.
+
+ Elements are compared with `operator<`.
+ */
+template<class T>
+class xtd::eytzinger_index
+{
+public:
+	/// An empty index.
+	eytzinger_index() = default;
+	/// Build the index for `sorted`, which must be sorted ascending.
+	explicit eytzinger_index(array_view<const T> sorted)
+	: _size(sorted.size())
+	{
+		_offset = detail::static_search::allocate_aligned(_storage, _size + 1);
+		auto nodes = _storage.data() + _offset;
+		for(std::size_t k = 1; k <= _size; ++k)
+			nodes[k] = sorted[rank(k)];
+	}
+
+	/// The position of the first element of the sorted array not less than `value`, or `size()` if there is none.
+	std::size_t lower_bound(const T& value) const noexcept
+	{
+		auto k = find(value);
+		return k == 0 ? _size : rank(k);
+	}
+	/// Whether an element equal to `value` exists.
+	bool contains(const T& value) const noexcept
+	{
+		auto k = find(value);
+		return k != 0 && !(value < _storage[_offset + k]);
+	}
+
+	/// The number of elements.
+	std::size_t size() const noexcept { return _size; }
+	/// Whether there are no elements.
+	bool empty() const noexcept { return _size == 0; }
+
+private:
+	// The node of the lower bound, or 0 if there is none
+	std::size_t find(const T& value) const noexcept
+	{
+		// With the layout aligned to a cache line the stride descendants log2(stride) levels down share one, 16 four levels down for 4 byte elements and 8 three levels down for 8 byte ones
+		constexpr auto stride = detail::static_search::per_cache_line<T>();
+		auto nodes = _storage.data() + _offset;
+		std::size_t k = 1;
+		while(k <= _size)
+		{
+			detail::static_search::prefetch(nodes + std::min(k * stride, _size));
+			k = 2 * k + static_cast<std::size_t>(nodes[k] < value);
+		}
+		// Undo the right turns after the last left turn, which was at the lower bound
+		return k >> (detail::static_search::trailing_ones(k) + 1);
+	}
+
+	// The position in the sorted array of node k
+	std::size_t rank(std::size_t k) const noexcept
+	{
+		using detail::static_search::log2;
+		// In-order position as if the last level were full, then skip the missing last level nodes before it
+		auto height = log2(_size);
+		auto depth = log2(k);
+		auto r = ((2 * (k - (std::size_t(1) << depth)) + 1) << (height - depth)) - 1;
+		auto last_level = _size - ((std::size_t(1) << height) - 1);
+		auto before = (r + 1) / 2;
+		return before > last_level ? r - (before - last_level) : r;
+	}
+
+	std::vector<T> _storage;
+	std::size_t _offset = 0; // _storage[_offset] is aligned to a cache line and unused
+	std::size_t _size = 0;
+};
+
+////////////////////////////////////////////////////////////////////////
+// static_btree
+//
+
+/**
+ A sorted array in the layout of a static B+ tree with `B` keys per node.
+
+ The sorted array itself forms the leaves, in nodes of `B` elements. Each layer above has a node for every `B + 1` nodes below, holding the smallest element of each child except the first. A search reads one node per layer, counting the keys less than the value to select the child, which is vectorized for arithmetic types. The default `B` fills a cache line. The layers above the leaves need about `1 / B` of the array's memory.
+
+ Elements are compared with `operator<`.
+ */
+template<class T, std::size_t B>
+class xtd::static_btree
+{
+	static_assert(B > 0, "xtd::static_btree: Nodes must have at least one key.");
+
+public:
+	/// An empty tree.
+	static_btree() = default;
+	/// Build the tree for `sorted`, which must be sorted ascending.
+	explicit static_btree(array_view<const T> sorted)
+	: _size(sorted.size())
+	{
+		if(_size == 0)
+			return;
+		// Nodes per layer, from the leaves up to the root
+		_layers.push_back({(_size + B - 1) / B, 0});
+		while(_layers.back().nodes > 1)
+			_layers.push_back({(_layers.back().nodes + B) / (B + 1), _layers.back().offset + _layers.back().nodes * B});
+		_offset = detail::static_search::allocate_aligned(_storage, _layers.back().offset + B);
+		auto keys = _storage.data() + _offset;
+
+		// Missing elements and children are represented by the largest element, which is never less than a value whose lower bound exists
+		const auto& last = sorted[_size - 1];
+		std::copy(sorted.begin(), sorted.end(), keys);
+		std::fill(keys + _size, keys + _layers[0].nodes * B, last);
+		std::size_t leaves_per_child = 1;
+		for(std::size_t j = 1; j < _layers.size(); ++j)
+		{
+			auto layer = keys + _layers[j].offset;
+			for(std::size_t k = 0; k < _layers[j].nodes; ++k)
+				for(std::size_t i = 0; i < B; ++i)
+				{
+					auto child = k * (B + 1) + i + 1;
+					layer[k * B + i] = child < _layers[j - 1].nodes ? sorted[child * leaves_per_child * B] : last;
+				}
+			leaves_per_child *= B + 1;
+		}
+	}
+
+	/// The position of the first element of the sorted array not less than `value`, or `size()` if there is none.
+	std::size_t lower_bound(const T& value) const noexcept
+	{
+		if(_size == 0)
+			return 0;
+		auto keys = _storage.data() + _offset;
+		std::size_t k = 0;
+		for(auto j = _layers.size() - 1; j > 0; --j)
+		{
+			k = k * (B + 1) + detail::static_search::count_less<B>(keys + _layers[j].offset + k * B, value);
+			// Only taken if all elements are less than value
+			k = std::min(k, _layers[j - 1].nodes - 1);
+		}
+		return std::min(k * B + detail::static_search::count_less<B>(keys + k * B, value), _size);
+	}
+	/// Whether an element equal to `value` exists.
+	bool contains(const T& value) const noexcept
+	{
+		auto i = lower_bound(value);
+		return i < _size && !(value < (*this)[i]);
+	}
+
+	/// The element at position `i` of the sorted array.
+	const T& operator[](std::size_t i) const noexcept { return _storage[_offset + i]; }
+	/// The number of elements.
+	std::size_t size() const noexcept { return _size; }
+	/// Whether there are no elements.
+	bool empty() const noexcept { return _size == 0; }
+
+private:
+	struct Layer
+	{
+		std::size_t nodes;
+		std::size_t offset;
+	};
+
+	std::vector<T> _storage;
+	std::size_t _offset = 0; // _storage[_offset] is the first leaf, aligned to a cache line
+	std::size_t _size = 0;
+	std::vector<Layer> _layers; // From the leaves to the root
+};
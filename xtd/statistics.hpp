@@ -0,0 +1,485 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+/**
+ \file
+ Single pass accumulators of summary statistics and quantiles which can be merged, so every thread or series can have its own and combine them later.
+
+ `running_stats` keeps the count, mean, variance, minimum and maximum in constant space. Batches are processed in blocks small enough to stay in the L1 cache: the sum, minimum and maximum of a block are found with SIMD lanes in a first pass, the squared deviations from the block's mean in a second, and the block is merged with the previous result using the parallel formulation of Welford's algorithm by Chan et al. This is as accurate as updating the mean per element but several times faster.
+
+ `quantile_sketch` is a KLL sketch (Karnin, Lang and Liberty, "Optimal Quantile Approximation in Streams"). Values are kept in a hierarchy of buffers, where a value in level `h` stands for `2^h` values of the input. When the sketch is full, a level is sorted and every other value, starting at a random one, moves up a level. It uses a few kilobytes regardless of the number of values, the accuracy is given at `quantile_sketch`.
+
+ ~~~cpp
+ std::vector<double> latencies = ...;
+ auto stats = xtd::statistics(xtd::execution::par, latencies);
+ xtd::quantile_sketch sketch;
+ sketch.push(latencies);
+ std::cout << stats.mean() << " +- " << stats.stddev() << ", p99 " << sketch.quantile(0.99) << '\n';
+ ~~~
+
+ \author Miro Knejp
+ */
+
+#pragma once
+
+#include <xtd/array_view.hpp>
+#include <xtd/execution.hpp>
+#include <xtd/numeric.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace xtd
+{
+	class running_stats;
+	class quantile_sketch;
+
+	/// \name Summary statistics of a contiguous range of `double`
+	//@{
+	template<class Range>
+	running_stats statistics(const Range& values) noexcept;
+	/// Parallel version of `statistics`, merging the results of one part per thread.
+	template<class Range>
+	running_stats statistics(const execution::parallel_policy& policy, const Range& values);
+	//@}
+}
+
+////////////////////////////////////////////////////////////////////////
+// Private parts, do not look.
+//
+
+namespace xtd
+{
+	namespace detail
+	{
+		namespace statistics
+		{
+			// Elements per block of running_stats, both passes over it hit the L1 cache
+			constexpr std::size_t block_size = 256;
+			// Minimum number of elements per thread
+			constexpr std::size_t parallel_grain = 1 << 16;
+
+			struct Moments
+			{
+				double mean;
+				double m2; // Sum of squared deviations from the mean
+				double min;
+				double max;
+			};
+
+			// Moments of a non-empty block
+			inline Moments moments(const double* p, std::size_t n) noexcept
+			{
+				std::size_t i = 0;
+				double sum = 0;
+				double min = p[0];
+				double max = p[0];
+#if defined(XTD_NUMERIC_VECTOR_EXTENSIONS)
+				typedef double V __attribute__((vector_size(xtd::detail::numeric::vector_size)));
+				constexpr std::size_t lanes = sizeof(V) / sizeof(double);
+				auto load = [p] (V& v, std::size_t j) { std::memcpy(&v, p + j, sizeof(V)); };
+				if(n >= 2 * lanes)
+				{
+					// Two sets of accumulators hide the latency of the additions
+					V s0 = {}, s1 = {}, x0, x1;
+					V min0, max0, min1, max1;
+					load(min0, 0);
+					max0 = min1 = max1 = min0;
+					for(const auto end = n - n % (2 * lanes); i < end; i += 2 * lanes)
+					{
+						load(x0, i);
+						load(x1, i + lanes);
+						s0 += x0;
+						s1 += x1;
+						min0 = x0 < min0 ? x0 : min0;
+						max0 = max0 < x0 ? x0 : max0;
+						min1 = x1 < min1 ? x1 : min1;
+						max1 = max1 < x1 ? x1 : max1;
+					}
+					s0 += s1;
+					for(std::size_t k = 0; k < lanes; ++k)
+					{
+						sum += s0[k];
+						min = std::min({min, min0[k], min1[k]});
+						max = std::max({max, max0[k], max1[k]});
+					}
+				}
+#endif // XTD_NUMERIC_VECTOR_EXTENSIONS
+				for(; i < n; ++i)
+				{
+					sum += p[i];
+					min = p[i] < min ? p[i] : min;
+					max = max < p[i] ? p[i] : max;
+				}
+
+				auto mean = sum / static_cast<double>(n);
+				double m2 = 0;
+				i = 0;
+#if defined(XTD_NUMERIC_VECTOR_EXTENSIONS)
+				if(n >= 2 * lanes)
+				{
+					V d0 = {}, d1 = {}, x0, x1;
+					for(const auto end = n - n % (2 * lanes); i < end; i += 2 * lanes)
+					{
+						load(x0, i);
+						load(x1, i + lanes);
+						x0 -= mean;
+						x1 -= mean;
+						d0 += x0 * x0;
+						d1 += x1 * x1;
+					}
+					d0 += d1;
+					for(std::size_t k = 0; k < lanes; ++k)
+						m2 += d0[k];
+				}
+#endif // XTD_NUMERIC_VECTOR_EXTENSIONS
+				for(; i < n; ++i)
+					m2 += (p[i] - mean) * (p[i] - mean);
+				return {mean, m2, min, max};
+			}
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////
+// running_stats
+//
+
+/**
+ Count, mean, variance, minimum and maximum of a stream of `double`, updated one element or batch at a time and mergeable.
+
+ A NaN makes the mean and variance NaN, but is ignored by the minimum and maximum unless it is the first value.
+ */
+class xtd::running_stats
+{
+public:
+	/// Add one value.
+	void push(double x) noexcept
+	{
+		if(_count == 0)
+			_min = _max = x;
+		++_count;
+		auto delta = x - _mean;
+		_mean += delta / static_cast<double>(_count);
+		_m2 += delta * (x - _mean);
+		_min = x < _min ? x : _min;
+		_max = _max < x ? x : _max;
+	}
+	/// Add a batch of values, processing them in SIMD lanes.
+	void push(array_view<const double> values) noexcept
+	{
+		for(std::size_t i = 0; i < values.size(); i += detail::statistics::block_size)
+		{
+			auto n = std::min(detail::statistics::block_size, values.size() - i);
+			auto m = detail::statistics::moments(values.data() + i, n);
+			combine(n, m.mean, m.m2, m.min, m.max);
+		}
+	}
+	/// Add the values of a contiguous range of `double`, such as `std::vector<double>`.
+	template<class Range, class = decltype(std::declval<const Range&>().data() + std::declval<const Range&>().size())>
+	void push(const Range& values) noexcept
+	{
+		push(array_view<const double>{values.data(), values.size()});
+	}
+	/// Add the values seen by `other`, as if they were pushed into this one.
+	void merge(const running_stats& other) noexcept
+	{
+		if(other._count != 0)
+			combine(other._count, other._mean, other._m2, other._min, other._max);
+	}
+	/// Forget all values.
+	void clear() noexcept { *this = {}; }
+
+	std::uint64_t count() const noexcept { return _count; }
+	bool empty() const noexcept { return _count == 0; }
+	/// The sum of the values.
+	double sum() const noexcept { return _mean * static_cast<double>(_count); }
+	/// The mean, or zero if empty.
+	double mean() const noexcept { return _mean; }
+	/// The population variance, or zero if empty.
+	double variance() const noexcept { return _count == 0 ? 0 : _m2 / static_cast<double>(_count); }
+	/// The sample variance with Bessel's correction, or zero with fewer than two values.
+	double sample_variance() const noexcept { return _count < 2 ? 0 : _m2 / static_cast<double>(_count - 1); }
+	/// The population standard deviation.
+	double stddev() const noexcept { return std::sqrt(variance()); }
+	/// The smallest value, or NaN if empty.
+	double min() const noexcept { return _min; }
+	/// The largest value, or NaN if empty.
+	double max() const noexcept { return _max; }
+
+private:
+	void combine(std::uint64_t count, double mean, double m2, double min, double max) noexcept
+	{
+		if(_count == 0)
+		{
+			_count = count;
+			_mean = mean;
+			_m2 = m2;
+			_min = min;
+			_max = max;
+			return;
+		}
+		auto n = static_cast<double>(_count + count);
+		auto delta = mean - _mean;
+		_mean += delta * (static_cast<double>(count) / n);
+		_m2 += m2 + delta * delta * (static_cast<double>(_count) * static_cast<double>(count) / n);
+		_count += count;
+		_min = min < _min ? min : _min;
+		_max = _max < max ? max : _max;
+	}
+
+	std::uint64_t _count = 0;
+	double _mean = 0;
+	double _m2 = 0;
+	double _min = std::numeric_limits<double>::quiet_NaN();
+	double _max = std::numeric_limits<double>::quiet_NaN();
+};
+
+////////////////////////////////////////////////////////////////////////
+// quantile_sketch
+//
+
+/**
+ Approximate quantiles of a stream of `double` in bounded space, mergeable across threads or series.
+
+ The accuracy parameter `k` is the capacity of the top level. With high probability the rank of a returned quantile is within about `3 / k` of the requested one, which is 1.5% for the default `k = 200`, and the sketch keeps roughly `3 * k` values. Merged sketches should have the same `k`. The random choices of compactions come from a generator seeded with `seed`, so the same input gives the same sketch.
+
+ NaN values are ignored.
+ */
+class xtd::quantile_sketch
+{
+public:
+	explicit quantile_sketch(std::size_t k = 200, std::uint64_t seed = 0)
+	: _k(std::max<std::size_t>(k, 8))
+	, _random(seed)
+	, _levels(1)
+	, _capacity(_k)
+	{ }
+
+	/// Add one value.
+	void push(double x)
+	{
+		if(x != x)
+			return;
+		add(x);
+		_levels[0].push_back(x);
+		++_size;
+		compress();
+	}
+	/// Add a batch of values, appending as many as fit before each compaction.
+	void push(array_view<const double> values)
+	{
+		auto p = values.data();
+		auto end = p + values.size();
+		while(p != end)
+		{
+			auto room = std::max<std::size_t>(_capacity - std::min(_size, _capacity), 1);
+			auto n = std::min<std::size_t>(room, static_cast<std::size_t>(end - p));
+			auto& level = _levels[0];
+			for(auto q = p; q != p + n; ++q)
+			{
+				if(*q != *q)
+					continue;
+				add(*q);
+				level.push_back(*q);
+				++_size;
+			}
+			p += n;
+			compress();
+		}
+	}
+	/// Add the values of a contiguous range of `double`, such as `std::vector<double>`.
+	template<class Range, class = decltype(std::declval<const Range&>().data() + std::declval<const Range&>().size())>
+	void push(const Range& values)
+	{
+		push(array_view<const double>{values.data(), values.size()});
+	}
+	/// Add the values seen by `other`, with the accuracy of the smaller `k`.
+	void merge(const quantile_sketch& other)
+	{
+		assert(this != &other && "xtd::quantile_sketch: Cannot merge a sketch with itself.");
+		if(other._count == 0)
+			return;
+		if(_count == 0)
+		{
+			_min = other._min;
+			_max = other._max;
+		}
+		else
+		{
+			_min = std::min(_min, other._min);
+			_max = std::max(_max, other._max);
+		}
+		_count += other._count;
+		_k = std::min(_k, other._k);
+		if(_levels.size() < other._levels.size())
+			_levels.resize(other._levels.size());
+		for(std::size_t h = 0; h < other._levels.size(); ++h)
+			_levels[h].insert(_levels[h].end(), other._levels[h].begin(), other._levels[h].end());
+		_size += other._size;
+		_capacity = capacity();
+		compress();
+	}
+	/// Forget all values.
+	void clear() noexcept
+	{
+		_levels.assign(1, {});
+		_capacity = _k;
+		_size = 0;
+		_count = 0;
+	}
+
+	/// The number of values seen.
+	std::uint64_t count() const noexcept { return _count; }
+	bool empty() const noexcept { return _count == 0; }
+	std::size_t k() const noexcept { return _k; }
+	/// The number of values retained.
+	std::size_t retained() const noexcept { return _size; }
+	/// The smallest value seen, or NaN if empty.
+	double min() const noexcept { return _count == 0 ? std::numeric_limits<double>::quiet_NaN() : _min; }
+	/// The largest value seen, or NaN if empty.
+	double max() const noexcept { return _count == 0 ? std::numeric_limits<double>::quiet_NaN() : _max; }
+
+	/// The approximate `q` quantile for `q` in `[0, 1]`, exact for 0 and 1. NaN if empty.
+	double quantile(double q) const
+	{
+		assert(q >= 0 && q <= 1 && "xtd::quantile_sketch: The quantile must be in [0, 1].");
+		if(_count == 0)
+			return std::numeric_limits<double>::quiet_NaN();
+		if(q <= 0)
+			return _min;
+		if(q >= 1)
+			return _max;
+		auto values = weighted();
+		auto target = q * static_cast<double>(_count);
+		std::uint64_t rank = 0;
+		for(auto& v : values)
+		{
+			rank += v.second;
+			if(static_cast<double>(rank) >= target)
+				return v.first;
+		}
+		return _max;
+	}
+	/// The approximate fraction of values less than or equal to `x`. Zero if empty.
+	double rank(double x) const noexcept
+	{
+		if(_count == 0)
+			return 0;
+		std::uint64_t rank = 0;
+		for(std::size_t h = 0; h < _levels.size(); ++h)
+			for(auto v : _levels[h])
+				rank += v <= x ? std::uint64_t(1) << h : 0;
+		return static_cast<double>(rank) / static_cast<double>(_count);
+	}
+
+private:
+	void add(double x) noexcept
+	{
+		if(_count++ == 0)
+			_min = _max = x;
+		_min = x < _min ? x : _min;
+		_max = _max < x ? x : _max;
+	}
+
+	// Levels further below the top keep fewer values, shrinking by 2/3 per level
+	std::size_t capacity(std::size_t level) const noexcept
+	{
+		auto depth = static_cast<int>(_levels.size() - level - 1);
+		return std::max<std::size_t>(static_cast<std::size_t>(std::ceil(static_cast<double>(_k) * std::pow(2. / 3., depth))), 2);
+	}
+	std::size_t capacity() const noexcept
+	{
+		std::size_t total = 0;
+		for(std::size_t h = 0; h < _levels.size(); ++h)
+			total += capacity(h);
+		return total;
+	}
+
+	// Compact the lowest full level until the sketch fits
+	void compress()
+	{
+		while(_size > _capacity)
+		{
+			std::size_t h = 0;
+			while(_levels[h].size() < capacity(h))
+				++h;
+			if(h + 1 == _levels.size())
+			{
+				_levels.emplace_back();
+				_capacity = capacity();
+			}
+			auto& level = _levels[h];
+			auto& next = _levels[h + 1];
+			std::sort(level.begin(), level.end());
+			// An odd value out stays behind so the total weight is unchanged
+			auto n = level.size() - level.size() % 2;
+			for(auto i = static_cast<std::size_t>(coin()); i < n; i += 2)
+				next.push_back(level[i]);
+			level.erase(level.begin(), level.begin() + static_cast<std::ptrdiff_t>(n));
+			_size -= n / 2;
+		}
+	}
+
+	// splitmix64
+	bool coin() noexcept
+	{
+		auto z = (_random += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return ((z ^ (z >> 31)) & 1) != 0;
+	}
+
+	// All retained values with their weight, sorted by value
+	std::vector<std::pair<double, std::uint64_t>> weighted() const
+	{
+		std::vector<std::pair<double, std::uint64_t>> values;
+		values.reserve(_size);
+		for(std::size_t h = 0; h < _levels.size(); ++h)
+			for(auto v : _levels[h])
+				values.emplace_back(v, std::uint64_t(1) << h);
+		std::sort(values.begin(), values.end(), [] (const auto& a, const auto& b) { return a.first < b.first; });
+		return values;
+	}
+
+	std::size_t _k;
+	std::uint64_t _random;
+	std::vector<std::vector<double>> _levels;
+	std::size_t _capacity; // Sum of the capacities of all levels
+	std::size_t _size = 0;
+	std::uint64_t _count = 0;
+	double _min = 0;
+	double _max = 0;
+};
+
+template<class Range>
+xtd::running_stats xtd::statistics(const Range& values) noexcept
+{
+	running_stats stats;
+	stats.push(array_view<const double>{values.data(), values.size()});
+	return stats;
+}
+
+template<class Range>
+xtd::running_stats xtd::statistics(const execution::parallel_policy& policy, const Range& values)
+{
+	array_view<const double> all{values.data(), values.size()};
+	std::vector<running_stats> parts(std::min<std::size_t>(policy.concurrency(), std::max<std::size_t>(all.size() / detail::statistics::parallel_grain, 1)));
+	detail::execution::parallel_for(policy, all.size(), detail::statistics::parallel_grain, [&] (std::size_t chunk, std::size_t first, std::size_t last)
+	{
+		parts[chunk].push({all.data() + first, last - first});
+	});
+	running_stats stats;
+	for(auto& part : parts)
+		stats.merge(part);
+	return stats;
+}
@@ -0,0 +1,259 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+/**
+ \file
+ Selection of the `k` best elements of a sequence without sorting it.
+
+ The best elements seen so far are kept in a heap of size `k` whose top is the worst of them, the threshold a new element has to beat. Once the heap is full almost all elements of a long sequence are worse than the threshold, so batches of arithmetic elements are first compared with it in SIMD registers and only blocks containing a better element are looked at individually.
+
+ ~~~cpp
+ std::vector<float> scores = ...;
+ auto best = xtd::top_k(scores, 100); // The 100 highest scores, highest first
+
+ xtd::top_k_accumulator<float> acc{100};
+ while(auto batch = next_batch())
+     acc.push(batch);
+ auto best = acc.sorted();
+ ~~~
+
+ \author Miro Knejp
+ */
+
+#pragma once
+
+#include <xtd/algorithm.hpp>
+#include <xtd/array_view.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace xtd
+{
+	template<class T, class Compare = std::less<>>
+	class top_k_accumulator;
+
+	/**
+	 The `k` greatest elements of the contiguous `range` according to `comp`, ordered from greatest to smallest.
+
+	 With the default `std::less` these are the `k` largest elements. If `range` has fewer than `k` elements all of them are returned. Which of several equal elements are selected is unspecified.
+	 */
+	template<class Range, class Compare = std::less<>>
+	std::vector<detail::algorithm::contiguous_value_t<Range>> top_k(const Range& range, std::size_t k, Compare comp = {});
+}
+
+////////////////////////////////////////////////////////////////////////
+// Private parts, do not look.
+//
+
+namespace xtd
+{
+	namespace detail
+	{
+		namespace top_k
+		{
+			// Comparisons which can be applied to vectors of arithmetic types
+			template<class Compare, class T>
+			struct VectorCompare : std::false_type { };
+			template<class T>
+			struct VectorCompare<std::less<>, T> : std::true_type { using type = std::less<>; };
+			template<class T>
+			struct VectorCompare<std::less<T>, T> : std::true_type { using type = std::less<>; };
+			template<class T>
+			struct VectorCompare<std::greater<>, T> : std::true_type { using type = std::greater<>; };
+			template<class T>
+			struct VectorCompare<std::greater<T>, T> : std::true_type { using type = std::greater<>; };
+
+#if defined(XTD_ALGORITHM_VECTOR_EXTENSIONS)
+			template<class Compare, class T>
+			using filterable = std::integral_constant<bool, xtd::detail::algorithm::IsVectorizable<T>::value && VectorCompare<Compare, T>::value>;
+#else
+			template<class Compare, class T>
+			using filterable = std::false_type;
+#endif
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////
+// top_k_accumulator
+//
+
+/**
+ Keeps the `k` greatest elements pushed into it according to `Compare`, which must be a strict weak ordering of all elements pushed (so no floating point NaNs).
+
+ Pushing an element costs one comparison if it is not better than the current threshold and `O(log k)` otherwise. Batches of arithmetic types compared with `std::less` or `std::greater` are filtered with SIMD comparisons against the threshold first. Accumulators filled by different threads can be combined with `merge`.
+ */
+template<class T, class Compare>
+class xtd::top_k_accumulator
+{
+public:
+	/// Keep the `k` greatest elements.
+	explicit top_k_accumulator(std::size_t k, Compare comp = {})
+	: _k(k)
+	, _comp(std::move(comp))
+	{
+		_heap.reserve(k);
+	}
+
+	/// Add a single element.
+	void push(const T& x)
+	{
+		if(_heap.size() < _k)
+		{
+			_heap.push_back(x);
+			std::push_heap(_heap.begin(), _heap.end(), worse());
+		}
+		else if(_k > 0 && _comp(_heap.front(), x))
+			replace_top(x);
+	}
+	/// Add all elements of `batch`.
+	void push(array_view<const T> batch)
+	{
+		auto p = batch.data();
+		auto n = batch.size();
+		std::size_t i = 0;
+		// Fill the heap first so the threshold exists
+		for(; i < n && _heap.size() < _k; ++i)
+			push(p[i]);
+		filter(p + i, n - i, detail::top_k::filterable<Compare, T>{});
+	}
+	/// Add all elements kept by `other`.
+	void merge(const top_k_accumulator& other)
+	{
+		for(auto& x : other._heap)
+			push(x);
+	}
+	/// Forget all elements.
+	void clear() noexcept { _heap.clear(); }
+
+	/// The number of elements kept, which is `k` unless fewer were pushed.
+	std::size_t size() const noexcept { return _heap.size(); }
+	/// The maximum number of elements kept.
+	std::size_t k() const noexcept { return _k; }
+	/// Whether `k` elements are kept.
+	bool full() const noexcept { return _heap.size() == _k; }
+	/// The smallest element kept, which a new element must be greater than to be kept once `full()`. The accumulator must not be empty.
+	const T& threshold() const noexcept
+	{
+		assert(!_heap.empty() && "xtd::top_k_accumulator::threshold: There is no threshold without elements.");
+		return _heap.front();
+	}
+
+	/// The elements kept, ordered from greatest to smallest.
+	std::vector<T> sorted() const
+	{
+		auto result = _heap;
+		std::sort(result.begin(), result.end(), [this] (const T& a, const T& b) { return _comp(b, a); });
+		return result;
+	}
+	/// The elements kept in unspecified order, leaving the accumulator empty.
+	std::vector<T> release() noexcept
+	{
+		auto result = std::move(_heap);
+		_heap.clear();
+		return result;
+	}
+
+private:
+	// Heap order with the worst element on top
+	auto worse() const
+	{
+		return [this] (const T& a, const T& b) { return _comp(b, a); };
+	}
+
+	// Replace the worst element by x and restore the heap order
+	void replace_top(const T& x)
+	{
+		auto n = _heap.size();
+		std::size_t i = 0;
+		for(;;)
+		{
+			auto child = 2 * i + 1;
+			if(child >= n)
+				break;
+			if(child + 1 < n && _comp(_heap[child + 1], _heap[child]))
+				++child;
+			if(!_comp(_heap[child], x))
+				break;
+			_heap[i] = std::move(_heap[child]);
+			i = child;
+		}
+		_heap[i] = x;
+	}
+
+	void filter(const T* p, std::size_t n, std::false_type /* filterable */)
+	{
+		for(std::size_t i = 0; i < n; ++i)
+			push(p[i]);
+	}
+
+#if defined(XTD_ALGORITHM_VECTOR_EXTENSIONS)
+	// Skip blocks without an element better than the threshold
+	void filter(const T* p, std::size_t n, std::true_type /* filterable */)
+	{
+		typedef T V __attribute__((vector_size(detail::algorithm::vector_size)));
+		constexpr std::size_t lanes = sizeof(V) / sizeof(T);
+		constexpr std::size_t block = 4 * lanes;
+		typename detail::top_k::VectorCompare<Compare, T>::type comp;
+		if(_k == 0)
+			return;
+		V t = {}, x0, x1, x2, x3;
+		auto update = [&]
+		{
+			for(std::size_t k = 0; k < lanes; ++k)
+				t[k] = _heap.front();
+		};
+		update();
+		std::size_t i = 0;
+		for(const auto end = n - n % block; i < end; i += block)
+		{
+			std::memcpy(&x0, p + i, sizeof(V));
+			std::memcpy(&x1, p + i + lanes, sizeof(V));
+			std::memcpy(&x2, p + i + 2 * lanes, sizeof(V));
+			std::memcpy(&x3, p + i + 3 * lanes, sizeof(V));
+			if(!detail::algorithm::any(comp(t, x0) | comp(t, x1) | comp(t, x2) | comp(t, x3)))
+				continue;
+			for(std::size_t j = i; j < i + block; ++j)
+				push(p[j]);
+			update();
+		}
+		for(; i < n; ++i)
+			push(p[i]);
+	}
+#endif
+
+	std::size_t _k;
+	Compare _comp;
+	std::vector<T> _heap;
+};
+
+template<class Range, class Compare>
+auto xtd::top_k(const Range& range, std::size_t k, Compare comp) -> std::vector<detail::algorithm::contiguous_value_t<Range>>
+{
+	using T = detail::algorithm::contiguous_value_t<Range>;
+	auto p = range.data();
+	auto n = range.size();
+	auto better = [&comp] (const T& a, const T& b) { return comp(b, a); };
+	if(k >= n / 8)
+	{
+		// A large part of the range is selected, partitioning is cheaper than a heap
+		std::vector<T> result(p, p + n);
+		k = std::min(k, n);
+		std::nth_element(result.begin(), result.begin() + static_cast<std::ptrdiff_t>(k), result.end(), better);
+		result.resize(k);
+		std::sort(result.begin(), result.end(), better);
+		return result;
+	}
+	top_k_accumulator<T, Compare> acc{k, comp};
+	acc.push({p, n});
+	return acc.sorted();
+}
@@ -0,0 +1,349 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+/**
+ \file
+ Scoped tracing with low enough overhead to stay enabled in hot paths, exported in the Chrome trace event format.
+
+ `XTD_TRACE_SCOPE("name")` reads `tsc_clock::ticks()` at the start of the scope and, through `XTD_FINALLY`, again at its end. Both are stored with the name in a ring buffer owned by the current thread, which only that thread writes to, so recording an event takes no lock and no atomic read-modify-write. If the buffer is full, the event is dropped and counted.
+
+ While a `trace_session` exists, a background thread periodically drains the buffers of all threads and writes the events as JSON to a stream, converting ticks to microseconds with the calibration of `tsc_clock`. The output can be opened in `chrome://tracing` or Perfetto. Without a session, a scope costs one relaxed load and a branch.
+
+ ~~~cpp
+ void handle(request& r)
+ {
+     XTD_TRACE_SCOPE("handle");
+     parse(r);
+     {
+         XTD_TRACE_SCOPE("respond");
+         respond(r);
+     }
+ }
+
+ std::ofstream file{"trace.json"};
+ xtd::trace_session session{file};
+ serve();
+ ~~~
+
+ Names must be string literals or otherwise outlive the session.
+
+ \author Miro Knejp
+ */
+
+#pragma once
+
+#include <xtd/finally.hpp>
+#include <xtd/tsc_clock.hpp>
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <ios>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace xtd
+{
+	/// Configuration of trace_session.
+	struct trace_options
+	{
+		/// Time between draining the buffers of all threads.
+		std::chrono::milliseconds interval{100};
+		/// Events per thread buffered between two drains, rounded up to a power of two. Only applies to threads tracing for the first time during the session.
+		std::size_t buffer_size = 1 << 14;
+	};
+
+	class trace_session;
+}
+
+/**
+ Record the time spent until the end of the enclosing scope as an event named `name`, if a `trace_session` is active when the scope is entered.
+
+ ~~~cpp
+ XTD_TRACE_SCOPE("compress");
+ ~~~
+ */
+#define XTD_TRACE_SCOPE(name) \
+	const auto XTD_FINALLY_ID_(XTD_TRACE_BEGIN_, __LINE__) = ::xtd::detail::trace::begin(); \
+	XTD_FINALLY { ::xtd::detail::trace::end(name, XTD_FINALLY_ID_(XTD_TRACE_BEGIN_, __LINE__)); }
+
+////////////////////////////////////////////////////////////////////////
+// Private parts, do not look.
+//
+
+namespace xtd
+{
+	namespace detail
+	{
+		namespace trace
+		{
+			struct Event
+			{
+				const char* name;
+				std::uint64_t begin;
+				std::uint64_t end;
+			};
+
+			// Single producer, single consumer ring of events, head and tail on separate cache lines
+			class Buffer
+			{
+			public:
+				Buffer(std::size_t size, std::uint32_t tid)
+				: tid(tid)
+				{
+					std::size_t n = 1;
+					while(n < size)
+						n *= 2;
+					_events.resize(n);
+				}
+
+				// Owning thread only
+				void push(const Event& e) noexcept
+				{
+					auto head = _head.load(std::memory_order_relaxed);
+					if(head - _tail_cache == _events.size())
+					{
+						_tail_cache = _tail.load(std::memory_order_acquire);
+						if(head - _tail_cache == _events.size())
+						{
+							dropped.fetch_add(1, std::memory_order_relaxed);
+							return;
+						}
+					}
+					_events[head & (_events.size() - 1)] = e;
+					_head.store(head + 1, std::memory_order_release);
+				}
+
+				// Draining thread only, returns whether there was anything
+				template<class F>
+				bool drain(F&& f)
+				{
+					auto tail = _tail.load(std::memory_order_relaxed);
+					auto head = _head.load(std::memory_order_acquire);
+					for(auto i = tail; i != head; ++i)
+						f(_events[i & (_events.size() - 1)]);
+					_tail.store(head, std::memory_order_release);
+					return tail != head;
+				}
+
+				const std::uint32_t tid;
+				std::atomic<bool> closed{false}; // The thread exited
+				std::atomic<std::uint64_t> dropped{0};
+
+			private:
+				std::vector<Event> _events;
+				char _pad0[64];
+				std::atomic<std::size_t> _head{0};
+				std::size_t _tail_cache = 0;
+				char _pad1[64];
+				std::atomic<std::size_t> _tail{0};
+			};
+
+			struct State
+			{
+				std::atomic<bool> enabled{false};
+				std::mutex mutex; // Guards all other members and draining
+				std::vector<std::shared_ptr<Buffer>> buffers;
+				std::size_t buffer_size = 0;
+				std::uint32_t next_tid = 1;
+				std::uint64_t dropped = 0; // By buffers already removed
+			};
+
+			inline State& state() noexcept
+			{
+				static State s;
+				return s;
+			}
+
+			// Buffers of exited threads remain until drained
+			struct ThreadBuffer
+			{
+				~ThreadBuffer()
+				{
+					if(buffer)
+						buffer->closed.store(true, std::memory_order_release);
+				}
+				std::shared_ptr<Buffer> buffer;
+			};
+
+			inline Buffer* thread_buffer() noexcept
+			{
+				thread_local ThreadBuffer local;
+				if(!local.buffer)
+				{
+					try
+					{
+						auto& s = state();
+						std::lock_guard<std::mutex> lock{s.mutex};
+						local.buffer = std::make_shared<Buffer>(s.buffer_size, s.next_tid++);
+						s.buffers.push_back(local.buffer);
+					}
+					catch(...)
+					{
+						return nullptr;
+					}
+				}
+				return local.buffer.get();
+			}
+
+			// Zero if no session is active
+			inline std::uint64_t begin() noexcept
+			{
+				return state().enabled.load(std::memory_order_relaxed) ? xtd::tsc_clock::ticks() : 0;
+			}
+
+			inline void end(const char* name, std::uint64_t begin) noexcept
+			{
+				if(begin == 0)
+					return;
+				auto end = xtd::tsc_clock::ticks();
+				if(auto buffer = thread_buffer())
+					buffer->push({name, begin, end});
+			}
+
+			inline void write_string(std::ostream& out, const char* s)
+			{
+				out << '"';
+				for(; *s; ++s)
+				{
+					if(*s == '"' || *s == '\\')
+						out << '\\' << *s;
+					else if(static_cast<unsigned char>(*s) < 0x20)
+						out << ' ';
+					else
+						out << *s;
+				}
+				out << '"';
+			}
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////
+// trace_session
+//
+
+/**
+ Enables `XTD_TRACE_SCOPE` and writes the recorded events to a stream in the Chrome trace event format until destroyed.
+
+ Only one session may exist at a time. The stream is written by a background thread and must not be used otherwise while the session exists. When the session is destroyed the remaining events are written and the JSON document is completed.
+ */
+class xtd::trace_session
+{
+public:
+	explicit trace_session(std::ostream& out, const trace_options& opts = {})
+	: _out(out)
+	, _interval(opts.interval)
+	{
+		auto& s = detail::trace::state();
+		{
+			std::lock_guard<std::mutex> lock{s.mutex};
+			assert(!s.enabled.load() && "xtd::trace_session: Only one session can be active.");
+			// Discard events of scopes which ended after a previous session
+			for(auto& buffer : s.buffers)
+				buffer->drain([] (const detail::trace::Event&) { });
+			s.buffer_size = opts.buffer_size;
+			_dropped = s.dropped;
+			for(auto& buffer : s.buffers)
+				_dropped += buffer->dropped.load(std::memory_order_relaxed);
+			_start_ticks = tsc_clock::ticks();
+		}
+		_out << "{\"traceEvents\":[";
+		s.enabled.store(true, std::memory_order_relaxed);
+		_thread = std::thread{[this] { run(); }};
+	}
+	trace_session(const trace_session&) = delete;
+	trace_session& operator=(const trace_session&) = delete;
+	~trace_session()
+	{
+		detail::trace::state().enabled.store(false, std::memory_order_relaxed);
+		{
+			std::lock_guard<std::mutex> lock{_mutex};
+			_stop = true;
+		}
+		_wake.notify_one();
+		_thread.join();
+		flush();
+		_out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+		_out.flush();
+	}
+
+	/// Write all events recorded so far.
+	void flush()
+	{
+		auto& s = detail::trace::state();
+		std::lock_guard<std::mutex> lock{s.mutex};
+		auto us = [] (std::int64_t ticks) { return static_cast<double>(tsc_clock::to_duration(ticks).count()) / 1000; };
+		// Numbers are written in a fixed format, the caller's settings of the stream are restored afterwards
+		auto flags = _out.flags(std::ios_base::dec | std::ios_base::fixed);
+		auto precision = _out.precision(3);
+		XTD_FINALLY { _out.flags(flags); _out.precision(precision); };
+		for(auto it = s.buffers.begin(); it != s.buffers.end();)
+		{
+			auto& buffer = **it;
+			// Read closed before draining, so no event can follow the last drain
+			auto closed = buffer.closed.load(std::memory_order_acquire);
+			buffer.drain([&] (const detail::trace::Event& e)
+			{
+				_out << (_events++ == 0 ? "\n" : ",\n") << "{\"name\":";
+				detail::trace::write_string(_out, e.name);
+				_out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer.tid << ",\"ts\":" << us(static_cast<std::int64_t>(e.begin - _start_ticks)) << ",\"dur\":" << us(static_cast<std::int64_t>(e.end - e.begin)) << '}';
+			});
+			if(closed)
+			{
+				s.dropped += buffer.dropped.load(std::memory_order_relaxed);
+				it = s.buffers.erase(it);
+			}
+			else
+				++it;
+		}
+	}
+
+	/// The number of events written.
+	std::uint64_t events() const
+	{
+		std::lock_guard<std::mutex> lock{detail::trace::state().mutex};
+		return _events;
+	}
+	/// The number of events dropped because a thread's buffer was full.
+	std::uint64_t dropped() const
+	{
+		auto& s = detail::trace::state();
+		std::lock_guard<std::mutex> lock{s.mutex};
+		auto n = s.dropped;
+		for(auto& buffer : s.buffers)
+			n += buffer->dropped.load(std::memory_order_relaxed);
+		return n - _dropped;
+	}
+
+private:
+	void run()
+	{
+		std::unique_lock<std::mutex> lock{_mutex};
+		while(!_wake.wait_for(lock, _interval, [this] { return _stop; }))
+		{
+			lock.unlock();
+			flush();
+			lock.lock();
+		}
+	}
+
+	std::ostream& _out;
+	std::chrono::milliseconds _interval;
+	std::uint64_t _start_ticks;
+	std::uint64_t _events = 0;
+	std::uint64_t _dropped; // Dropped before the session started
+	std::mutex _mutex; // Guards _stop
+	std::condition_variable _wake;
+	bool _stop = false;
+	std::thread _thread;
+};
@@ -0,0 +1,261 @@
+/*
+ Copyright 2014 Miro Knejp
+
+ See the accompanied LICENSE file for licensing details.
+ */
+
+/**
+ \file
+ A clock reading the processor's time stamp counter, and a stopwatch measuring with it.
+
+ Reading the time stamp counter takes a single instruction without entering the kernel or the vDSO. It only measures time if it ticks at a constant rate in all power states and on all cores, which processors announce as an invariant TSC through CPUID. Its frequency is calibrated against `std::chrono::steady_clock` the first time `tsc_clock` is used, which takes 10 milliseconds. Without an invariant TSC, or on other architectures, `tsc_clock` reads `std::chrono::steady_clock` and a tick is a nanosecond.
+
+ ~~~cpp
+ xtd::stopwatch watch;
+ work();
+ latencies.record(watch.elapsed().count());
+
+ // Storing raw ticks is cheapest, convert them later
+ std::vector<std::uint64_t> ticks;
+ ticks.push_back(xtd::tsc_clock::ticks());
+ ...
+ std::vector<std::int64_t> ns(ticks.size());
+ xtd::tsc_clock::to_nanoseconds(xtd::make_array_view(ticks.data(), ticks.size()), xtd::make_array_view(ns.data(), ns.size()));
+ ~~~
+
+ \author Miro Knejp
+ */
+
+#pragma once
+
+#include <xtd/array_view.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define XTD_TSC_CLOCK_X86 1
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+
+namespace xtd
+{
+	class tsc_clock;
+	class stopwatch;
+}
+
+////////////////////////////////////////////////////////////////////////
+// Private parts, do not look.
+//
+
+namespace xtd
+{
+	namespace detail
+	{
+		namespace tsc_clock
+		{
+			inline std::int64_t steady_ns() noexcept
+			{
+				return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+			}
+
+			inline bool invariant_tsc() noexcept
+			{
+#if defined(XTD_TSC_CLOCK_X86)
+				unsigned a, b, c, d;
+				return __get_cpuid(0x80000007, &a, &b, &c, &d) && (d & (1u << 8)) != 0;
+#else
+				return false;
+#endif
+			}
+
+			inline std::uint64_t rdtsc() noexcept
+			{
+#if defined(XTD_TSC_CLOCK_X86)
+				return __rdtsc();
+#else
+				return 0;
+#endif
+			}
+
+			// A tick and the steady_clock time taken as close together as possible
+			struct Sample
+			{
+				std::uint64_t tick;
+				std::int64_t ns;
+			};
+
+			// The steady_clock reading bracketed most tightly by two ticks of a few attempts
+			inline Sample sample() noexcept
+			{
+				Sample best{0, 0};
+				auto width = ~std::uint64_t(0);
+				for(int i = 0; i < 5; ++i)
+				{
+					auto t0 = rdtsc();
+					auto ns = steady_ns();
+					auto t1 = rdtsc();
+					if(t1 - t0 < width)
+					{
+						width = t1 - t0;
+						best = {t0 + (t1 - t0) / 2, ns};
+					}
+				}
+				return best;
+			}
+
+			struct Calibration
+			{
+				bool tsc;
+				Sample base;
+				double ns_per_tick;
+			};
+
+			inline Calibration calibrate() noexcept
+			{
+				if(!invariant_tsc())
+					return {false, {0, 0}, 1};
+				auto begin = sample();
+				Sample end;
+				do
+					end = sample();
+				while(end.ns - begin.ns < 10000000);
+				return {true, begin, static_cast<double>(end.ns - begin.ns) / static_cast<double>(end.tick - begin.tick)};
+			}
+
+			inline const Calibration& calibration() noexcept
+			{
+				static const Calibration c = calibrate();
+				return c;
+			}
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////
+// tsc_clock
+//
+
+/**
+ A `std::chrono` clock reading the invariant time stamp counter, with the same epoch as `std::chrono::steady_clock`.
+
+ Time points of both clocks can be compared, but may differ by the calibration error of a few parts per million of the time since `tsc_clock` was first used.
+ */
+class xtd::tsc_clock
+{
+public:
+	using rep = std::int64_t;
+	using period = std::nano;
+	using duration = std::chrono::nanoseconds;
+	using time_point = std::chrono::time_point<tsc_clock>;
+	static constexpr bool is_steady = true;
+
+	static time_point now() noexcept { return from_ticks(ticks()); }
+
+	/// Whether the time stamp counter is used, otherwise ticks are `steady_clock` nanoseconds.
+	static bool uses_tsc() noexcept { return detail::tsc_clock::calibration().tsc; }
+	/// Ticks per second, measured the first time the clock was used.
+	static double frequency() noexcept { return 1e9 / detail::tsc_clock::calibration().ns_per_tick; }
+
+	/// The current tick. The processor may read it before earlier instructions have completed.
+	static std::uint64_t ticks() noexcept
+	{
+		auto& c = detail::tsc_clock::calibration();
+		return c.tsc ? detail::tsc_clock::rdtsc() : static_cast<std::uint64_t>(detail::tsc_clock::steady_ns());
+	}
+	/// The current tick, read only after all earlier instructions have completed. Use it to end a measurement.
+	static std::uint64_t ordered_ticks() noexcept
+	{
+#if defined(XTD_TSC_CLOCK_X86)
+		_mm_lfence();
+#endif
+		return ticks();
+	}
+
+	/// The duration of a number of ticks.
+	static duration to_duration(std::int64_t ticks) noexcept
+	{
+		return duration{static_cast<rep>(static_cast<double>(ticks) * detail::tsc_clock::calibration().ns_per_tick)};
+	}
+	/// The time point of a tick.
+	static time_point from_ticks(std::uint64_t tick) noexcept
+	{
+		auto& c = detail::tsc_clock::calibration();
+		auto ns = c.base.ns + static_cast<rep>(static_cast<double>(static_cast<std::int64_t>(tick - c.base.tick)) * c.ns_per_tick);
+		return time_point{duration{ns}};
+	}
+	/// Convert ticks to nanoseconds since the epoch, the same as `from_ticks` but reading the calibration once. `out` must have at least as many elements as `ticks`.
+	static void to_nanoseconds(array_view<const std::uint64_t> ticks, array_view<std::int64_t> out) noexcept
+	{
+		assert(out.size() >= ticks.size() && "xtd::tsc_clock: The output is too short.");
+		auto& c = detail::tsc_clock::calibration();
+		auto base = c.base;
+		auto scale = c.ns_per_tick;
+		auto in = ticks.data();
+		auto p = out.data();
+		for(std::size_t i = 0; i < ticks.size(); ++i)
+			p[i] = base.ns + static_cast<std::int64_t>(static_cast<double>(static_cast<std::int64_t>(in[i] - base.tick)) * scale);
+	}
+};
+
+////////////////////////////////////////////////////////////////////////
+// stopwatch
+//
+
+/// Measures the time it has been running with `tsc_clock`, over several intervals if stopped and started again.
+class xtd::stopwatch
+{
+public:
+	/// Create a stopwatch which is running if `start` is true.
+	explicit stopwatch(bool start = true) noexcept
+	: _start(start ? tsc_clock::ticks() : 0)
+	, _running(start)
+	{ }
+
+	void start() noexcept
+	{
+		if(!_running)
+		{
+			_running = true;
+			_start = tsc_clock::ticks();
+		}
+	}
+	void stop() noexcept
+	{
+		if(_running)
+		{
+			_elapsed += tsc_clock::ordered_ticks() - _start;
+			_running = false;
+		}
+	}
+	/// Stop and set the elapsed time to zero.
+	void reset() noexcept
+	{
+		_elapsed = 0;
+		_running = false;
+	}
+	/// Return the elapsed time, then continue measuring from zero.
+	tsc_clock::duration restart() noexcept
+	{
+		auto now = tsc_clock::ordered_ticks();
+		auto ticks = _elapsed + (_running ? now - _start : 0);
+		_elapsed = 0;
+		_start = now;
+		_running = true;
+		return tsc_clock::to_duration(static_cast<std::int64_t>(ticks));
+	}
+
+	bool running() const noexcept { return _running; }
+	/// The ticks counted so far, including the current interval if running.
+	std::uint64_t elapsed_ticks() const noexcept { return _elapsed + (_running ? tsc_clock::ordered_ticks() - _start : 0); }
+	/// The time measured so far, including the current interval if running.
+	tsc_clock::duration elapsed() const noexcept { return tsc_clock::to_duration(static_cast<std::int64_t>(elapsed_ticks())); }
+
+private:
+	std::uint64_t _start;
+	std::uint64_t _elapsed = 0;
+	bool _running;
+};